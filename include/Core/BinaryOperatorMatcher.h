@@ -0,0 +1,126 @@
+//===- BinaryOperatorMatcher.h ----------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file BinaryOperatorMatcher.h
+/// \brief This file contains the class BinaryOperatorMatcher, the visitor
+///        based matching backend of the binary operator mutators
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_BINARY_OPERATOR_MATCHER_H_
+#define INCLUDE_BINARY_OPERATOR_MATCHER_H_
+
+#include "Core/MutationOperator.h"
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+
+#include <memory>
+#include <vector>
+
+// Forward declarations
+namespace clang
+{
+class BinaryOperator;
+class FunctionDecl;
+}
+
+namespace chimera
+{
+class FunctionSelector;
+
+/// @brief    Matching backend for the matchers of binary operations
+/// @details  A matcher registered in a MatchFinder as
+///           functionDecl(isDefinition(), forEachDescendant(m)) drives a
+///           traversal of each function body per mutator. Instead this
+///           backend walks each function definition once, collecting its
+///           BinaryOperator nodes (CompoundAssignOperator included), then it
+///           evaluates the statement matchers on them only.
+///           Each matcher is hooked to the function definitions of the
+///           MatchFinder in place of the wrapped one: the results have the
+///           same bindings, "functionDecl" included, and they are delivered
+///           in the same order, function after function, matcher after
+///           matcher in registration order.
+class BinaryOperatorMatcher
+{
+public:
+    /// @brief Ctor
+    /// @param selector The selection of the target functions/methods, nullptr
+    ///        to match all of them
+    explicit BinaryOperatorMatcher (
+        const FunctionSelector *selector = nullptr );
+    ~BinaryOperatorMatcher();
+
+    /// @brief Add a matcher, it must match a binary operator at the top level
+    /// @param finder The finder whose traversal drives the matcher, the
+    ///        backend must outlive its runs
+    /// @param matcher The statement matcher of a mutator
+    /// @param callback The callback for its results
+    /// @param operatorIds The operators the matcher belongs to, a function is
+    ///        visited if it is selected for at least one of them
+    void addMatcher ( clang::ast_matchers::MatchFinder &finder,
+                      const clang::ast_matchers::StatementMatcher &matcher,
+                      clang::ast_matchers::MatchFinder::MatchCallback *callback,
+                      const ::std::vector<m_operator::IdType> &operatorIds =
+                          ::std::vector<m_operator::IdType>() );
+
+    bool empty() const {
+        return this->entries.empty();
+    }
+
+private:
+    /// @brief A matcher, evaluated by its own finder on the single nodes
+    class Entry : public clang::ast_matchers::MatchFinder::MatchCallback
+    {
+    public:
+        explicit Entry ( BinaryOperatorMatcher &backend )
+            : MatchCallback(), backend ( backend ), callback ( nullptr ) {}
+
+        /// @brief Match the binary operators of a function definition
+        void run (
+            const clang::ast_matchers::MatchFinder::MatchResult &Result
+        ) override;
+        /// @brief The finder knows only the entry, forward to the callback
+        void onEndOfTranslationUnit() override;
+
+        BinaryOperatorMatcher &backend;
+        clang::ast_matchers::MatchFinder finder;
+        clang::ast_matchers::MatchFinder::MatchCallback *callback;
+        ::std::vector<m_operator::IdType> operatorIds;
+    };
+
+    /// @brief If a function has to be visited for the operators of an entry
+    bool isSelected ( const clang::FunctionDecl &function,
+                      const Entry &entry ) const;
+
+    /// @brief Return the binary operators of a function, in traversal order
+    /// @details The function is walked once, for the first selecting matcher
+    const ::std::vector<const clang::BinaryOperator *> &
+    getOperators ( const clang::FunctionDecl &function );
+
+    const FunctionSelector *selector; ///< nullptr if all functions are selected
+    ::std::vector<::std::unique_ptr<Entry>> entries;
+    const clang::FunctionDecl *function; ///< Function under visit
+    const clang::FunctionDecl *walked;   ///< Function of operators
+    ::std::vector<const clang::BinaryOperator *> operators;
+};
+
+} // End chimera namespace
+
+#endif /* INCLUDE_BINARY_OPERATOR_MATCHER_H_ */
@@ -0,0 +1,92 @@
+//===- CandidateCounter.h ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file CandidateCounter.h
+/// \brief This file contains the class CandidateCounter, which collects the
+///        candidate mutations of a target in the count-only mode
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_CANDIDATE_COUNTER_H_
+#define INCLUDE_CANDIDATE_COUNTER_H_
+
+#include "Core/MutationOperator.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chimera
+{
+
+/// @brief Available formats of the candidate counts
+enum class CountFormat {
+    CSV,  ///< candidates.csv and counts.csv
+    JSON  ///< candidates.json
+};
+
+/// @brief A match that passed the fine grain matching
+struct Candidate {
+    ::std::string functionName; ///< Empty if the matched node is not valid
+    unsigned line;              ///< 0 if the matched node is not valid
+    unsigned column;            ///< 0 if the matched node is not valid
+    m_operator::IdType operatorId;
+    ::std::string mutatorId;
+    unsigned mutations;         ///< Mutation types of the mutator
+};
+
+/// @brief    Collector of the candidate mutations of a target
+/// @details  Each candidate counts as many mutations as the types of its
+///           mutator, that is the mutants that would be generated (and
+///           checked) without the count-only mode. The counts are totalled
+///           per function, per operator and per mutator.
+class CandidateCounter
+{
+public:
+    void add ( const Candidate &candidate );
+
+    /// @brief Total number of candidate mutations
+    ::std::size_t total() const {
+        return this->totalMutations;
+    }
+
+    /// @brief Write the candidates and their counts in a directory
+    /// @details The CSV format writes candidates.csv, a row per candidate
+    ///          (function,line,col,operator,mutator,mutations), and
+    ///          counts.csv, a row per total (scope,name,mutations) with scope
+    ///          one of function, operator or mutator. The JSON format writes
+    ///          both in candidates.json.
+    /// @param directory The output directory, with trailing pathSep
+    /// @return If the files have been written
+    bool write ( const ::std::string &directory, CountFormat format ) const;
+
+private:
+    bool writeCSV ( const ::std::string &directory ) const;
+    bool writeJSON ( const ::std::string &directory ) const;
+
+    ::std::vector<Candidate> candidates;  ///< In traversal order
+    ::std::map<::std::string, ::std::size_t> perFunction;
+    ::std::map<::std::string, ::std::size_t> perOperator;
+    ::std::map<::std::string, ::std::size_t> perMutator;
+    ::std::size_t totalMutations = 0;
+};
+} // End chimera namespace
+
+#endif /* INCLUDE_CANDIDATE_COUNTER_H_ */
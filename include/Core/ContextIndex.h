@@ -0,0 +1,111 @@
+//===- ContextIndex.h -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ContextIndex.h
+/// \brief This file contains the class ContextIndex, which records the
+///        structural context of the statements of a function
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_CONTEXT_INDEX_H_
+#define INCLUDE_CONTEXT_INDEX_H_
+
+#include "llvm/ADT/DenseMap.h"
+
+#include <unordered_map>
+
+// Forward declarations
+namespace clang
+{
+class ASTContext;
+class ArraySubscriptExpr;
+class BinaryOperator;
+class CallExpr;
+class DoStmt;
+class ForStmt;
+class FunctionDecl;
+class IfStmt;
+class Stmt;
+class VarDecl;
+class WhileStmt;
+}
+
+namespace chimera
+{
+
+/// @brief The surroundings of a statement, the statement itself excluded
+/// @details Each field is the innermost enclosing node of its kind, nullptr
+///          if there is none, as hasAncestor() would bind it.
+struct StmtContext {
+    StmtContext()
+        : forStmt ( nullptr ), whileStmt ( nullptr ), doStmt ( nullptr ),
+          ifStmt ( nullptr ), loop ( nullptr ), loopDepth ( 0 ),
+          control ( nullptr ), inCondition ( false ), call ( nullptr ),
+          subscript ( nullptr ), assignment ( nullptr ), varDecl ( nullptr ) {}
+
+    const clang::ForStmt *forStmt;
+    const clang::WhileStmt *whileStmt;
+    const clang::DoStmt *doStmt;
+    const clang::IfStmt *ifStmt;
+    const clang::Stmt *loop; ///< Innermost loop, range-based for included
+    unsigned loopDepth;      ///< Number of enclosing loops
+    const clang::Stmt *control; ///< Innermost loop or if statement
+    bool inCondition; ///< If in the control part of control, not in its body
+    const clang::CallExpr *call;
+    const clang::ArraySubscriptExpr *subscript;
+    const clang::BinaryOperator *assignment; ///< Innermost = operator
+    const clang::VarDecl *varDecl; ///< Variable whose initializer contains it
+};
+
+/// @brief    Context of the statements of the analyzed functions
+/// @details  The index of a function is built with a single traversal, the
+///           first time one of its statements is looked up. Then each query
+///           is a hash lookup, while a hasAncestor() matcher walks the parent
+///           map for every candidate node.
+///           It refers to the AST, so it's valid within a translation unit.
+class ContextIndex
+{
+public:
+    using StmtContextMap = ::llvm::DenseMap<const clang::Stmt *, StmtContext>;
+
+    /// @brief Return the context of a statement of a function
+    /// @return An empty context if the statement doesn't belong to function
+    const StmtContext &get ( const clang::FunctionDecl &function,
+                             const clang::Stmt &stmt );
+    /// @brief Return the context of a statement, looking up its enclosing
+    /// function through the parent map
+    /// @details For the mutators not driven by a Mutation Template, which
+    ///          don't have the function bound.
+    const StmtContext &get ( clang::ASTContext &context,
+                             const clang::Stmt &stmt );
+
+    /// @brief Drop all the indexes, e.g. when the AST is released
+    void clear() {
+        this->functions.clear();
+    }
+
+private:
+    /// @brief One index per function, nodes are stable across rehashing
+    ::std::unordered_map<const clang::FunctionDecl *, StmtContextMap> functions;
+    const StmtContext none; ///< Context of the unknown statements
+};
+
+} // End chimera namespace
+
+#endif /* INCLUDE_CONTEXT_INDEX_H_ */
@@ -0,0 +1,132 @@
+//===- DeferredMutant.h -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file DeferredMutant.h
+/// \brief This file contains the class DeferredMutant, used to validate HOM
+///        mutants once per translation unit
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_DEFERRED_MUTANT_H_
+#define INCLUDE_DEFERRED_MUTANT_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace chimera
+{
+namespace mutant
+{
+
+/// @brief Select the largest subset of items that passes a check
+/// @details All the items are tried at once, on a failure the set is split in
+///          halves, recursively, until the offending items are isolated and
+///          dropped. The items accepted so far are kept in every next check.
+/// @param size The number of items
+/// @param check The function that checks a selection of items
+/// @return For each item, if it has been selected
+::std::vector<bool> bisectSelection (
+    ::std::size_t size,
+    const ::std::function<bool ( const ::std::vector<bool> & ) > &check );
+
+/// @brief    A HOM mutant whose mutations are validated all together
+/// @details  Each mutation is recorded as the edits between the content
+///           before and after it, one for each changed region (see
+///           computeEdits()), kept in the coordinates of the original
+///           content. An edit that overlaps (or touches) the text produced by
+///           previous edits depends on them, thus it is merged with them.
+///           The edits of a mutation, and the mutations whose edits have been
+///           merged, form a group. Groups are independent, so any subset of
+///           them can be applied to the original content: distant edits of a
+///           mutation, e.g. a declaration on top of the function and the
+///           mutated expression, don't bind the mutations in between.
+///           On a failed check the groups are bisected, dropping only the
+///           offending ones: a single bad group costs O(log N) checks.
+class DeferredMutant
+{
+public:
+    /// @brief Function used to check the content of a mutant
+    using CheckFunction = ::std::function<bool ( const ::std::string & )>;
+
+    /// @brief Ctor
+    /// @param original The content of the target before any mutation
+    explicit DeferredMutant ( const ::std::string &original );
+
+    /// @brief Record a mutation
+    /// @param code The whole mutated content after the mutation
+    /// @return The index of the mutation
+    unsigned addMutation ( const ::std::string &code );
+
+    const ::std::string &getOriginal() const {
+        return this->original;
+    }
+    unsigned getMutationsNumber() const {
+        return this->mutationsNumber;
+    }
+    unsigned getGroupsNumber() const;
+
+    /// @brief Validate the mutant, dropping the offending mutations
+    /// @param check The function that checks a content
+    /// @param keptMutations For each mutation index, if it survived
+    /// @return The content of the mutant made of the surviving mutations
+    ::std::string validate ( const CheckFunction &check,
+                             ::std::vector<bool> &keptMutations ) const;
+
+private:
+    /// @brief Edit of a group, in the coordinates of the original content
+    struct Piece {
+        ::std::size_t origStart;          ///< First replaced original char
+        ::std::size_t origEnd;            ///< Past the last replaced char
+        ::std::string text;               ///< Replacement text
+        unsigned group;                   ///< Index of its group
+    };
+    /// @brief Mutations depending on each other
+    struct EditGroup {
+        ::std::vector<unsigned> mutations; ///< Sorted, empty once merged
+    };
+
+    /// @brief Record the replacement of current[start, end) with text
+    /// @param group The group of the other edits of the mutation, noGroup if
+    ///        none
+    /// @return The group of the edit
+    unsigned addEdit ( ::std::size_t start, ::std::size_t end,
+                       const ::std::string &text, unsigned group );
+
+    /// @brief Merge two groups, noGroup if none
+    /// @return The merged group
+    unsigned mergeGroups ( unsigned a, unsigned b );
+
+    /// @brief Apply the edits of a subset of groups to the original content
+    /// @param selected For each group, if it is applied
+    ::std::string apply ( const ::std::vector<bool> &selected ) const;
+
+    static const unsigned noGroup = ~0u;
+
+    const ::std::string original; ///< Original content
+    ::std::string current;        ///< Content after the last mutation
+    ::std::vector<Piece> pieces;  ///< Sorted by original position
+    ::std::vector<EditGroup> groups; ///< By index
+    unsigned mutationsNumber;
+};
+} // End chimera::mutant namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_DEFERRED_MUTANT_H_ */
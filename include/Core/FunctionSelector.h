@@ -0,0 +1,106 @@
+//===- FunctionSelector.h ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file FunctionSelector.h
+/// \brief This file contains the class FunctionSelector, which selects the
+///        functions to mutate from a FunOp configuration
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_FUNCTION_SELECTOR_H_
+#define INCLUDE_FUNCTION_SELECTOR_H_
+
+#include "Utils.h"
+#include "Core/MutationOperator.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Regex.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Forward declarations
+namespace clang
+{
+class FunctionDecl;
+}
+
+namespace chimera
+{
+
+/// @brief    Selection of the functions to mutate, per operator
+/// @details  It's built once from a FunOpConfMap, then each mutator matches
+///           all the function definitions and asks the selector if the one
+///           at hand is selected for its operator.
+///           A function selector can be:
+///           - a name, e.g. foo or ns::foo (as hasName);
+///           - a glob, if it contains * ? or [, e.g. test_*;
+///           - a regular expression prefixed by re:, e.g. re:(get|set)_.*
+///           Names are looked up in a hash set, while the globs and regular
+///           expressions of an operator are compiled in a single automaton.
+///           Both are matched against the whole name, against the qualified
+///           one if the selector contains ::
+class FunctionSelector
+{
+public:
+    /// @brief Ctor
+    /// @param map The FunOp configuration
+    /// @param operators All the loaded operators, for CHIMERA_ALL_OPERATORS
+    FunctionSelector ( const conf::FunOpConfMap &map,
+                       const ::std::vector<m_operator::IdType> &operators );
+
+    /// @brief Return the operators selected for at least a function
+    ::std::vector<m_operator::IdType> getOperators() const;
+
+    /// @brief If a function is selected for an operator
+    bool isSelected ( const ::clang::FunctionDecl &function,
+                      const m_operator::IdType &operatorId ) const;
+
+private:
+    /// @brief The functions selected for an operator
+    struct Selection {
+        Selection() : all ( false ) {}
+        bool all; ///< CHIMERA_ALL_FUNCTIONS
+        ::std::unordered_set<::std::string> names;
+        ::std::vector<::std::string> qualifiedNames;
+        ::std::vector<::std::string> patterns;          ///< Regex, unanchored
+        ::std::vector<::std::string> qualifiedPatterns; ///< Regex, unanchored
+        ::std::unique_ptr<::llvm::Regex> automaton;
+        ::std::unique_ptr<::llvm::Regex> qualifiedAutomaton;
+    };
+
+    /// @brief Add a selector of a function to an operator
+    void addSelector ( const m_operator::IdType &operatorId,
+                       const ::std::string &selector );
+    /// @brief Compile the patterns of a selection in a single anchored regex
+    static ::std::unique_ptr<::llvm::Regex>
+    compile ( const ::std::vector<::std::string> &patterns );
+
+    ::std::map<m_operator::IdType, Selection> selections;
+};
+
+/// @brief Translate a glob (* ? [...]) into an unanchored POSIX regex
+::std::string globToRegex ( ::llvm::StringRef glob );
+
+} // End chimera namespace
+
+#endif /* INCLUDE_FUNCTION_SELECTOR_H_ */
@@ -0,0 +1,115 @@
+//===- Matchers.h -----------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file Matchers.h
+/// \brief This file contains the AST matchers shared among the mutators
+/// \details The type of an operand is matched on the kind of its canonical
+///          builtin type, instead of printing the type and comparing strings
+///          as hasCanonicalType(asString(...)) does.
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MATCHERS_H_
+#define INCLUDE_MATCHERS_H_
+
+#include "clang/AST/Type.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+
+#include <string>
+
+namespace chimera
+{
+namespace matchers
+{
+
+/// @brief Matches the types whose canonical type is the unqualified builtin
+/// kind, as hasCanonicalType(asString(...)) on its spelling
+AST_MATCHER_P ( clang::QualType, hasBuiltinKind, clang::BuiltinType::Kind,
+                kind )
+{
+    const clang::QualType canonical = Node.getCanonicalType();
+    const clang::BuiltinType *builtin =
+        llvm::dyn_cast<clang::BuiltinType> ( canonical.getTypePtr() );
+    return builtin != nullptr && !canonical.hasLocalQualifiers() &&
+           builtin->getKind() == kind;
+}
+
+/// @brief Matches the 8-bit integer types, char included
+AST_MATCHER ( clang::QualType, isEightBitInteger )
+{
+    const clang::QualType canonical = Node.getCanonicalType();
+    const clang::BuiltinType *builtin =
+        llvm::dyn_cast<clang::BuiltinType> ( canonical.getTypePtr() );
+    if ( builtin == nullptr ) {
+        return false;
+    }
+    switch ( builtin->getKind() ) {
+    case clang::BuiltinType::Char_U:
+    case clang::BuiltinType::UChar:
+    case clang::BuiltinType::Char_S:
+    case clang::BuiltinType::SChar:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @defgroup
+/// @brief Shorthands for the builtin kinds used by the mutators
+/// @{
+clang::ast_matchers::internal::Matcher<clang::QualType> isFloat();
+clang::ast_matchers::internal::Matcher<clang::QualType> isDouble();
+clang::ast_matchers::internal::Matcher<clang::QualType> isInt();
+clang::ast_matchers::internal::Matcher<clang::QualType> isUnsignedInt();
+/// @}
+
+/// @brief Matches an operand, binding as id the expression beneath the
+/// parenthesis, the implicit casts and at most one explicit cast
+clang::ast_matchers::internal::Matcher<clang::Expr>
+operand ( const std::string &id );
+
+/// @brief Matches an operand whose type matches type, as operand(id)
+clang::ast_matchers::internal::Matcher<clang::Expr>
+operand ( const clang::ast_matchers::internal::Matcher<clang::QualType> &type,
+          const std::string &id );
+
+/// @brief Matches the binary operations on float/double operands in a single
+/// pass
+/// @details The operation is bound as "floatOp" when both the operands are
+///          float, as "doubleOp" when they are double or, with
+///          mixedPrecision, when one is float and the other double. The
+///          operands are bound as "lhs" and "rhs", see operand().
+/// @param mixedPrecision If also the float/double operations are matched
+clang::ast_matchers::StatementMatcher
+floatOperation ( bool mixedPrecision = true );
+/// @brief Key of floatOperation(true), see Mutator::getMatcherKey()
+extern const char floatOperationKey[];
+
+/// @brief Matches the binary operations on integer operands
+/// @details The operation is bound as "int_op", the operands as "lhs" and
+///          "rhs", see operand(). The operator is left to the fine grain.
+clang::ast_matchers::StatementMatcher integerOperation();
+
+/// @brief Key of integerOperation(), see Mutator::getMatcherKey()
+extern const char integerOperationKey[];
+
+} // End matchers namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_MATCHERS_H_ */
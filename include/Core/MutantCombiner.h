@@ -0,0 +1,108 @@
+//===- MutantCombiner.h -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantCombiner.h
+/// \brief This file contains the class MutantCombiner, which composes higher
+///        order mutants from the edit scripts of first order ones
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MUTANT_COMBINER_H_
+#define INCLUDE_MUTANT_COMBINER_H_
+
+#include "Core/Mutant.h"
+#include "Core/MutantDelta.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace chimera
+{
+namespace mutant
+{
+
+/// @brief A combination of FOM mutants
+struct Combination {
+    ::std::vector<IdType> parents; ///< Ids of the combined mutants, ascending
+    EditScript edits;              ///< Composed edits, on the original
+};
+
+/// @brief    Composition engine of higher order mutants
+/// @details  The valid FOM mutants of a target are added with their edit
+///           scripts on the original content. Two of them conflict if their
+///           edits overlap, e.g. two mutations of the same operation, or of
+///           nested expressions. A combination of order k is a set of k
+///           pairwise non conflicting mutants, whose edits are composed
+///           without running the mutators again.
+///           If the combinations of an order fit the budget they are all
+///           enumerated, otherwise they are sampled uniformly (with a fixed
+///           seed, so that the analysis is reproducible).
+class MutantCombiner
+{
+public:
+    /// @brief Ctor
+    /// @param maxOrder The highest order, the combinations are of order 2 up
+    ///        to it
+    /// @param budget Maximum number of combinations, over all the orders
+    MutantCombiner ( unsigned maxOrder, ::std::size_t budget );
+
+    /// @brief Add a FOM mutant
+    /// @param edits Its sorted edits, see normalizeEdits()
+    void add ( IdType id, EditScript edits );
+
+    ::std::size_t size() const {
+        return this->mutants.size();
+    }
+
+    /// @brief Enumerate or sample the combinations, lower orders first
+    /// @details The budget left by an order passes on to the next ones.
+    ::std::vector<Combination> combine() const;
+
+private:
+    /// @brief A FOM mutant, with the range spanned by its edits
+    struct FirstOrder {
+        IdType id;
+        EditScript edits;
+        ::std::size_t begin; ///< Offset of the first edit
+        ::std::size_t end;   ///< End of the last edit
+    };
+
+    /// @brief If the edits of two mutants overlap
+    bool conflicts ( ::std::size_t a, ::std::size_t b ) const;
+    /// @brief Count the combinations of order k, up to limit
+    ::std::size_t count ( unsigned k, ::std::size_t limit ) const;
+    /// @brief Append all the combinations of order k
+    void enumerate ( unsigned k, ::std::vector<Combination> &out ) const;
+    /// @brief Append up to n distinct combinations of order k, drawn at random
+    void sample ( unsigned k, ::std::size_t n,
+                  ::std::vector<Combination> &out ) const;
+    /// @brief Build a combination from the indexes of its mutants
+    /// @return false if the edits can't be composed
+    bool compose ( const ::std::vector<::std::size_t> &indexes,
+                   Combination &combination ) const;
+
+    const unsigned maxOrder;
+    const ::std::size_t budget;
+    ::std::vector<FirstOrder> mutants; ///< In insertion (id) order
+};
+
+} // End mutant namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_MUTANT_COMBINER_H_ */
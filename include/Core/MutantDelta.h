@@ -0,0 +1,164 @@
+//===- MutantDelta.h --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantDelta.h
+/// \brief This file contains the compact storage of the mutants, as edit
+///        scripts on the original content of the target
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MUTANT_DELTA_H_
+#define INCLUDE_MUTANT_DELTA_H_
+
+#include "Core/Mutant.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace chimera
+{
+namespace mutant
+{
+
+/// @brief Available layouts for the saved mutants
+enum class MutantStorage {
+    Tree, ///< A directory with the whole mutated target for each mutant
+    Delta, ///< A single indexed file of edit scripts per target
+    Pack   ///< A single pack of sources and artifacts per target (MutantPack)
+};
+
+/// @brief Replacement of a range of the original content
+struct Edit {
+    ::std::size_t offset;      ///< Offset of the range in the original
+    ::std::size_t length;      ///< Length of the replaced range
+    ::std::string replacement; ///< New content of the range
+};
+using EditScript = ::std::vector<Edit>;
+
+/// @brief Compute the edits turning \p original into \p code
+/// @details The edits are sorted and don't overlap. Distant changes (e.g. an
+///          #include added on top and an expression mutated far below) give
+///          distinct edits, the unchanged lines between them are not stored.
+EditScript computeEdits ( const ::std::string &original,
+                          const ::std::string &code );
+
+/// @brief Apply a sorted edit script to \p original
+::std::string applyEdits ( const ::std::string &original,
+                           const EditScript &edits );
+
+/// @brief Sort an edit script produced by a mutator, dropping the edits that
+/// don't change anything
+/// @details The insertions at the same offset are joined, in script order.
+/// @return false if two edits overlap, the script can't be applied then
+bool normalizeEdits ( EditScript &edits );
+
+/// @brief Compose two sorted edit scripts on the same original content
+/// @details The result applies both the mutations, e.g. to combine two FOM
+///          mutants without re-running their mutators. The insertions at
+///          the same offset are joined, those of \p first before.
+/// @return false if the scripts touch overlapping ranges
+bool composeEdits ( const EditScript &first, const EditScript &second,
+                    EditScript &composed );
+
+/// @brief    Writer of the mutants of a target in the delta format
+/// @details  The file starts with the name and the content of the target,
+///           then the mutants follow as edit scripts, in any order. An index
+///           of the mutants closes the file, the last line holds its offset.
+///           Lengths prefix every stored content, so it's binary safe.
+class MutantDeltaWriter
+{
+public:
+    /// @brief Ctor, open the file and write the target
+    /// @param path The path of the file
+    /// @param filename The name of the target
+    /// @param original The content of the target
+    MutantDeltaWriter ( const ::std::string &path,
+                        const ::std::string &filename,
+                        const ::std::string &original );
+    /// @brief Dtor, close the file if still open
+    ~MutantDeltaWriter();
+
+    bool isOpen() const {
+        return this->stream.is_open();
+    }
+
+    /// @brief Store a mutant
+    /// @param id The mutant id
+    /// @param code The whole mutated content of the target
+    /// @return If the mutant has been written, false if a mutant with the
+    ///         same id already has
+    bool add ( IdType id, const ::std::string &code );
+    /// @brief Store a mutant given as a sorted edit script on the original
+    bool add ( IdType id, const EditScript &edits );
+
+    /// @brief Write the index and close the file
+    /// @return If the file is complete
+    bool close();
+
+private:
+    ::std::ofstream stream;
+    const ::std::string original;
+    ::std::vector<::std::pair<IdType, ::std::uint64_t>>
+    index; ///< Offset of each mutant
+    ::std::set<IdType> ids; ///< Of the written mutants
+};
+
+/// @brief Reader of a file written by MutantDeltaWriter
+class MutantDeltaReader
+{
+public:
+    /// @brief Open a file and load its index
+    /// @return false if the file is not a complete delta file
+    bool open ( const ::std::string &path );
+
+    const ::std::string &getFilename() const {
+        return this->filename;
+    }
+    const ::std::string &getOriginal() const {
+        return this->original;
+    }
+    /// @brief Return the ids of the stored mutants, sorted
+    ::std::vector<IdType> getMutantIds() const;
+    bool hasMutant ( IdType id ) const {
+        return this->index.count ( id ) > 0;
+    }
+
+    /// @brief Read the edit script of a mutant
+    /// @return false if the mutant is not stored or the file is corrupted
+    bool getEdits ( IdType id, EditScript &edits );
+
+    /// @brief Rebuild the whole content of a mutant
+    /// @return false if the mutant is not stored or the file is corrupted
+    bool materialize ( IdType id, ::std::string &code );
+
+private:
+    ::std::ifstream stream;
+    ::std::string filename;
+    ::std::string original;
+    ::std::map<IdType, ::std::uint64_t> index; ///< Offset of each mutant
+};
+} // End chimera::mutant namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_MUTANT_DELTA_H_ */
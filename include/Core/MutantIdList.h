@@ -0,0 +1,67 @@
+//===- MutantIdList.h -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantIdList.h
+/// \brief This file contains the class MutantIdList, a selection of mutants
+///        given as a list of ids and ranges
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MUTANT_ID_LIST_H_
+#define INCLUDE_MUTANT_ID_LIST_H_
+
+#include "Core/Mutant.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <utility>
+#include <vector>
+
+namespace chimera
+{
+namespace mutant
+{
+
+/// @brief    A list of mutant ids and ranges, e.g. 1-10,15
+/// @details  The ranges are kept as such, never expanded: a range as wide
+///           as 1-4000000000 costs as much as a single id. The selected
+///           mutants are the existing ones falling in the list.
+class MutantIdList
+{
+public:
+    /// @brief Parse a list of ids and ranges first-last, separated by commas
+    /// @return false if malformed
+    static bool parse ( ::llvm::StringRef list, MutantIdList &ids );
+
+    /// @brief If the id falls in the list
+    bool contains ( IdType id ) const;
+
+    /// @brief Return the ids in the list among the existing ones
+    /// @param existing The ids of the existing mutants
+    /// @return The selected ids, in the order of existing
+    ::std::vector<IdType>
+    select ( const ::std::vector<IdType> &existing ) const;
+
+private:
+    ::std::vector<::std::pair<IdType, IdType>> ranges; ///< Inclusive
+};
+} // End chimera::mutant namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_MUTANT_ID_LIST_H_ */
@@ -0,0 +1,158 @@
+//===- MutantSampler.h ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantSampler.h
+/// \brief This file contains the class MutantSampler, which decides which
+///        candidate mutations of a target become mutants under a budget
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MUTANT_SAMPLER_H_
+#define INCLUDE_MUTANT_SAMPLER_H_
+
+#include "Core/CandidateCounter.h"
+#include "Core/MutantShard.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chimera
+{
+
+/// @brief Limits on the mutants of a target, 0 means no limit
+struct MutantBudget {
+    ::std::size_t maxMutants = 0;      ///< Over the whole target
+    ::std::size_t perOperator = 0;     ///< For each operator
+    ::std::size_t perFunction = 0;     ///< For each function
+    ::std::size_t perMutatorType = 0;  ///< For each mutation type of a mutator
+
+    /// @brief If any limit is set
+    bool isLimited() const {
+        return maxMutants != 0 || perOperator != 0 || perFunction != 0 ||
+               perMutatorType != 0;
+    }
+};
+
+/// @brief How the global limit is shared among the candidates
+enum class SamplingStrategy {
+    Uniform,     ///< A single stratum
+    ByFunction,  ///< A stratum per function
+    ByMutator,   ///< A stratum per mutator
+    ByRegion     ///< A stratum per region of lines
+};
+
+/// @brief    Deterministic sampler of the candidate mutations of a target
+/// @details  All the candidates are added before any of them is mutated, so
+///           that the sampled-out ones cost neither a syntax check nor any
+///           I/O. The global limit is allotted to the strata proportionally
+///           to their size, then the candidates are drawn in a seeded random
+///           order, skipping those exceeding a limit.
+///           Two candidates in the same stratum, with the same operator,
+///           function and mutation type, are interchangeable: each of them is
+///           selected with probability selected/candidates of such cell.
+///           The weight of a selected candidate is the inverse of that
+///           probability, so that the statistics on the mutants can be
+///           extended to all the candidates.
+///           With a shard, every process samples all the candidates the
+///           same way, then applies only the selected ones it owns. The
+///           index of a mutation is its ordinal in a single run.
+///           The draws are portable: the same seed yields the same sample
+///           whatever the standard library.
+class MutantSampler
+{
+public:
+    /// @brief Ctor
+    /// @param seed Seed of the draws, the same seed yields the same sample
+    /// @param regionLines Lines of a region, with SamplingStrategy::ByRegion
+    /// @param shard The shard applying the mutations
+    /// @param target The name of the target, in the shard keys
+    MutantSampler ( const MutantBudget &budget, SamplingStrategy strategy,
+                    unsigned seed, unsigned regionLines,
+                    const MutantShard &shard, const ::std::string &target );
+
+    /// @brief Add a candidate, one mutation for each of its types
+    /// @param isHom If its mutator is a HOM one
+    /// @return The index of its first mutation, the one of type t is the
+    ///         returned index + t
+    ::std::size_t add ( const Candidate &candidate, bool isHom );
+
+    /// @brief Select the mutations, once all of them have been added
+    void sample();
+
+    /// @brief If the shard owns the mutation of type type of a candidate
+    /// @param target The name of the target, in the shard keys
+    /// @param isHom If its mutator is a HOM one
+    static bool owns ( const MutantShard &shard, const ::std::string &target,
+                       const Candidate &candidate, unsigned type,
+                       bool isHom );
+
+    /// @brief If the mutation is selected, and owned by the shard
+    bool isSelected ( ::std::size_t index ) const {
+        return this->units[index].selected && this->units[index].owned;
+    }
+
+    /// @brief If any of the mutations [first, first + count) is selected
+    bool isAnySelected ( ::std::size_t first, ::std::size_t count ) const;
+
+    /// @brief Return the weight of a selected mutation
+    double getWeight ( ::std::size_t index ) const;
+
+    /// @brief Return the stratum of a mutation
+    const ::std::string &getStratum ( ::std::size_t index ) const {
+        return this->units[index].stratum;
+    }
+
+    ::std::size_t size() const {
+        return this->units.size();
+    }
+
+private:
+    /// @brief A single candidate mutation
+    struct Unit {
+        ::std::string stratum;
+        ::std::string operatorId;
+        ::std::string functionName;
+        ::std::string mutatorType;  ///< Mutator identifier and type
+        ::std::string cell;         ///< Group of interchangeable mutations
+        bool selected;
+        bool owned;                 ///< By the shard
+    };
+
+    /// @brief Return the stratum of a candidate
+    ::std::string stratumOf ( const Candidate &candidate ) const;
+
+    /// @brief Allot the global limit to the strata, largest remainder first
+    ::std::map<::std::string, ::std::size_t> allot (
+        const ::std::map<::std::string, ::std::size_t> &sizes ) const;
+
+    const MutantBudget budget;
+    const SamplingStrategy strategy;
+    const unsigned seed;
+    const unsigned regionLines;
+    const MutantShard shard;
+    const ::std::string target;
+    ::std::vector<Unit> units;  ///< In insertion order
+    ::std::map<::std::string, ::std::size_t> cellSizes;
+    ::std::map<::std::string, ::std::size_t> cellSelected;
+};
+} // End chimera namespace
+
+#endif /* INCLUDE_MUTANT_SAMPLER_H_ */
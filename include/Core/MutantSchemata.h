@@ -0,0 +1,112 @@
+//===- MutantSchemata.h -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantSchemata.h
+/// \brief This file contains the class MutantSchemata, a single source that
+///        embeds many FOM mutants selected at run-time
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MUTANT_SCHEMATA_H_
+#define INCLUDE_MUTANT_SCHEMATA_H_
+
+#include "Core/Mutant.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace chimera
+{
+namespace mutant
+{
+
+/// @brief    Mutant schemata of a target
+/// @details  Each FOM mutant whose changes lie within an expression (its
+///           site) is guarded by a run-time selector:
+///             (chimera_mutant_id() == 1 ? (mutated) : (original))
+///           Mutants on the same site are chained in the same conditional,
+///           mutants whose site overlaps another site are not accepted.
+///           The selector is read once from the CHIMERA_MUTANT_ID environment
+///           variable, 0 (or unset) selects the original code. A #line
+///           directive keeps the line numbers of the original target.
+class MutantSchemata
+{
+public:
+    /// @brief Function used to check the content of a schemata
+    using CheckFunction = ::std::function<bool ( const ::std::string & )>;
+
+    /// @brief Ctor
+    /// @param original The content of the target
+    /// @param filename The name of the target, used by the #line directive
+    MutantSchemata ( const ::std::string &original,
+                     const ::std::string &filename );
+
+    /// @brief Try to guard a mutant in the schemata
+    /// @param id The mutant id
+    /// @param code The whole mutated content of the target
+    /// @param siteStart Offset of the first char of the mutated expression
+    /// @param siteEnd Offset past the last char of the mutated expression
+    /// @return false if the mutant changes something outside its site, or if
+    ///         the site overlaps another one
+    bool addMutant ( IdType id, const ::std::string &code,
+                     ::std::size_t siteStart, ::std::size_t siteEnd );
+
+    bool empty() const {
+        return this->sites.empty();
+    }
+
+    /// @brief Validate and build the schemata
+    /// @details The sites whose guarded version doesn't pass the check are
+    ///          found by bisection and left out.
+    /// @param check The function that checks a content
+    /// @param selectors The id of the mutant selected by each value, from 1
+    /// @param dropped The id of the mutants left out of the schemata
+    /// @return The content of the schemata
+    ::std::string build ( const CheckFunction &check,
+                          ::std::vector<IdType> &selectors,
+                          ::std::vector<IdType> &dropped ) const;
+
+    /// @brief Return the whole content of a single mutant of the schemata
+    ::std::string getMutantCode ( IdType id ) const;
+
+private:
+    /// @brief An expression mutated by one or more mutants
+    struct Site {
+        ::std::size_t start;
+        ::std::size_t end;
+        ::std::vector<::std::pair<IdType, ::std::string>> mutants;
+    };
+
+    /// @brief Render the schemata guarding a subset of the sites
+    /// @param dense If the selectors are numbered from 1, instead of using
+    ///        the mutant ids
+    ::std::string render ( const ::std::vector<bool> &selected,
+                           bool dense ) const;
+
+    const ::std::string original;
+    const ::std::string filename;
+    ::std::vector<Site> sites; ///< Sorted by position
+};
+} // End chimera::mutant namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_MUTANT_SCHEMATA_H_ */
@@ -0,0 +1,101 @@
+//===- MutantShard.h --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantShard.h
+/// \brief This file contains the class MutantShard, which partitions the
+///        candidate mutations among independent processes
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MUTANT_SHARD_H_
+#define INCLUDE_MUTANT_SHARD_H_
+
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <string>
+
+namespace chimera
+{
+
+/// @brief    A shard i/N of a mutation campaign
+/// @details  Each candidate mutation has a stable key (file, function,
+///           location, mutator and type), hashed to pick the owning shard,
+///           so that N processes analyzing the same sources apply disjoint
+///           sets of mutations, whose union is the one of a single run. The
+///           mutations of a HOM operator are keyed by file and operator, to
+///           keep its mutant (and its side reports) in one shard.
+class MutantShard
+{
+public:
+    /// @brief Ctor, the whole campaign
+    MutantShard() : index ( 0 ), count ( 1 ) {}
+    MutantShard ( unsigned index, unsigned count )
+        : index ( index ), count ( count ) {}
+
+    /// @brief Parse a shard given as i/N, with 0 <= i < N
+    /// @return false if malformed
+    static bool parse ( ::llvm::StringRef spec, MutantShard &shard );
+
+    unsigned getIndex() const {
+        return this->index;
+    }
+    unsigned getCount() const {
+        return this->count;
+    }
+    /// @brief If the campaign is split among more shards
+    bool isSharded() const {
+        return this->count > 1;
+    }
+
+    /// @brief If this shard owns the mutation with the given key
+    bool owns ( ::llvm::StringRef key ) const;
+
+    /// @brief Hash a key, stable among processes and machines
+    static ::std::uint64_t hash ( ::llvm::StringRef key );
+
+    /// @brief Return the key of a FOM mutation
+    /// @param mutatorType The mutator identifier and the mutation type
+    static ::std::string getKey ( const ::std::string &target,
+                                  const ::std::string &functionName,
+                                  unsigned line, unsigned column,
+                                  const ::std::string &mutatorType ) {
+        return target + "|" + functionName + "|" + ::std::to_string ( line ) +
+               ":" + ::std::to_string ( column ) + "|" + mutatorType;
+    }
+
+    /// @brief Return the key of all the mutations of a HOM operator
+    static ::std::string getHomKey ( const ::std::string &target,
+                                     const ::std::string &operatorId ) {
+        return target + "|" + operatorId;
+    }
+
+    /// @brief Return the shard as i/N
+    ::std::string str() const {
+        return ::std::to_string ( this->index ) + "/" +
+               ::std::to_string ( this->count );
+    }
+
+private:
+    unsigned index;
+    unsigned count;
+};
+} // End chimera namespace
+
+#endif /* INCLUDE_MUTANT_SHARD_H_ */
@@ -0,0 +1,113 @@
+//===- MutationJournal.h ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutationJournal.h
+/// \brief This file contains the class MutationJournal, the checkpoint of
+///        the verdicts of a target, used to resume an interrupted analysis
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_MUTATION_JOURNAL_H_
+#define INCLUDE_MUTATION_JOURNAL_H_
+
+#include "Core/Mutant.h"
+
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace chimera
+{
+
+/// @brief    Append-only journal of the checked mutations of a target
+/// @details  Each line is <ordinal>,<valid>,<id>,<key>, written (and
+///           flushed) as soon as the verdict of a mutation is consumed. The
+///           ordinal is the position of the mutation in the analysis, the
+///           key (see MutantShard::getKey()) guards against a changed source.
+///           Resuming, the mutations are applied again in the same order,
+///           taking the journaled verdicts instead of checking them again:
+///           the mutant ids, the reserved rewriters, the mutators' state and
+///           all the outputs are rebuilt as in the interrupted analysis,
+///           paying only the checks never completed.
+///           The checks of a whole content (the deferred HOM mutants, the
+///           combinations and the mutant schemata) are journaled as
+///           check,<valid>,<key>, where the key hashes the checked content.
+///           Since they follow all the mutations of the translation unit,
+///           they are looked up by content rather than by position.
+class MutationJournal
+{
+public:
+    /// @brief Open the journal
+    /// @param resume If the entries already in the file have to be loaded,
+    ///        otherwise the file is truncated
+    /// @return If the journal is open
+    bool open ( const ::std::string &path, bool resume );
+
+    bool isOpen() const {
+        return this->stream.is_open();
+    }
+
+    /// @brief Number of the loaded entries
+    ::std::size_t size() const {
+        return this->entries.size();
+    }
+
+    /// @brief Look up the verdict of a mutation
+    /// @return false if not journaled, or journaled with another key
+    bool lookup ( ::std::size_t ordinal, const ::std::string &key,
+                  bool &valid, mutant::IdType &id ) const;
+
+    /// @brief Append the verdict of a mutation
+    /// @param id The mutant id, if valid
+    void record ( ::std::size_t ordinal, const ::std::string &key, bool valid,
+                  mutant::IdType id );
+
+    /// @brief Look up the verdict of a check of a whole content
+    /// @return false if not journaled
+    bool lookupCheck ( const ::std::string &key, bool &valid ) const;
+
+    /// @brief Append the verdict of a check of a whole content
+    void recordCheck ( const ::std::string &key, bool valid );
+
+    /// @brief Forget the loaded verdicts of the mutations, the next ones are
+    /// appended as usual
+    /// @details Called when the analysis diverges from the journaled one.
+    ///          The checks of a whole content are kept, their key hashes the
+    ///          checked content.
+    void discardEntries() {
+        this->entries.clear();
+    }
+
+    void close();
+
+private:
+    struct Entry {
+        ::std::string key;
+        bool valid;
+        mutant::IdType id;
+    };
+
+    ::std::map<::std::size_t, Entry> entries; ///< Loaded, by ordinal
+    ::std::map<::std::string, bool> checks;   ///< Loaded, by content key
+    ::std::ofstream stream;
+};
+} // End chimera namespace
+
+#endif /* INCLUDE_MUTATION_JOURNAL_H_ */
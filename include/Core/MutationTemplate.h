@@ -29,9 +29,21 @@
 
 #include "Utils.h"
 #include "Log.h"
+#include "Core/CandidateCounter.h"
+#include "Core/ContextIndex.h"
 #include "Core/Mutant.h"
+#include "Core/MutantDelta.h"
+#include "Core/MutantSampler.h"
+#include "Core/MutantShard.h"
+#include "Core/MutationJournal.h"
 #include "Core/MutationOperator.h"
+#include "Core/SlotManager.h"
+#include "Core/TimeReport.h"
+#include "Pack/MutantPack.h"
+#include "Tooling/MutantValidator.h"
+#include "Tooling/ValidationPool.h"
 
+#include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/Tooling/Tooling.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/StringRef.h"
@@ -39,6 +51,7 @@
 
 #include <fstream>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -54,6 +67,12 @@ class MatchFinder;
 
 namespace chimera
 {
+class BinaryOperatorMatcher;
+class FunctionSelector;
+class MatchWorkList;
+class PendingMutantQueue;
+class SharedMatcherCallback;
+
 /// @brief This class represent the context of mutation for a single .h/.cpp
 /// file.
 class MutationTemplate
@@ -61,6 +80,8 @@ class MutationTemplate
     // Usings
     using OperatorPtr = m_operator::MutationOperator *;
     using OperatorPtrMap = std::map<m_operator::IdType, OperatorPtr>;
+    using RewriterSlotManager = SlotManager<mutant::IdType, ::clang::Rewriter>;
+    using IdSlotManager = SlotManager<m_operator::IdType, mutant::IdType>;
 
 public:
     /// @brief Build a Mutation Template from :
@@ -69,6 +90,7 @@ public:
     /// @param outputDirectory The directory for the outputs
     MutationTemplate ( const clang::tooling::CompileCommand &, std::string target,
                        std::string outputDirectory = "." );
+    ~MutationTemplate();
 
     // Getter and Setter
     const std::string &getTargetPath() const {
@@ -80,8 +102,7 @@ public:
 
     void setTargetPath ( const std::string &target ) {
         this->targetPath = ::clang::tooling::getAbsolutePath ( target );
-        ::chimera::log::ChimeraLogger::verbose ( "Setting target path: " +
-                this->targetPath );
+        CHIMERA_VERBOSE ( "Setting target path: " + this->targetPath );
     }
 
     const std::string &getOutputDirectory() const {
@@ -101,8 +122,8 @@ public:
         if ( this->outputDirectory.back() != chimera::fs::pathSep ) {
             this->outputDirectory.push_back ( chimera::fs::pathSep );
         }
-        chimera::log::ChimeraLogger::verbose ( "Setting output directory: " +
-                                               this->outputDirectory );
+        CHIMERA_VERBOSE ( "Setting output directory: " +
+                          this->outputDirectory );
     }
 
     bool isGenerateMutantsReport() {
@@ -119,6 +140,36 @@ public:
         this->generateMutants = val;
     }
 
+    mutant::MutantStorage getMutantStorage() const {
+        return this->mutantStorage;
+    }
+    /// @brief Set the layout of the saved mutants
+    void setMutantStorage ( mutant::MutantStorage storage ) {
+        this->mutantStorage = storage;
+    }
+
+    /// @brief Return the path of the delta file of the target
+    std::string getDeltaPath() {
+        return this->getTargetOutputDirectory() + "mutants.delta";
+    }
+
+    /// @brief Return the path of the pack of the target
+    std::string getPackPath() {
+        return this->getTargetOutputDirectory() + "mutants.pack";
+    }
+
+    /// @brief Return the directory (with trailing pathSep) in which the
+    /// mutators save the artifacts of a mutant
+    /// @details With the pack storage it's a staging directory, moved into
+    ///          the pack at the end of the analysis.
+    std::string getMutantDirectory ( mutant::IdType id ) {
+        std::string dir = this->getTargetOutputDirectory();
+        if ( this->mutantStorage == mutant::MutantStorage::Pack ) {
+            dir += std::string ( "staging" ) + ::chimera::fs::pathSep;
+        }
+        return dir + std::to_string ( id ) + ::chimera::fs::pathSep;
+    }
+
     /// @defgroup
     /// @brief Functions to manage the mutation template's report stream
     /// @{
@@ -133,6 +184,293 @@ public:
         return compileCommand;
     }
 
+    /// @brief Return the path on which the mutants are mapped for the syntax
+    /// check. It is a virtual path, nothing is written there.
+    std::string getValidationPath() {
+        return this->getTargetOutputDirectory() + "temp" +
+               ::chimera::fs::pathSep + this->getTargetFilename().data();
+    }
+
+    ValidationMode getValidationMode() const {
+        return this->validationMode;
+    }
+    void setValidationMode ( ValidationMode mode ) {
+        this->validationMode = mode;
+    }
+
+    bool isDeferredHomValidation() const {
+        return this->deferredHomValidation;
+    }
+    /// @brief If the HOM mutants have to be checked once, at the end of the
+    /// translation unit, instead of after each mutation
+    void setDeferredHomValidation ( bool val ) {
+        this->deferredHomValidation = val;
+    }
+
+    bool isDeduplicate() const {
+        return this->deduplicate;
+    }
+    /// @brief If the FOM mutants identical to an earlier one have to be
+    /// reported as its duplicates, instead of being checked and saved
+    void setDeduplicate ( bool val ) {
+        this->deduplicate = val;
+    }
+
+    bool isSchemata() const {
+        return this->schemata;
+    }
+    /// @brief If the valid FOM mutants have to be guarded in a single mutant
+    /// schemata, instead of being saved one by one
+    void setSchemata ( bool val ) {
+        this->schemata = val;
+    }
+
+    unsigned getHomOrder() const {
+        return this->homOrder;
+    }
+    /// @brief Set the highest order of the combinations of the valid FOM
+    /// mutants, checked at the end of the translation unit. Below 2 the FOM
+    /// mutants are not combined.
+    void setHomOrder ( unsigned order ) {
+        this->homOrder = order;
+    }
+
+    ::std::size_t getHomBudget() const {
+        return this->homBudget;
+    }
+    /// @brief Set the maximum number of combinations of FOM mutants, beyond
+    /// which they are sampled
+    void setHomBudget ( ::std::size_t budget ) {
+        this->homBudget = budget;
+    }
+
+    bool isCountOnly() const {
+        return this->countOnly;
+    }
+    /// @brief If the analysis only counts the candidate mutations, running
+    /// the matchers and the fine grain matching of the mutators, but neither
+    /// mutating nor checking anything
+    void setCountOnly ( bool val ) {
+        this->countOnly = val;
+    }
+
+    CountFormat getCountFormat() const {
+        return this->countFormat;
+    }
+    /// @brief Set the format of the candidate counts
+    void setCountFormat ( CountFormat format ) {
+        this->countFormat = format;
+    }
+
+    /// @brief Return the candidate mutations, available during a count-only
+    /// analysis
+    CandidateCounter &getCandidates() {
+        return *this->candidates;
+    }
+
+    bool isTrustedMutators() const {
+        return this->trustedMutators;
+    }
+    /// @brief If the validation policies of the mutators are honored,
+    /// otherwise every mutant is checked
+    void setTrustedMutators ( bool val ) {
+        this->trustedMutators = val;
+    }
+
+    int getValidationSample() const {
+        return this->validationSample;
+    }
+    /// @brief Set the percentage of the mutants checked for the mutators
+    /// with the SampleValidation policy, negative to use their own
+    void setValidationSample ( int percentage ) {
+        this->validationSample = percentage;
+    }
+
+    /// @brief Draw if a mutant is in a sample of the given percentage
+    /// @details The draw hashes the key of the mutation, so it doesn't depend
+    ///          on the other draws: it is the same among the analyses, the
+    ///          platforms, the shards and a resumed analysis.
+    /// @param key The key of the mutation, see MutantShard::getKey()
+    static bool sampleValidation ( unsigned percentage,
+                                   const ::std::string &key ) {
+        // Salted, not to follow the shard of the mutation
+        return MutantShard::hash ( "validation|" + key ) % 100 < percentage;
+    }
+
+    /// @brief Record a sampled mutant of a trusted mutator that failed the
+    /// check, the analysis then fails
+    void addTrustViolation() {
+        ++this->trustViolations;
+    }
+
+    const MutantBudget &getBudget() const {
+        return this->budget;
+    }
+    /// @brief Set the limits on the mutants of the target. When any is set,
+    /// the candidate mutations are sampled before being applied.
+    void setBudget ( const MutantBudget &budget ) {
+        this->budget = budget;
+    }
+
+    SamplingStrategy getSamplingStrategy() const {
+        return this->samplingStrategy;
+    }
+    /// @brief Set how the global limit is shared among the candidates
+    void setSamplingStrategy ( SamplingStrategy strategy ) {
+        this->samplingStrategy = strategy;
+    }
+
+    unsigned getSamplingSeed() const {
+        return this->samplingSeed;
+    }
+    void setSamplingSeed ( unsigned seed ) {
+        this->samplingSeed = seed;
+    }
+
+    unsigned getSamplingRegionLines() const {
+        return this->samplingRegionLines;
+    }
+    /// @brief Set the lines of a region, with SamplingStrategy::ByRegion
+    void setSamplingRegionLines ( unsigned lines ) {
+        this->samplingRegionLines = lines;
+    }
+
+    const MutantShard &getShard() const {
+        return this->shard;
+    }
+    /// @brief Set the shard of the campaign whose mutations are applied
+    /// @details The mutant ids are local to the shard, the merge renumbers
+    ///          them as in a single run, see shard.csv.
+    void setShard ( const MutantShard &shard ) {
+        this->shard = shard;
+    }
+
+    /// @brief Return the stream of the shard positions, shard.csv, open
+    /// during a sharded analysis
+    std::ostream &getShardStream() {
+        return this->shardStream;
+    }
+
+    bool isJournaled() const {
+        return this->journaled;
+    }
+    /// @brief If the verdicts are journaled in journal.csv, so that an
+    /// interrupted analysis can be resumed, see MutationJournal
+    void setJournaled ( bool val ) {
+        this->journaled = val;
+    }
+
+    bool isResume() const {
+        return this->resume;
+    }
+    /// @brief If the verdicts in the journal of an interrupted analysis have
+    /// to be reused, see MutationJournal. The analysis is journaled too
+    void setResume ( bool val ) {
+        this->resume = val;
+    }
+
+    /// @brief Return the journal of the verdicts, open during an analysis
+    MutationJournal &getJournal() {
+        return this->journal;
+    }
+
+    /// @brief Return the position of the next applied mutation
+    ::std::size_t nextOrdinal() {
+        return this->ordinal++;
+    }
+
+    /// @brief Return the position, in a single run, of the first of count
+    /// candidate mutations met without a sampler
+    ::std::size_t nextCandidates ( ::std::size_t count ) {
+        const ::std::size_t first = this->candidateIndex;
+        this->candidateIndex += count;
+        return first;
+    }
+
+    /// @brief Return the timings and counters of the pipeline, nullptr if
+    /// they are not collected
+    TimeReport *getTimeReport() {
+        return this->timeReport;
+    }
+    /// @brief Collect the timings and counters of the analysis in a report
+    /// @param file The source file the measures refer to, it could differ
+    ///        from the (preprocessed) target
+    void setTimeReport ( TimeReport *report, const ::std::string &file ) {
+        this->timeReport = report;
+        this->timeScope.file = file;
+    }
+    /// @brief Return the scope of the measures of the whole target
+    const TimeScope &getTimeScope() const {
+        return this->timeScope;
+    }
+    /// @brief Mark the end of the AST traversal, only the first call counts
+    void noteEndOfTraversal() {
+        if ( this->timeReport != nullptr &&
+                this->traversalEnd == TimeReport::Clock::time_point() ) {
+            this->traversalEnd = TimeReport::Clock::now();
+        }
+    }
+
+    /// @brief Return the sampler of the candidate mutations, nullptr if the
+    /// mutants are neither limited nor sharded, or outside an analysis
+    MutantSampler *getSampler() {
+        return this->sampler.get();
+    }
+
+    /// @brief Return the stream of the sampling weights, sampling_weights.csv,
+    /// open during an analysis with a sampler
+    std::ostream &getSamplingStream() {
+        return this->samplingStream;
+    }
+
+    unsigned getValidationJobs() const {
+        return this->validationJobs;
+    }
+    /// @brief Set the number of workers checking the mutants concurrently
+    void setValidationJobs ( unsigned jobs ) {
+        this->validationJobs = jobs > 0 ? jobs : 1;
+    }
+
+    /// @brief Return the validation workers, available during an analysis
+    ValidationPool &getValidationPool() {
+        return *this->validationPool;
+    }
+
+    /// @brief Return the writer of the delta file, available during an analysis
+    /// when the mutants are stored as deltas
+    mutant::MutantDeltaWriter &getDeltaWriter() {
+        return *this->deltaWriter;
+    }
+
+    /// @brief Return the writer of the pack, available during an analysis when
+    /// the mutants are packed
+    pack::PackWriter &getPackWriter() {
+        return *this->packWriter;
+    }
+
+    /// @brief Return the rewriters of the mutants, available during an analysis
+    RewriterSlotManager &getRewriterSlots() {
+        return this->rwManager;
+    }
+
+    /// @brief Return the matches recorded by the AST traversal, available
+    /// during an analysis
+    MatchWorkList &getMatches() {
+        return *this->matches;
+    }
+
+    /// @brief Return the context of the statements of the translation unit
+    /// under analysis
+    ContextIndex &getContextIndex() {
+        return this->contextIndex;
+    }
+
+    /// @brief Return the mutants waiting for a verdict, available during an
+    /// analysis
+    PendingMutantQueue &getPendingMutants() {
+        return *this->pendingMutants;
+    }
+
     /**
      * @brief Load an operator
      * @param mut_op Mutation operator
@@ -164,19 +502,16 @@ public:
 
 private:
     void initMutantIds_();
-    void addMatchers_ ( ::clang::ast_matchers::MatchFinder &,
-                        const m_operator::IdType &, const std::string & = "" );
     void addMatchers_ ( ::clang::ast_matchers::MatchFinder &,
                         const ::std::vector<m_operator::IdType> &,
-                        const ::std::string & );
+                        const FunctionSelector * = nullptr );
     int run ( clang::ast_matchers::MatchFinder & );
+    int count_ ( clang::ast_matchers::MatchFinder & );
+    int runTool_ ( clang::ast_matchers::MatchFinder & );
+    void packArtifacts_();
 
     ::clang::tooling::CompileCommand
     compileCommand;               ///< Compile command for this target.
-    ::clang::tooling::ClangTool tool; /**< Inner ClangTool to do the analysis */
-    /// @details To avoid multiple tool calling, it' used only one CompileCommand.
-    /// In particular
-    ///          the first found.
 
     ::std::string
     targetPath; /**< The mutation template target: path to source file */
@@ -185,10 +520,62 @@ private:
 
     bool generateMutantsReport; ///< If mutants report has to be save
     bool generateMutants;       ///< If mutants have to be saved.
+    mutant::MutantStorage mutantStorage; ///< Layout of the saved mutants
 
     ::std::string outputDirectory; ///< Output directory in which write outputs,
     ///it's saved as absolute path
     ::std::ofstream reportStream;
+    ValidationMode validationMode; ///< Engine used to check the mutants
+    unsigned validationJobs;       ///< Number of validation workers
+    bool deferredHomValidation;    ///< If HOM mutants are checked once
+    bool schemata;                 ///< If FOM mutants form a schemata
+    bool deduplicate;              ///< If identical FOM mutants are merged
+    unsigned homOrder;             ///< Highest order of the FOM combinations
+    ::std::size_t homBudget;       ///< Maximum number of FOM combinations
+    bool countOnly;                ///< If the candidates are only counted
+    CountFormat countFormat;       ///< Format of the candidate counts
+    bool trustedMutators;          ///< If the validation policies are honored
+    int validationSample;          ///< Sampled percentage, negative if unset
+    unsigned trustViolations;      ///< Sampled trusted mutants failing
+    MutantBudget budget;           ///< Limits on the mutants
+    SamplingStrategy samplingStrategy; ///< Strata of the sampled candidates
+    unsigned samplingSeed;         ///< Seed of the sampled candidates
+    unsigned samplingRegionLines;  ///< Lines of a sampling region
+    MutantShard shard;             ///< Mutations applied by this process
+    bool resume;                   ///< If the journaled verdicts are reused
+    bool journaled;                ///< If the verdicts are journaled
+    ::std::size_t ordinal;         ///< Of the next applied mutation
+    ::std::size_t candidateIndex;  ///< Of the next candidate mutation
+    TimeReport *timeReport;        ///< nullptr if not collected
+    TimeScope timeScope;           ///< Of the whole target
+    TimeReport::Clock::time_point traversalEnd; ///< Of the last analysis
+    ::std::unique_ptr<ValidationPool>
+    validationPool; ///< Validation workers for the mutants of the target
+    ::std::unique_ptr<FunctionSelector>
+    functionSelector; ///< Functions to mutate, from the FunOp configuration
+    ::std::unique_ptr<MatchWorkList>
+    matches; ///< Matches waiting for the mutation phase
+    ::std::unique_ptr<CandidateCounter>
+    candidates; ///< Candidate mutations, in the count-only mode
+    ::std::unique_ptr<MutantSampler>
+    sampler; ///< Selection of the candidates, when the mutants are limited
+    ::std::ofstream samplingStream; ///< Weights of the sampled mutants
+    ::std::ofstream shardStream;    ///< Positions of the shard mutants
+    MutationJournal journal;        ///< Verdicts of the target
+    ContextIndex contextIndex; ///< Shared by the mutators of the target
+    ::std::unique_ptr<PendingMutantQueue>
+    pendingMutants; ///< Mutants waiting for their verdict
+    ::std::vector<::std::unique_ptr<SharedMatcherCallback>>
+    sharedCallbacks; ///< Of the shared matchers, during an analysis
+    ::std::unique_ptr<BinaryOperatorMatcher>
+    visitorBackend; ///< Of the binary operator mutators, during an analysis
+    ::std::unique_ptr<mutant::MutantDeltaWriter>
+    deltaWriter; ///< Delta file of the target, when mutants are deltas
+    ::std::unique_ptr<pack::PackWriter>
+    packWriter; ///< Pack of the target, when mutants are packed
+
+    RewriterSlotManager rwManager; ///< Rewriters, one per reserved mutant id
+    IdSlotManager idManager;       ///< Mutant ids reserved by HOM operators
 };
 } // End chimera namespace
 
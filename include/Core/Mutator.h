@@ -27,12 +27,17 @@
 #ifndef INCLUDE_MUTATOR_H_
 #define INCLUDE_MUTATOR_H_
 
+#include "Core/ContextIndex.h"
+#include "Core/MutantDelta.h"
+
 #include "clang/AST/ASTTypeTraits.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace chimera
@@ -55,6 +60,19 @@ enum MatcherType {
     NestedNameSpecifierLocMatcherType
 };
 
+/// @brief Mutator's matching backend
+enum MatchBackend {
+    ASTMatcherBackend, ///< The matcher is added to the MatchFinder
+    BinaryOperatorVisitorBackend ///< See Core/BinaryOperatorMatcher.h
+};
+
+/// @brief Mutator's validation policy, honored in the trusted mutators mode
+enum ValidationPolicy {
+    AlwaysValidate, ///< Every mutant is checked
+    NeverValidate,  ///< The mutants are valid by construction
+    SampleValidation ///< Only a random sample of the mutants is checked
+};
+
 /**
  * @brief   Mutator Class, mutate the source code (translation unit) when it's
  * compliant to the matching rules.
@@ -84,7 +102,8 @@ public:
                        std::string description = "", MutatorType types = 0,
                        bool isHOM = false )
         : matcherType ( matcherType ), isHOM ( isHOM ), identifier ( identifier ),
-          description ( description ), types ( types ) {
+          description ( description ), types ( types ),
+          contextIndex ( nullptr ) {
         assert ( ( !isHOM || types == 1 ) &&
                  "HOM mutator MUST have zero mutation types" );
     }
@@ -124,6 +143,38 @@ public:
         return matcherType;
     }
 
+    /// @brief Return the key of the matcher, empty if it isn't shared
+    /// @details Mutators returning the same key MUST return the same matcher,
+    ///          which is then evaluated once for all of them by the Mutation
+    ///          Template. See the keys in Core/Matchers.h.
+    virtual ::std::string getMatcherKey() const {
+        return "";
+    }
+
+    /// @brief Return the backend evaluating the matcher
+    /// @details The BinaryOperatorVisitorBackend evaluates the statement
+    ///          matcher on the binary operators of the function bodies only,
+    ///          so the matcher has to match a binary operator at the top
+    ///          level, e.g. stmt(binaryOperator(...)).
+    virtual MatchBackend getMatchBackend() const {
+        return ASTMatcherBackend;
+    }
+
+    /// @brief Return how the mutants have to be checked in the trusted
+    /// mutators mode, otherwise they are always checked
+    /// @details A mutator can skip the syntax check only if its mutations are
+    ///          syntactically safe by construction. With SampleValidation a
+    ///          sampled mutant failing the check is reported as an error.
+    virtual ValidationPolicy getValidationPolicy() const {
+        return AlwaysValidate;
+    }
+
+    /// @brief Return the percentage of the mutants checked with the
+    /// SampleValidation policy
+    virtual unsigned getValidationSample() const {
+        return 10;
+    }
+
     const bool isHom() const {
         return isHOM;
     }
@@ -134,6 +185,12 @@ public:
         return this->additionalCompileCommands;
     }
 
+    /// @brief Set the context index of the translation unit under analysis,
+    /// queried through getContext()
+    void setContextIndex ( ContextIndex *index ) {
+        this->contextIndex = index;
+    }
+
     /**
      * @}
      */
@@ -168,6 +225,10 @@ public:
     /**
      * @brief If the matcher doesn't cover the matching logic. Fine grained
      * matching logic.
+     * @details The result, and the state kept for mutate(), must depend only
+     *          on the node: with a sampler the Mutation Template calls match()
+     *          on all the nodes, then again on the selected ones before
+     *          mutate().
      * @retval bool The node is matched or less. Default true
      */
     virtual bool match ( const NodeType &node ) {
@@ -182,12 +243,43 @@ public:
      */
     /**
      * @brief  Mutate a node with type
+     * @details The default implementation applies the edits of produceEdits()
+     *          on the rewriter, a mutator has to override one of the two.
      * @param node The node to mutate
      * @param type The type of mutation
      * @retval Rewriter& The Rewriter obj with code modification
      */
     virtual clang::Rewriter &mutate ( const NodeType &node, MutatorType type,
-                                      clang::Rewriter &rw ) = 0;
+                                      clang::Rewriter &rw ) {
+        mutant::EditScript edits;
+        if ( this->produceEdits ( node, type, edits ) ) {
+            const clang::SourceManager &manager = rw.getSourceMgr();
+            const clang::SourceLocation start =
+                manager.getLocForStartOfFile ( manager.getMainFileID() );
+            for ( const mutant::Edit &edit : edits ) {
+                rw.ReplaceText ( start.getLocWithOffset ( edit.offset ),
+                                 edit.length, edit.replacement );
+            }
+        }
+        return rw;
+    }
+
+    /**
+     * @brief  Describe the mutation of a node with type as an edit script on
+     * the original main file, alternative to mutate()
+     * @details For the FOM mutators the Mutation Template builds, checks and
+     *          stores the mutant straight from the edits, with no Rewriter per
+     *          mutant. The edits must not overlap. See replaceText().
+     * @param node The node to mutate
+     * @param type The type of mutation
+     * @param edits The edit script to fill
+     * @retval bool If the mutator produces edits, otherwise mutate() is used.
+     * Default false
+     */
+    virtual bool produceEdits ( const NodeType &node, MutatorType type,
+                                mutant::EditScript &edits ) {
+        return false;
+    }
 
     /**
      * @brief Clean a previous mutation
@@ -237,6 +329,72 @@ public:
      * @}
      */
 protected:
+    /// @brief Return the structural context of a statement in the function
+    /// bound by the Mutation Template, to be used in place of hasAncestor()
+    /// matchers. It can be called from match() and mutate().
+    /// @details Without the "functionDecl" binding the enclosing function is
+    ///          looked up through the parent map.
+    const StmtContext &getContext ( const NodeType &node,
+                                    const clang::Stmt &stmt ) {
+        assert ( this->contextIndex && "The context index is not set" );
+        const clang::FunctionDecl *function =
+            node.Nodes.getNodeAs<clang::FunctionDecl> ( "functionDecl" );
+        if ( function == nullptr ) {
+            // Not matched through a Mutation Template
+            return this->contextIndex->get ( *node.Context, stmt );
+        }
+        return this->contextIndex->get ( *function, stmt );
+    }
+
+    /// @brief Return the text of the tokens of a range, as written in the
+    /// original source
+    static ::std::string getSourceText ( const NodeType &node,
+                                         clang::SourceRange range ) {
+        return clang::Lexer::getSourceText (
+                   clang::CharSourceRange::getTokenRange ( range ),
+                   *node.SourceManager, node.Context->getLangOpts() )
+               .str();
+    }
+
+    /// @brief If the text of a range is returned by
+    /// Rewriter::getRewrittenText(), without building a Rewriter
+    static bool isRewritable ( const NodeType &node,
+                               clang::SourceRange range ) {
+        return clang::Rewriter::isRewritable ( range.getBegin() ) &&
+               clang::Rewriter::isRewritable ( range.getEnd() ) &&
+               node.SourceManager->getFileID ( range.getBegin() ) ==
+               node.SourceManager->getFileID ( range.getEnd() );
+    }
+
+    /// @brief Append to edits the replacement of the tokens of a range, as
+    /// Rewriter::ReplaceText does. To be used from produceEdits().
+    /// @return false if the range is not written in the main file
+    static bool replaceText ( const NodeType &node, clang::SourceRange range,
+                              const ::std::string &text,
+                              mutant::EditScript &edits ) {
+        const clang::SourceManager &manager = *node.SourceManager;
+        const clang::CharSourceRange chars = clang::Lexer::makeFileCharRange (
+                clang::CharSourceRange::getTokenRange ( range ), manager,
+                node.Context->getLangOpts() );
+        if ( chars.isInvalid() ) {
+            return false;
+        }
+        const std::pair<clang::FileID, unsigned> begin =
+            manager.getDecomposedLoc ( chars.getBegin() );
+        const std::pair<clang::FileID, unsigned> end =
+            manager.getDecomposedLoc ( chars.getEnd() );
+        if ( begin.first != manager.getMainFileID() ||
+                end.first != begin.first ) {
+            return false;
+        }
+        mutant::Edit edit;
+        edit.offset = begin.second;
+        edit.length = end.second - begin.second;
+        edit.replacement = text;
+        edits.push_back ( ::std::move ( edit ) );
+        return true;
+    }
+
     ::std::vector<::std::string> additionalCompileCommands;
 
 private:
@@ -246,6 +404,7 @@ private:
     ::std::string identifier;  ///< Mutator identifier
     ::std::string description; ///< Mutator description
     MutatorType types;         ///< Number of mutations supported
+    ContextIndex *contextIndex; ///< Context of the translation unit
 };
 } // End mutator namespace
 } // End chimera namespace
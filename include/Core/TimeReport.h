@@ -0,0 +1,145 @@
+//===- TimeReport.h ---------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file TimeReport.h
+/// \brief This file contains the class TimeReport, the per phase timings and
+///        the counters of the mutation pipeline (-time-report)
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TIME_REPORT_H_
+#define INCLUDE_TIME_REPORT_H_
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chimera
+{
+
+/// @brief Timed phases of the pipeline
+enum class TimePhase {
+    Preprocess, ///< Preprocessing of the source file
+    Parse,      ///< Frontend, up to the AST
+    Matching,   ///< Traversal of the AST with the coarse grain matchers
+    Match,      ///< Fine grain matching, Mutator::match()
+    Mutate,     ///< Mutator::mutate() or Mutator::produceEdits()
+    Check,      ///< Syntax check of the mutants, on the validation workers
+    Save,       ///< Storage of the valid mutants
+    Report,     ///< Mutator::onCreatedMutant()
+    Total,      ///< Whole analysis of the source file
+    Count_
+};
+
+/// @brief Counters of the pipeline
+enum class TimeCounter {
+    Candidates,   ///< Coarse grain matches
+    FinePasses,   ///< Fine grain matches
+    Valid,        ///< Mutants that passed the check
+    Invalid,      ///< Mutants that failed the check
+    BytesWritten, ///< Handed to the mutants storage
+    Count_
+};
+
+/// @brief What the measures refer to: a source file, or one of its mutators
+struct TimeScope {
+    ::std::string file;
+    ::std::string operatorId; ///< Empty for the source file
+    ::std::string mutatorId;  ///< Empty for the source file, or the operator
+
+    bool operator< ( const TimeScope &other ) const;
+};
+
+/// @brief    Per phase timings and counters, per source file, operator and
+///           mutator
+/// @details  Shared by the source files analyzed concurrently and by the
+///           validation workers, the updates are serialized. The users hold a
+///           nullptr when the report is disabled, so that nothing is measured
+///           nor locked.
+///           The operator and source file totals are rolled up from the
+///           mutators when written: a file row adds its own phases (e.g.
+///           parse) to the ones of its mutators.
+class TimeReport
+{
+public:
+    using Clock = ::std::chrono::steady_clock;
+
+    /// @brief Scoped timer, measuring nothing when the report is nullptr
+    class Timer
+    {
+    public:
+        Timer ( TimeReport *report, const TimeScope &scope, TimePhase phase )
+            : report ( report ), scope ( &scope ), phase ( phase ) {
+            if ( report != nullptr ) {
+                this->start = Clock::now();
+            }
+        }
+        ~Timer() {
+            if ( this->report != nullptr ) {
+                this->report->addTime ( *this->scope, this->phase,
+                                        this->start, Clock::now() );
+            }
+        }
+        Timer ( const Timer & ) = delete;
+        Timer &operator= ( const Timer & ) = delete;
+
+    private:
+        TimeReport *report;
+        const TimeScope *scope;
+        TimePhase phase;
+        Clock::time_point start;
+    };
+
+    void addTime ( const TimeScope &scope, TimePhase phase,
+                   Clock::time_point start, Clock::time_point end );
+    void addCount ( const TimeScope &scope, TimeCounter counter,
+                    ::std::uint64_t value = 1 );
+    /// @brief Add the latency of a check, also to the Check phase
+    void addCheck ( const TimeScope &scope, double seconds );
+
+    /// @brief Write the report as a JSON document
+    /// @details {"entries": [{"file", "operator", "mutator", "times",
+    ///          "counters", "checks": {"count", "total", "p50", "p99"}}]},
+    ///          times in seconds.
+    void writeJSON ( ::std::ostream &stream ) const;
+    /// @brief Write the report as a table, a row per entry
+    void writeTable ( ::llvm::raw_ostream &stream ) const;
+
+private:
+    struct Entry {
+        double times[static_cast<int> ( TimePhase::Count_ )] = {};
+        ::std::uint64_t counters[static_cast<int> ( TimeCounter::Count_ )] = {};
+        ::std::vector<double> checks; ///< Latencies, in seconds
+    };
+
+    /// @brief The entries, with the operator and file totals
+    ::std::map<TimeScope, Entry> rollUp() const;
+
+    ::std::map<TimeScope, Entry> entries;
+    mutable ::std::mutex entriesMutex;
+};
+} // End chimera namespace
+
+#endif /* INCLUDE_TIME_REPORT_H_ */
@@ -28,13 +28,85 @@
 
 #define ELPP_NO_DEFAULT_LOG_FILE            ///< Disable default logs folder.
 #define ELPP_DISABLE_DEFAULT_CRASH_HANDLING ///< Disable crash handling
+#define ELPP_THREAD_SAFE                    ///< Mutants are checked by workers
 #include "lib/easylogging++.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief Log a verbose message in the actual level, the message is built
+/// only if the level is enabled
+#define CHIMERA_VERBOSE(...)                                                   \
+  do {                                                                         \
+    if (::chimera::log::ChimeraLogger::isVerboseOn())                          \
+      ::chimera::log::ChimeraLogger::verbose(__VA_ARGS__);                     \
+  } while (0)
+
+/// @brief As CHIMERA_VERBOSE, then increment the actual level
+#define CHIMERA_VERBOSE_AND_INCR(...)                                          \
+  do {                                                                         \
+    CHIMERA_VERBOSE(__VA_ARGS__);                                              \
+    ::chimera::log::ChimeraLogger::incrActualVLevel();                         \
+  } while (0)
+
+/// @brief Decrement the actual level, then as CHIMERA_VERBOSE
+#define CHIMERA_VERBOSE_PRE_DECR(...)                                          \
+  do {                                                                         \
+    ::chimera::log::ChimeraLogger::decrActualVLevel();                         \
+    CHIMERA_VERBOSE(__VA_ARGS__);                                              \
+  } while (0)
+
 namespace chimera {
 namespace log {
   // FIXME Delete this intermediate class?
 // Typedefs
 using VerboseLevel = el::base::type::VerboseLevel;
+
+/// @brief Asynchronous sink of the verbose messages
+/// @details The messages are queued in a bounded ring buffer and written by
+///          a dedicated thread, so that the callers don't wait on the
+///          standard output. A full buffer blocks the callers, no message is
+///          dropped.
+class AsyncLogSink {
+public:
+  explicit AsyncLogSink(::std::size_t capacity = 4096);
+  /// @brief Dtor, the queued messages are written before returning
+  ~AsyncLogSink();
+
+  /// @brief Start the writer thread, idempotent
+  void start();
+  bool isStarted() const { return this->started; }
+  /// @brief Queue a message, formatted as any verbose message
+  void push(VerboseLevel vlevel, ::std::string &&msg);
+  /// @brief Wait until the queued messages have been written
+  void flush();
+
+private:
+  struct Entry {
+    VerboseLevel vlevel;
+    ::std::string msg;
+  };
+
+  /// @brief Body of the writer thread
+  void write();
+  void stop();
+
+  ::std::vector<Entry> ring;
+  ::std::size_t head;  ///< Oldest queued message
+  ::std::size_t count; ///< Queued messages
+  bool writing;        ///< If the writer holds a message out of the ring
+  bool stopping;
+  bool started;
+  ::std::mutex ringMutex;
+  ::std::condition_variable notEmpty; ///< Signaled to the writer
+  ::std::condition_variable notFull;  ///< Signaled to the callers
+  ::std::thread writer;
+};
+
 /// @brief ChimeraLogger Class, provides all functions for the logging
 /// @details Through this helper class, it's simpler to use easylogging++.
 class ChimeraLogger {
@@ -53,12 +125,33 @@ public:
 
   static void setVerboseLevel(VerboseLevel vlevel) {
     el::Loggers::setVerboseLevel(vlevel);
+    maxVLevel = vlevel;
+  }
+
+  /// @brief If a verbose message of the given level would be logged, it
+  /// doesn't lock, to be checked before building the message
+  static bool isVerboseOn(VerboseLevel vlevel) {
+    return verboseEnabled.load(::std::memory_order_relaxed) &&
+           vlevel <= maxVLevel.load(::std::memory_order_relaxed);
+  }
+  static bool isVerboseOn() { return isVerboseOn(actualVLevel); }
+
+  /// @brief Wait until the queued verbose messages have been written
+  static void flush() {
+    if (sink.isStarted()) {
+      sink.flush();
+    }
   }
 
   static void setActualVLevel(VerboseLevel vlevel) {
     actualVLevel = vlevel >= 0 && vlevel <= 9 ? vlevel : 0;
   }
   static void resetActualVLevel() { actualVLevel = 0; }
+
+  /// @brief Set a prefix for the messages logged by the calling thread, it
+  /// keeps apart the logs of targets analyzed concurrently
+  static void setContext(const std::string &ctx) { context = ctx; }
+  static void resetContext() { context.clear(); }
   static void incrActualVLevel() {
     actualVLevel = actualVLevel < 9 ? actualVLevel + 1 : 9;
   }
@@ -108,38 +201,72 @@ public:
     verbose(msg);
   }
 
-  static void debug(const std::string &msg) { CLOG(DEBUG, loggerName) << msg; }
+  static void debug(const std::string &msg) {
+    CLOG(DEBUG, loggerName) << context << msg;
+  }
 
-  static void debug(const std::string &&msg) { CLOG(DEBUG, loggerName) << msg; }
+  static void debug(const std::string &&msg) {
+    CLOG(DEBUG, loggerName) << context << msg;
+  }
 
-  static void info(const std::string &msg) { CLOG(INFO, loggerName) << msg; }
+  static void info(const std::string &msg) {
+    flush(); // After the verbose messages logged before
+    CLOG(INFO, loggerName) << context << msg;
+  }
 
-  static void info(const std::string &&msg) { CLOG(INFO, loggerName) << msg; }
+  static void info(const std::string &&msg) {
+    flush(); // After the verbose messages logged before
+    CLOG(INFO, loggerName) << context << msg;
+  }
 
-  static void trace(const std::string &msg) { CLOG(TRACE, loggerName) << msg; }
+  static void trace(const std::string &msg) {
+    CLOG(TRACE, loggerName) << context << msg;
+  }
 
-  static void trace(const std::string &&msg) { CLOG(TRACE, loggerName) << msg; }
+  static void trace(const std::string &&msg) {
+    CLOG(TRACE, loggerName) << context << msg;
+  }
 
   static void warning(const std::string &msg) {
-    CLOG(WARNING, loggerName) << msg;
+    flush(); // After the verbose messages logged before
+    CLOG(WARNING, loggerName) << context << msg;
   }
 
   static void warning(const std::string &&msg) {
-    CLOG(WARNING, loggerName) << msg;
+    flush(); // After the verbose messages logged before
+    CLOG(WARNING, loggerName) << context << msg;
   }
 
-  static void error(const std::string &msg) { CLOG(ERROR, loggerName) << msg; }
+  static void error(const std::string &msg) {
+    flush(); // After the verbose messages logged before
+    CLOG(ERROR, loggerName) << context << msg;
+  }
 
-  static void error(const std::string &&msg) { CLOG(ERROR, loggerName) << msg; }
+  static void error(const std::string &&msg) {
+    flush(); // After the verbose messages logged before
+    CLOG(ERROR, loggerName) << context << msg;
+  }
 
-  static void fatal(const std::string &msg) { CLOG(FATAL, loggerName) << msg; }
+  static void fatal(const std::string &msg) {
+    flush(); // After the verbose messages logged before
+    CLOG(FATAL, loggerName) << context << msg;
+  }
 
-  static void fatal(const std::string &&msg) { CLOG(FATAL, loggerName) << msg; }
+  static void fatal(const std::string &&msg) {
+    flush(); // After the verbose messages logged before
+    CLOG(FATAL, loggerName) << context << msg;
+  }
 
 private:
+  friend class AsyncLogSink;
+
   static const char *loggerName;
   static el::Configurations configurator;
-  static VerboseLevel actualVLevel;
+  static thread_local VerboseLevel actualVLevel; ///< Per thread indentation
+  static thread_local std::string context;       ///< Per thread prefix
+  static ::std::atomic<bool> verboseEnabled;
+  static ::std::atomic<VerboseLevel> maxVLevel;
+  static AsyncLogSink sink; ///< Writer of the verbose messages
 };
 }
 }
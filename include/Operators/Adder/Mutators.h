@@ -71,6 +71,7 @@ public:
                     true
                   ), reportName(reportName) {}
     virtual clang::ast_matchers::StatementMatcher getStatementMatcher() override; // Need to override this method, first part of matching rules
+    virtual ::chimera::mutator::MatchBackend getMatchBackend() const override; // Matched by the binary operator visitor
     virtual bool match ( const ::chimera::mutator::NodeType &node ) override; // Also this one, second part of matching rules
     virtual bool getMatchedNode ( const chimera::mutator::NodeType &,
                                   clang::ast_type_traits::DynTypedNode & ) override; // This is pure virtual and must be implemented
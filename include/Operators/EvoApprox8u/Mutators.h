@@ -76,6 +76,10 @@ class MutatorEvoApprox8u : public chimera::mutator::Mutator {
 
   virtual clang::ast_matchers::StatementMatcher getStatementMatcher()
       override;  // Need to override this method, first part of matching rules
+  virtual ::std::string getMatcherKey()
+      const override;  // Shared with the other integer operation mutators
+  virtual ::chimera::mutator::MatchBackend getMatchBackend()
+      const override;  // Matched by the binary operator visitor
 
   virtual bool match(const ::chimera::mutator::NodeType &node)
       override;  // Also this one, second part of matching rules
@@ -53,12 +53,14 @@ public:
                     2 // Two mutation types
                   ) {}
     virtual clang::ast_matchers::StatementMatcher getStatementMatcher() override; // Need to override this method, first part of matching rules
+    virtual ::chimera::mutator::MatchBackend getMatchBackend() const override; // Matched by the binary operator visitor
+    virtual ::chimera::mutator::ValidationPolicy getValidationPolicy() const override; // Swapping the operator is always valid
     virtual bool match ( const ::chimera::mutator::NodeType &node ) override; // Also this one, second part of matching rules
     virtual bool getMatchedNode ( const chimera::mutator::NodeType &,
                                   clang::ast_type_traits::DynTypedNode & ) override; // This is pure virtual and must be implemented
-    virtual clang::Rewriter &mutate ( const chimera::mutator::NodeType &node,
-                                      mutator::MutatorType type,
-                                      clang::Rewriter &rw ) override; // mutation rules
+    virtual bool produceEdits ( const chimera::mutator::NodeType &node,
+                                mutator::MutatorType type,
+                                mutant::EditScript &edits ) override; // mutation rules, as edits
 };
 
 /// \}
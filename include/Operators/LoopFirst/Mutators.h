@@ -23,8 +23,8 @@
 ///// \brief This file contains loop perforation mutators
 //===----------------------------------------------------------------------===//
 
-#ifndef INCLUDE_OPERATORS_PERFORATION_MUTATORS_H
-#define INCLUDE_OPERATORS_PERFORATION_MUTATORS_H
+#ifndef INCLUDE_OPERATORS_LOOPFIRST_MUTATORS_H
+#define INCLUDE_OPERATORS_LOOPFIRST_MUTATORS_H
 
 #include "Core/Mutator.h"
 
@@ -61,7 +61,7 @@ class MutatorLoopPerforation1 : public chimera::mutator::Mutator
                     "mutator_loop_perforation_operator", // String identifier
                     "loop perforation", // Description
                     1,
-                    true),inc(nullptr),binc(nullptr),cond(nullptr),bas(nullptr),opId(0) { }
+                    true),cond(nullptr),inc(nullptr),binc(nullptr),bas(nullptr),init(nullptr),opId(0) { }
     virtual clang::ast_matchers::StatementMatcher getStatementMatcher() override; // Need to override this method, first part of matching rules
     virtual bool match ( const ::chimera::mutator::NodeType &node ) override; // Also this one, second part of matching rules
     virtual bool getMatchedNode ( const chimera::mutator::NodeType &,
@@ -69,6 +69,7 @@ class MutatorLoopPerforation1 : public chimera::mutator::Mutator
     virtual clang::Rewriter &mutate ( const chimera::mutator::NodeType &node,
                                       mutator::MutatorType type,
                                       clang::Rewriter &rw ) override; // mutation rulesi
+    virtual ::chimera::mutator::ValidationPolicy getValidationPolicy() const override; // The stride rewrite is safe by construction
 
     virtual void onCreatedMutant(const ::std::string &mutantPath) override;
   private: 
@@ -87,4 +88,4 @@ class MutatorLoopPerforation1 : public chimera::mutator::Mutator
 } // end namespace chimera::perforation
 } // end namespace chimera
 
-#endif /* INCLUDE_OPERATORS_PERFORATION_MUTATORS_H */
+#endif /* INCLUDE_OPERATORS_LOOPFIRST_MUTATORS_H */
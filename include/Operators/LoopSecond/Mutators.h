@@ -23,8 +23,8 @@
 ///// \brief This file contains loop perforation mutators
 //===----------------------------------------------------------------------===//
 
-#ifndef INCLUDE_OPERATORS_PERFORATION_MUTATORS_H
-#define INCLUDE_OPERATORS_PERFORATION_MUTATORS_H
+#ifndef INCLUDE_OPERATORS_LOOPSECOND_MUTATORS_H
+#define INCLUDE_OPERATORS_LOOPSECOND_MUTATORS_H
 
 #include "Core/Mutator.h"
 
@@ -62,7 +62,7 @@ class MutatorLoopPerforation2 : public chimera::mutator::Mutator
                     "mutator_loop_perforation_operator", // String identifier
                     "loop perforation", // Description
                     1,
-                    true),cond(nullptr),init(nullptr),opId(0) { }
+                    true),cond(nullptr),init(nullptr),opId(0),inc(nullptr),binc(nullptr),bas(nullptr) { }
     virtual clang::ast_matchers::StatementMatcher getStatementMatcher() override; // Need to override this method, first part of matching rules
     virtual bool match ( const ::chimera::mutator::NodeType &node ) override; // Also this one, second part of matching rules
     virtual bool getMatchedNode ( const chimera::mutator::NodeType &,
@@ -70,6 +70,7 @@ class MutatorLoopPerforation2 : public chimera::mutator::Mutator
     virtual clang::Rewriter &mutate ( const chimera::mutator::NodeType &node,
                                       mutator::MutatorType type,
                                       clang::Rewriter &rw ) override; // mutation rulesi
+    virtual ::chimera::mutator::ValidationPolicy getValidationPolicy() const override; // The stride rewrite is safe by construction
 
     virtual void onCreatedMutant(const ::std::string &mutantPath) override;
   private: 
@@ -80,9 +81,10 @@ class MutatorLoopPerforation2 : public chimera::mutator::Mutator
     const ::clang::BinaryOperator *binc; // < Retrive ForStmt increment in case of binary increment
     const ::clang::BinaryOperator *bas; // < Retrive ForStmt increment in case of binary increment
   ::std::vector<MutationInfo> mutationsInfo;  ///< It maintains info about mutations, in order to be saved
+    void clean ();
 };
 
 } // end namespace chimera::perforation
 } // end namespace chimera
 
-#endif /* INCLUDE_OPERATORS_PERFORATION_MUTATORS_H */
+#endif /* INCLUDE_OPERATORS_LOOPSECOND_MUTATORS_H */
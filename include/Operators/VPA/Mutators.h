@@ -60,6 +60,9 @@ namespace chimera
       /// @return
       virtual ::clang::ast_matchers::StatementMatcher getStatementMatcher()
           override;
+      virtual ::std::string getMatcherKey() const override;
+      virtual ::chimera::mutator::MatchBackend getMatchBackend()
+          const override;
       virtual bool match(const ::chimera::mutator::NodeType& node) override;
       virtual bool getMatchedNode(const ::chimera::mutator::NodeType&,
                                   clang::ast_type_traits::DynTypedNode&) override;
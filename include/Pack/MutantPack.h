@@ -0,0 +1,202 @@
+//===- MutantPack.h ---------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantPack.h
+/// \brief This file contains the pack format of the mutants: a single file
+///        per target with an index and the payloads of the mutants
+/// \details The library doesn't depend on LLVM/Clang, so that the evaluation
+///          tools can link it alone.
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_PACK_MUTANT_PACK_H_
+#define INCLUDE_PACK_MUTANT_PACK_H_
+
+#include "Core/Mutant.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace chimera
+{
+namespace pack
+{
+
+/// @brief    Layout of a pack file
+/// @details  All the integers are stored in the byte order of the writer,
+///           the reader checks it through PackHeader::byteOrder.
+///           [PackHeader][payloads ...][BlobEntry ...][MutantEntry ...]
+///           The payloads (the target filename, the blob names and contents)
+///           are written as the mutants come. The tables, 8 bytes aligned,
+///           are written on close: the blobs of a mutant are contiguous and
+///           the mutants are sorted by id, so a lookup is a binary search.
+/// @{
+struct PackHeader {
+    char magic[8];               ///< "CHIMPACK"
+    ::std::uint32_t version;     ///< Format version
+    ::std::uint32_t byteOrder;   ///< packByteOrder as written
+    ::std::uint64_t targetNameOffset;
+    ::std::uint32_t targetNameSize;
+    ::std::uint32_t mutantsNumber;
+    ::std::uint64_t mutantsOffset; ///< Offset of the MutantEntry table
+    ::std::uint64_t blobsOffset;   ///< Offset of the BlobEntry table
+    ::std::uint32_t blobsNumber;
+    ::std::uint32_t reserved;
+};
+
+struct MutantEntry {
+    ::std::uint32_t id;        ///< The mutant::IdType of the mutant
+    ::std::uint32_t firstBlob; ///< Index of its first BlobEntry
+    ::std::uint32_t blobsNumber;
+    ::std::uint32_t reserved;
+};
+
+struct BlobEntry {
+    ::std::uint64_t nameOffset;
+    ::std::uint64_t dataOffset;
+    ::std::uint64_t dataSize;
+    ::std::uint32_t nameSize;
+    ::std::uint32_t reserved;
+};
+
+const char packMagic[8] = {'C', 'H', 'I', 'M', 'P', 'A', 'C', 'K'};
+const ::std::uint32_t packVersion = 1;
+const ::std::uint32_t packByteOrder = 0x01020304;
+/// @}
+
+/// @brief A payload of a mutant, pointing into the mapped pack
+struct Blob {
+    const char *name;
+    ::std::size_t nameSize;
+    const char *data;
+    ::std::size_t size;
+
+    ::std::string getName() const {
+        return ::std::string ( this->name, this->nameSize );
+    }
+    ::std::string getData() const {
+        return ::std::string ( this->data, this->size );
+    }
+};
+
+/// @brief    Writer of the pack of a target
+/// @details  The source of a mutant is stored as a blob named as the target,
+///           the other blobs are its artifacts (e.g. the mutator reports).
+class PackWriter
+{
+public:
+    /// @brief Ctor, open the file
+    /// @param path The path of the pack
+    /// @param targetFilename The name of the target
+    PackWriter ( const ::std::string &path,
+                 const ::std::string &targetFilename );
+    /// @brief Dtor, close the pack if still open
+    ~PackWriter();
+
+    bool isOpen() const {
+        return this->stream.is_open();
+    }
+
+    /// @brief Append a blob to a mutant
+    /// @return If the blob has been written, false if the mutant already has
+    ///         a blob with the same name
+    bool add ( mutant::IdType id, const ::std::string &name, const char *data,
+               ::std::size_t size );
+    bool add ( mutant::IdType id, const ::std::string &name,
+               const ::std::string &data ) {
+        return this->add ( id, name, data.data(), data.size() );
+    }
+
+    /// @brief Write the tables and the header, then close the file
+    /// @return If the pack is complete
+    bool close();
+
+private:
+    /// @brief Write raw bytes, return their offset
+    ::std::uint64_t write ( const char *data, ::std::size_t size );
+
+    ::std::ofstream stream;
+    PackHeader header;
+    ::std::map<mutant::IdType, ::std::vector<BlobEntry>> blobs;
+    ::std::set<::std::pair<mutant::IdType, ::std::string>>
+    names; ///< Of the added blobs, the readers would see the first copy only
+};
+
+/// @brief    Reader of a pack, mapped in memory
+/// @details  The blobs point straight into the mapping, nothing is copied.
+///           They are valid until the reader is closed.
+class PackReader
+{
+public:
+    PackReader();
+    ~PackReader();
+    PackReader ( const PackReader & ) = delete;
+    PackReader &operator= ( const PackReader & ) = delete;
+
+    /// @brief Map a pack and check its tables
+    /// @return false if the file is not a valid pack
+    bool open ( const ::std::string &path );
+    void close();
+
+    ::std::string getTargetFilename() const;
+
+    /// @defgroup
+    /// @brief Iteration over the mutants, sorted by id
+    /// @{
+    ::std::size_t getMutantsNumber() const {
+        return this->header ? this->header->mutantsNumber : 0;
+    }
+    mutant::IdType getMutantId ( ::std::size_t i ) const {
+        return this->mutants[i].id;
+    }
+    /// @}
+
+    bool hasMutant ( mutant::IdType id ) const {
+        return this->find ( id ) != nullptr;
+    }
+    /// @brief Return all the blobs of a mutant
+    ::std::vector<Blob> getBlobs ( mutant::IdType id ) const;
+    /// @brief Retrieve a blob of a mutant by name
+    /// @return false if there is no such blob
+    bool getBlob ( mutant::IdType id, const ::std::string &name,
+                   Blob &blob ) const;
+    /// @brief Retrieve the source of a mutant
+    bool getSource ( mutant::IdType id, Blob &blob ) const {
+        return this->getBlob ( id, this->getTargetFilename(), blob );
+    }
+
+private:
+    const MutantEntry *find ( mutant::IdType id ) const;
+    Blob makeBlob ( const BlobEntry &entry ) const;
+
+    const char *base;   ///< Start of the mapping
+    ::std::size_t size; ///< Size of the mapping
+    const PackHeader *header;
+    const MutantEntry *mutants;
+    const BlobEntry *blobs;
+};
+} // End chimera::pack namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_PACK_MUTANT_PACK_H_ */
@@ -87,6 +87,10 @@ template <class MutatorClass> void testMutatorMatch()
     testMutatorMatch ( &mutator );
 }
 
+/// @brief Create a new empty directory for the files of a test case
+/// @return Its path (with trailing pathSep)
+::std::string createTemporaryDirectory();
+
 /// @brief Run all tests
 /// @param argc Like main's argc
 /// @param argv Like main's argv, to configure gtest
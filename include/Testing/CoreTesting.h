@@ -0,0 +1,968 @@
+//===- CoreTesting.h --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file CoreTesting.h
+/// \brief This file contains the unit tests of the core components, which
+///        don't need any test file
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TESTING_CORE_TESTING_H_
+#define INCLUDE_TESTING_CORE_TESTING_H_
+
+#include "Testing/ChimeraTest.h"
+
+#include "Core/DeferredMutant.h"
+#include "Core/FunctionSelector.h"
+#include "Core/MutantCombiner.h"
+#include "Core/MutantDelta.h"
+#include "Core/MutantIdList.h"
+#include "Core/MutantSampler.h"
+#include "Core/MutantSchemata.h"
+#include "Core/MutantShard.h"
+#include "Core/MutationJournal.h"
+#include "Utils.h"
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// \addtogroup CORE_TESTING Test cases for the core components
+/// \{
+TEST ( mutant_delta, compute_edits_distant_changes )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "int a;\nint b;\nint c;\nint d;\n";
+    const ::std::string code = "#include <x.h>\nint a;\nint b;\nint c;\n"
+                               "long d;\n";
+    EditScript edits = computeEdits ( original, code );
+    ASSERT_EQ ( 2u, edits.size() );
+    // The unchanged lines between the changes are not stored
+    EXPECT_EQ ( 0u, edits[0].offset );
+    EXPECT_EQ ( 0u, edits[0].length );
+    EXPECT_EQ ( "#include <x.h>\n", edits[0].replacement );
+    EXPECT_EQ ( original.find ( "int d" ), edits[1].offset );
+    EXPECT_EQ ( 3u, edits[1].length );
+    EXPECT_EQ ( "long", edits[1].replacement );
+    EXPECT_EQ ( code, applyEdits ( original, edits ) );
+}
+
+TEST ( mutant_delta, compute_edits_round_trip )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "a\nb\nc\nd\ne";
+    const ::std::vector<::std::string> codes = {
+        original, "", "a\nc\nd\ne", "x\na\nb\nc\nd\ne\n", "a\nb\nX\nd\nf",
+        "e\nd\nc\nb\na"
+    };
+    for ( const ::std::string &code : codes ) {
+        EditScript edits = computeEdits ( original, code );
+        EXPECT_EQ ( code, applyEdits ( original, edits ) );
+        for ( ::std::size_t i = 1; i < edits.size(); ++i ) {
+            EXPECT_LE ( edits[i - 1].offset + edits[i - 1].length,
+                        edits[i].offset );
+        }
+    }
+    EXPECT_TRUE ( computeEdits ( original, original ).empty() );
+}
+
+TEST ( mutant_delta, writer_reader_round_trip )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "target.delta";
+    // Binary safe: the contents may hold NULs
+    const ::std::string original =
+        ::std::string ( "int f() {\n  return a + b;\n}\n" ) + '\0';
+    const ::std::string first = "int f() {\n  return a - b;\n}\n";
+    EditScript second = { { 0, 0, "#include <x.h>\n" } };
+    {
+        MutantDeltaWriter writer ( path, "target.cpp", original );
+        ASSERT_TRUE ( writer.isOpen() );
+        EXPECT_TRUE ( writer.add ( 7, first ) );
+        EXPECT_TRUE ( writer.add ( 3, second ) );
+        EXPECT_TRUE ( writer.close() );
+    }
+    MutantDeltaReader reader;
+    ASSERT_TRUE ( reader.open ( path ) );
+    EXPECT_EQ ( "target.cpp", reader.getFilename() );
+    EXPECT_EQ ( original, reader.getOriginal() );
+    EXPECT_EQ ( ::std::vector<IdType> ( { 3, 7 } ), reader.getMutantIds() );
+    EXPECT_FALSE ( reader.hasMutant ( 5 ) );
+    ::std::string code;
+    ASSERT_TRUE ( reader.materialize ( 7, code ) );
+    EXPECT_EQ ( first, code );
+    ASSERT_TRUE ( reader.materialize ( 3, code ) );
+    EXPECT_EQ ( applyEdits ( original, second ), code );
+    EditScript edits;
+    ASSERT_TRUE ( reader.getEdits ( 3, edits ) );
+    ASSERT_EQ ( 1u, edits.size() );
+    EXPECT_EQ ( second[0].replacement, edits[0].replacement );
+    EXPECT_FALSE ( reader.materialize ( 5, code ) );
+}
+
+TEST ( mutant_delta, writer_rejects_repeated_id )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "target.delta";
+    {
+        MutantDeltaWriter writer ( path, "target.cpp", "int a;\n" );
+        ASSERT_TRUE ( writer.add ( 1, ::std::string ( "long a;\n" ) ) );
+        // A mutant is saved once: a second record would be a dead one
+        EXPECT_FALSE ( writer.add ( 1, ::std::string ( "short a;\n" ) ) );
+        EXPECT_FALSE ( writer.add ( 1, EditScript() ) );
+        EXPECT_TRUE ( writer.add ( 2, ::std::string ( "char a;\n" ) ) );
+        EXPECT_TRUE ( writer.close() );
+    }
+    ::std::string content;
+    {
+        ::std::ifstream in ( path, ::std::ios::binary );
+        content.assign ( ::std::istreambuf_iterator<char> ( in ),
+                         ::std::istreambuf_iterator<char>() );
+    }
+    EXPECT_EQ ( ::std::string::npos, content.find ( "short" ) );
+    MutantDeltaReader reader;
+    ASSERT_TRUE ( reader.open ( path ) );
+    EXPECT_EQ ( ::std::vector<IdType> ( { 1, 2 } ), reader.getMutantIds() );
+    ::std::string code;
+    ASSERT_TRUE ( reader.materialize ( 1, code ) );
+    EXPECT_EQ ( "long a;\n", code );
+    ASSERT_TRUE ( reader.materialize ( 2, code ) );
+    EXPECT_EQ ( "char a;\n", code );
+}
+
+TEST ( mutant_delta, reader_rejects_truncated_file )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "target.delta";
+    {
+        MutantDeltaWriter writer ( path, "target.cpp", "int a;\n" );
+        ASSERT_TRUE ( writer.add ( 1, ::std::string ( "long a;\n" ) ) );
+        ASSERT_TRUE ( writer.close() );
+    }
+    MutantDeltaReader reader;
+    EXPECT_TRUE ( reader.open ( path ) );
+    ::std::string content;
+    {
+        ::std::ifstream in ( path, ::std::ios::binary );
+        content.assign ( ::std::istreambuf_iterator<char> ( in ),
+                         ::std::istreambuf_iterator<char>() );
+    }
+    {
+        ::std::ofstream out ( path, ::std::ios::binary | ::std::ios::trunc );
+        out << content.substr ( 0, content.size() / 2 );
+    }
+    MutantDeltaReader truncated;
+    EXPECT_FALSE ( truncated.open ( path ) );
+}
+
+TEST ( mutant_delta, normalize_edits )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "a + b;";
+    // Out of order, with a no-op edit and two insertions at the same offset
+    EditScript edits = { { 4, 1, "c" }, { 0, 0, "(" }, { 2, 0, "" },
+        { 0, 0, "(" }, { 2, 1, "-" }
+    };
+    ASSERT_TRUE ( normalizeEdits ( edits ) );
+    ASSERT_EQ ( 3u, edits.size() );
+    EXPECT_EQ ( "((", edits[0].replacement );
+    EXPECT_EQ ( "((a - c;", applyEdits ( original, edits ) );
+
+    EditScript overlapping = { { 0, 3, "x" }, { 2, 2, "y" } };
+    EXPECT_FALSE ( normalizeEdits ( overlapping ) );
+}
+
+TEST ( mutant_delta, compose_edits )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "a + b;";
+    const EditScript first = { { 0, 0, "#include <x.h>\n" }, { 2, 1, "-" } };
+    const EditScript second = { { 0, 0, "#include <y.h>\n" },
+        { 4, 1, "c" }
+    };
+    EditScript composed;
+    ASSERT_TRUE ( composeEdits ( first, second, composed ) );
+    // The insertions of first come before
+    EXPECT_EQ ( "#include <x.h>\n#include <y.h>\na - c;",
+                applyEdits ( original, composed ) );
+    // An insertion before a replacement at the same offset doesn't overlap
+    ASSERT_TRUE ( composeEdits ( { { 2, 0, "(" } }, { { 2, 1, "-" } },
+                                 composed ) );
+    EXPECT_EQ ( "a (- b;", applyEdits ( original, composed ) );
+}
+
+TEST ( mutant_delta, compose_edits_rejects_overlap )
+{
+    using namespace ::chimera::mutant;
+    EditScript composed = { { 0, 0, "stale" } };
+    EXPECT_FALSE ( composeEdits ( { { 0, 3, "x" } }, { { 2, 1, "-" } },
+                                  composed ) );
+    EXPECT_TRUE ( composed.empty() );
+    // The same mutated range
+    EXPECT_FALSE ( composeEdits ( { { 2, 1, "-" } }, { { 2, 1, "*" } },
+                                  composed ) );
+}
+
+TEST ( deferred_mutant, bisect_selection )
+{
+    using namespace ::chimera::mutant;
+    unsigned checks = 0;
+    // Items 2 and 5 make any selection fail
+    auto check = [&checks] ( const ::std::vector<bool> &selection ) {
+        ++checks;
+        return !selection[2] && !selection[5];
+    };
+    ::std::vector<bool> selected = bisectSelection ( 8, check );
+    EXPECT_EQ ( ::std::vector<bool> ( { true, true, false, true, true, false,
+                                        true, true
+                                      } ), selected );
+
+    // A single offending item costs O(log N) checks
+    auto single = [&checks] ( const ::std::vector<bool> &selection ) {
+        ++checks;
+        return !selection[37];
+    };
+    checks = 0;
+    selected = bisectSelection ( 64, single );
+    EXPECT_FALSE ( selected[37] );
+    EXPECT_EQ ( 63, ::std::count ( selected.begin(), selected.end(), true ) );
+    EXPECT_LE ( checks, 1u + 2u * 6u );
+
+    checks = 0;
+    selected = bisectSelection ( 8, [&checks] ( const ::std::vector<bool> & ) {
+        ++checks;
+        return true;
+    } );
+    EXPECT_EQ ( ::std::vector<bool> ( 8, true ), selected );
+    EXPECT_EQ ( 1u, checks );
+    EXPECT_TRUE ( bisectSelection ( 0, check ).empty() );
+}
+
+TEST ( deferred_mutant, drops_only_the_offending_mutation )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "int a = x + y;\nint b = x + y;\n"
+                                   "int c = x + y;\n";
+    DeferredMutant mutant ( original );
+    // Each mutation is given as the whole content after it
+    ::std::string code = original;
+    code[10] = '-';
+    EXPECT_EQ ( 0u, mutant.addMutation ( code ) );
+    code[25] = '*';
+    EXPECT_EQ ( 1u, mutant.addMutation ( code ) );
+    code[40] = '/';
+    EXPECT_EQ ( 2u, mutant.addMutation ( code ) );
+    EXPECT_EQ ( 3u, mutant.getMutationsNumber() );
+    EXPECT_EQ ( 3u, mutant.getGroupsNumber() );
+
+    ::std::vector<bool> kept;
+    ::std::string valid = mutant.validate ( [] ( const ::std::string & c ) {
+        return c.find ( '*' ) == ::std::string::npos;
+    }, kept );
+    EXPECT_EQ ( ::std::vector<bool> ( { true, false, true } ), kept );
+    EXPECT_EQ ( "int a = x - y;\nint b = x + y;\nint c = x / y;\n", valid );
+}
+
+TEST ( deferred_mutant, groups_dependent_mutations )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "int a = x + y;\nint b = x + y;\n";
+    DeferredMutant mutant ( original );
+    // The second mutation rewrites the text of the first one
+    mutant.addMutation ( "int a = x - y;\nint b = x + y;\n" );
+    mutant.addMutation ( "int a = (x - y);\nint b = x + y;\n" );
+    mutant.addMutation ( "int a = (x - y);\nint b = x * y;\n" );
+    EXPECT_EQ ( 2u, mutant.getGroupsNumber() );
+
+    ::std::vector<bool> kept;
+    ::std::string valid = mutant.validate ( [] ( const ::std::string & c ) {
+        return c.find ( '(' ) == ::std::string::npos;
+    }, kept );
+    EXPECT_EQ ( ::std::vector<bool> ( { false, false, true } ), kept );
+    EXPECT_EQ ( "int a = x + y;\nint b = x * y;\n", valid );
+}
+
+TEST ( deferred_mutant, distant_edits_do_not_bind_mutations )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "int a = x + y;\nint b = x + y;\n"
+                                   "int c = x + y;\n";
+    DeferredMutant mutant ( original );
+    // A declaration on top and the mutated expression far below
+    mutant.addMutation ( "int t;\nint a = x + y;\nint b = x + y;\n"
+                         "int c = x - y;\n" );
+    mutant.addMutation ( "int t;\nint a = x + y;\nint b = x * y;\n"
+                         "int c = x - y;\n" );
+    EXPECT_EQ ( 2u, mutant.getGroupsNumber() );
+
+    unsigned checks = 0;
+    ::std::vector<bool> kept;
+    ::std::string valid =
+    mutant.validate ( [&checks] ( const ::std::string & c ) {
+        ++checks;
+        return c.find ( '*' ) == ::std::string::npos;
+    }, kept );
+    EXPECT_EQ ( ::std::vector<bool> ( { true, false } ), kept );
+    EXPECT_EQ ( "int t;\nint a = x + y;\nint b = x + y;\nint c = x - y;\n",
+                valid );
+    // The whole mutant is checked first
+    EXPECT_GE ( checks, 2u );
+}
+
+TEST ( mutant_schemata, add_mutant )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original =
+        "void f() {\n  x = a + b;\n  y = c + d;\n}\n";
+    const ::std::size_t first = original.find ( "a + b" );
+    const ::std::size_t second = original.find ( "c + d" );
+    MutantSchemata schemata ( original, "target.c" );
+    EXPECT_TRUE ( schemata.empty() );
+    auto mutate = [&original] ( ::std::size_t at, const char *text ) {
+        ::std::string code = original;
+        return code.replace ( at, 5, text );
+    };
+    EXPECT_TRUE ( schemata.addMutant ( 1, mutate ( first, "a - b" ), first,
+                                       first + 5 ) );
+    // Same site: chained
+    EXPECT_TRUE ( schemata.addMutant ( 2, mutate ( first, "a * b" ), first,
+                                       first + 5 ) );
+    EXPECT_TRUE ( schemata.addMutant ( 3, mutate ( second, "c - d" ), second,
+                                       second + 5 ) );
+    EXPECT_FALSE ( schemata.empty() );
+    // Changes outside the site
+    EXPECT_FALSE ( schemata.addMutant ( 4, mutate ( first, "a - b" ), second,
+                                        second + 5 ) );
+    // Overlapping sites
+    EXPECT_FALSE ( schemata.addMutant ( 5, mutate ( first, "a + e" ),
+                                        first + 4, first + 6 ) );
+    // Nothing to guard
+    EXPECT_FALSE ( schemata.addMutant ( 6, original, first, first + 5 ) );
+
+    EXPECT_EQ ( mutate ( first, "a * b" ), schemata.getMutantCode ( 2 ) );
+    EXPECT_EQ ( mutate ( second, "c - d" ), schemata.getMutantCode ( 3 ) );
+    EXPECT_EQ ( original, schemata.getMutantCode ( 4 ) );
+}
+
+TEST ( mutant_schemata, build_drops_invalid_sites )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original =
+        "void f() {\n  x = a + b;\n  y = c + d;\n}\n";
+    const ::std::size_t first = original.find ( "a + b" );
+    const ::std::size_t second = original.find ( "c + d" );
+    MutantSchemata schemata ( original, "target.c" );
+    ::std::string code = original;
+    schemata.addMutant ( 7, code.replace ( first, 5, "a - b" ), first,
+                         first + 5 );
+    code = original;
+    schemata.addMutant ( 9, code.replace ( second, 5, "c / d" ), second,
+                         second + 5 );
+    code = original;
+    schemata.addMutant ( 8, code.replace ( first, 5, "a * b" ), first,
+                         first + 5 );
+
+    ::std::vector<IdType> selectors, dropped;
+    auto check = [] ( const ::std::string & c ) {
+        return c.find ( "c / d" ) == ::std::string::npos;
+    };
+    const ::std::string built = schemata.build ( check, selectors, dropped );
+    EXPECT_EQ ( ::std::vector<IdType> ( { 7, 8 } ), selectors );
+    EXPECT_EQ ( ::std::vector<IdType> ( { 9 } ), dropped );
+    // Selectors numbered from 1, the original line numbers are kept
+    EXPECT_NE ( ::std::string::npos, built.find (
+                    "\n#line 1 \"target.c\"\nvoid f() {\n  x = "
+                    "(chimera_mutant_id() == 1 ? (a - b) : "
+                    "chimera_mutant_id() == 2 ? (a * b) : (a + b));\n"
+                    "  y = c + d;\n}\n" ) );
+    EXPECT_NE ( ::std::string::npos, built.find ( "CHIMERA_MUTANT_ID" ) );
+}
+
+/// @brief Parents of the combinations, in order
+static ::std::vector<::std::vector<::chimera::mutant::IdType>>
+getParents ( const ::std::vector<::chimera::mutant::Combination> &combinations )
+{
+    ::std::vector<::std::vector<::chimera::mutant::IdType>> parents;
+    for ( const ::chimera::mutant::Combination &combination : combinations ) {
+        parents.push_back ( combination.parents );
+    }
+    return parents;
+}
+
+/// @brief A combiner of n FOM mutants, mutant i+1 replacing the i-th
+///        operator of "a0+a1+a2+..." with '-'
+static ::chimera::mutant::MutantCombiner
+makeCombiner ( unsigned n, unsigned maxOrder, ::std::size_t budget )
+{
+    ::chimera::mutant::MutantCombiner combiner ( maxOrder, budget );
+    for ( unsigned i = 0; i < n; ++i ) {
+        combiner.add ( i + 1, { { 3 * i + 2, 1, "-" } } );
+    }
+    return combiner;
+}
+
+TEST ( mutant_combiner, overlapping_mutants_are_not_combined )
+{
+    using namespace ::chimera::mutant;
+    const ::std::string original = "a + b + c;";
+    MutantCombiner combiner ( 3, 100 );
+    combiner.add ( 1, { { 2, 1, "-" } } );
+    // The same operator
+    combiner.add ( 2, { { 2, 1, "*" } } );
+    // A nested expression
+    combiner.add ( 3, { { 0, 5, "x" } } );
+    combiner.add ( 4, { { 6, 1, "-" } } );
+    // Not a mutation
+    combiner.add ( 5, {} );
+    EXPECT_EQ ( 4u, combiner.size() );
+    const ::std::vector<Combination> combinations = combiner.combine();
+    EXPECT_EQ ( ::std::vector<::std::vector<IdType>> ( {
+        { 1, 4 }, { 2, 4 }, { 3, 4 }
+    } ), getParents ( combinations ) );
+    EXPECT_EQ ( "a - b - c;", applyEdits ( original, combinations[0].edits ) );
+    EXPECT_EQ ( "a * b - c;", applyEdits ( original, combinations[1].edits ) );
+    EXPECT_EQ ( "x - c;", applyEdits ( original, combinations[2].edits ) );
+}
+
+TEST ( mutant_combiner, enumerates_within_the_budget )
+{
+    using namespace ::chimera::mutant;
+    // Lower orders first, each one in lexicographic order
+    EXPECT_EQ ( ::std::vector<::std::vector<IdType>> ( {
+        { 1, 2 }, { 1, 3 }, { 2, 3 }, { 1, 2, 3 }
+    } ), getParents ( makeCombiner ( 3, 3, 4 ).combine() ) );
+    // Not beyond the mutants
+    EXPECT_EQ ( 4u, makeCombiner ( 3, 5, 100 ).combine().size() );
+    // Below order 2 nothing is combined
+    EXPECT_TRUE ( makeCombiner ( 3, 1, 100 ).combine().empty() );
+    EXPECT_TRUE ( makeCombiner ( 1, 3, 100 ).combine().empty() );
+    EXPECT_TRUE ( makeCombiner ( 3, 3, 0 ).combine().empty() );
+}
+
+TEST ( mutant_combiner, budget_carries_over_to_the_sampled_orders )
+{
+    using namespace ::chimera::mutant;
+    // The 15 pairs fit the budget, the 5 left are drawn among the 20 triples
+    const ::std::vector<::std::vector<IdType>> parents =
+        getParents ( makeCombiner ( 6, 3, 20 ).combine() );
+    ASSERT_EQ ( 20u, parents.size() );
+    for ( unsigned i = 0; i < parents.size(); ++i ) {
+        EXPECT_EQ ( i < 15 ? 2u : 3u, parents[i].size() );
+        EXPECT_TRUE ( ::std::is_sorted ( parents[i].begin(),
+                                         parents[i].end() ) );
+    }
+    EXPECT_EQ ( parents[0], ::std::vector<IdType> ( { 1, 2 } ) );
+    EXPECT_EQ ( parents[14], ::std::vector<IdType> ( { 5, 6 } ) );
+    ::std::vector<::std::vector<IdType>> sorted = parents;
+    ::std::sort ( sorted.begin(), sorted.end() );
+    EXPECT_TRUE ( ::std::adjacent_find ( sorted.begin(), sorted.end() ) ==
+                  sorted.end() );
+    // A budget below the pairs samples them, the next orders are left out
+    const ::std::vector<Combination> sampled =
+        makeCombiner ( 6, 3, 4 ).combine();
+    ASSERT_EQ ( 4u, sampled.size() );
+    for ( const Combination &combination : sampled ) {
+        EXPECT_EQ ( 2u, combination.parents.size() );
+        EXPECT_EQ ( 2u, combination.edits.size() );
+    }
+}
+
+TEST ( mutant_combiner, sampling_skips_overlapping_mutants )
+{
+    using namespace ::chimera::mutant;
+    // Mutants 2i+1 and 2i+2 mutate the same operator
+    MutantCombiner combiner ( 2, 10 );
+    for ( unsigned i = 0; i < 8; ++i ) {
+        combiner.add ( i + 1, { { 3 * ( i / 2 ) + 2, 1, i % 2 ? "*" : "-" } } );
+    }
+    // 24 compatible pairs out of 28
+    const ::std::vector<Combination> combinations = combiner.combine();
+    EXPECT_EQ ( 10u, combinations.size() );
+    for ( const Combination &combination : combinations ) {
+        ASSERT_EQ ( 2u, combination.parents.size() );
+        EXPECT_NE ( ( combination.parents[0] + 1 ) / 2,
+                    ( combination.parents[1] + 1 ) / 2 );
+    }
+}
+
+TEST ( mutant_combiner, deterministic )
+{
+    using namespace ::chimera::mutant;
+    // Sampled from a fixed seed: the same among the analyses
+    const MutantCombiner combiner = makeCombiner ( 10, 4, 50 );
+    const ::std::vector<Combination> first = combiner.combine();
+    EXPECT_EQ ( 50u, first.size() );
+    EXPECT_EQ ( getParents ( first ), getParents ( combiner.combine() ) );
+    EXPECT_EQ ( getParents ( first ),
+                getParents ( makeCombiner ( 10, 4, 50 ).combine() ) );
+}
+
+TEST ( mutant_id_list, parse_and_select )
+{
+    using namespace ::chimera::mutant;
+    MutantIdList list;
+    ASSERT_TRUE ( MutantIdList::parse ( "1-3, 7,10 - 12", list ) );
+    EXPECT_TRUE ( list.contains ( 1 ) );
+    EXPECT_TRUE ( list.contains ( 3 ) );
+    EXPECT_FALSE ( list.contains ( 4 ) );
+    EXPECT_TRUE ( list.contains ( 7 ) );
+    EXPECT_TRUE ( list.contains ( 11 ) );
+    EXPECT_FALSE ( list.contains ( 13 ) );
+    // The order of the existing mutants is kept
+    EXPECT_EQ ( ::std::vector<IdType> ( { 11, 2, 7 } ),
+                list.select ( { 11, 5, 2, 7, 13 } ) );
+}
+
+TEST ( mutant_id_list, wide_range_is_not_expanded )
+{
+    using namespace ::chimera::mutant;
+    MutantIdList list;
+    ASSERT_TRUE ( MutantIdList::parse ( "1-4000000000", list ) );
+    EXPECT_TRUE ( list.contains ( 4000000000u ) );
+    EXPECT_FALSE ( list.contains ( 0 ) );
+    EXPECT_EQ ( ::std::vector<IdType> ( { 1, 3999999999u } ),
+                list.select ( { 0, 1, 3999999999u } ) );
+}
+
+TEST ( mutant_id_list, parse_rejects_malformed )
+{
+    using namespace ::chimera::mutant;
+    MutantIdList list;
+    EXPECT_FALSE ( MutantIdList::parse ( "a", list ) );
+    EXPECT_FALSE ( MutantIdList::parse ( "1,x-2", list ) );
+    EXPECT_FALSE ( MutantIdList::parse ( "5-3", list ) );
+    EXPECT_FALSE ( MutantIdList::parse ( "-3", list ) );
+    EXPECT_FALSE ( MutantIdList::parse ( "1-2-3", list ) );
+    // A new parse drops the previous ranges
+    ASSERT_TRUE ( MutantIdList::parse ( "2", list ) );
+    EXPECT_FALSE ( list.contains ( 1 ) );
+    EXPECT_TRUE ( list.contains ( 2 ) );
+}
+
+TEST ( glob_to_regex, translation )
+{
+    EXPECT_EQ ( "test_.*", ::chimera::globToRegex ( "test_*" ) );
+    EXPECT_EQ ( "a\\.b.", ::chimera::globToRegex ( "a.b?" ) );
+    EXPECT_EQ ( "[^a-c]x", ::chimera::globToRegex ( "[!a-c]x" ) );
+    EXPECT_EQ ( "[ab]\\(", ::chimera::globToRegex ( "[ab](" ) );
+    // An unterminated class is a plain [
+    EXPECT_EQ ( "\\[ab", ::chimera::globToRegex ( "[ab" ) );
+}
+
+/// @brief Fixture holding the AST of the functions to select
+class function_selector : public ::testing::Test
+{
+protected:
+    void SetUp() override {
+        this->ast = ::clang::tooling::buildASTFromCode (
+                        "namespace ns {\n"
+                        "int foo() { return 0; }\n"
+                        "namespace inner { int foo() { return 1; } }\n"
+                        "}\n"
+                        "int foo() { return 2; }\n"
+                        "int test() { return 3; }\n"
+                        "int test_a() { return 4; }\n"
+                        "int my_test_a() { return 5; }\n"
+                        "int get_x() { return 6; }\n"
+                        "int set_x() { return 7; }\n" );
+        ASSERT_TRUE ( this->ast != nullptr );
+    }
+
+    /// @brief If the definition of a function is selected for an operator
+    /// @param name The name of the function, as for hasName
+    bool isSelected ( const ::chimera::FunctionSelector &selector,
+                      const ::std::string &name,
+                      const ::std::string &operatorId ) {
+        using namespace ::clang::ast_matchers;
+        const ::clang::FunctionDecl *function =
+            selectFirst<::clang::FunctionDecl> (
+                "function", match ( functionDecl ( hasName ( name ),
+                                    isDefinition() ).bind ( "function" ),
+                                    this->ast->getASTContext() ) );
+        EXPECT_TRUE ( function != nullptr ) << name;
+        return function && selector.isSelected ( *function, operatorId );
+    }
+
+    ::std::unique_ptr<::clang::ASTUnit> ast;
+};
+
+TEST_F ( function_selector, names_and_patterns )
+{
+    const ::chimera::conf::FunOpConfMap map = {
+        { "test_*", { "op1" } }, { "re:(get|set)_x", { "op1" } },
+        { "foo", { "op2", "missing" } }
+    };
+    ::chimera::FunctionSelector selector ( map, { "op1", "op2", "op3" } );
+    // The operators not loaded are skipped
+    EXPECT_EQ ( ::std::vector<::std::string> ( { "op1", "op2" } ),
+                selector.getOperators() );
+    // Whole names
+    EXPECT_TRUE ( isSelected ( selector, "test_a", "op1" ) );
+    EXPECT_FALSE ( isSelected ( selector, "my_test_a", "op1" ) );
+    EXPECT_FALSE ( isSelected ( selector, "test", "op1" ) );
+    EXPECT_TRUE ( isSelected ( selector, "get_x", "op1" ) );
+    EXPECT_TRUE ( isSelected ( selector, "set_x", "op1" ) );
+    EXPECT_FALSE ( isSelected ( selector, "test_a", "op2" ) );
+    // An unqualified name selects the function in any namespace
+    EXPECT_TRUE ( isSelected ( selector, "::foo", "op2" ) );
+    EXPECT_TRUE ( isSelected ( selector, "ns::foo", "op2" ) );
+    EXPECT_FALSE ( isSelected ( selector, "::foo", "op3" ) );
+}
+
+TEST_F ( function_selector, qualified_names )
+{
+    const ::chimera::conf::FunOpConfMap map = {
+        { "inner::foo", { "op1" } }, { "::foo", { "op2" } },
+        { "ns::*", { "op3" } }
+    };
+    ::chimera::FunctionSelector selector ( map, { "op1", "op2", "op3" } );
+    // As hasName, a relative name may be nested
+    EXPECT_TRUE ( isSelected ( selector, "ns::inner::foo", "op1" ) );
+    EXPECT_FALSE ( isSelected ( selector, "ns::foo", "op1" ) );
+    // A fully qualified name is not
+    EXPECT_TRUE ( isSelected ( selector, "::foo", "op2" ) );
+    EXPECT_FALSE ( isSelected ( selector, "ns::foo", "op2" ) );
+    // A qualified glob matches the whole qualified name
+    EXPECT_TRUE ( isSelected ( selector, "ns::foo", "op3" ) );
+    EXPECT_TRUE ( isSelected ( selector, "ns::inner::foo", "op3" ) );
+    EXPECT_FALSE ( isSelected ( selector, "::foo", "op3" ) );
+}
+
+TEST_F ( function_selector, all_functions_and_operators )
+{
+    const ::chimera::conf::FunOpConfMap map = {
+        { "CHIMERA_ALL_FUNCTIONS", { "CHIMERA_ALL_OPERATORS" } },
+        { "foo", { "op1" } }
+    };
+    ::chimera::FunctionSelector selector ( map, { "op1", "op2" } );
+    EXPECT_EQ ( ::std::vector<::std::string> ( { "op1", "op2" } ),
+                selector.getOperators() );
+    EXPECT_TRUE ( isSelected ( selector, "test", "op1" ) );
+    EXPECT_TRUE ( isSelected ( selector, "ns::inner::foo", "op2" ) );
+    EXPECT_FALSE ( isSelected ( selector, "test", "op3" ) );
+}
+
+TEST ( mutant_shard, parse )
+{
+    using namespace ::chimera;
+    MutantShard shard;
+    EXPECT_FALSE ( shard.isSharded() );
+    ASSERT_TRUE ( MutantShard::parse ( "1/4", shard ) );
+    EXPECT_EQ ( 1u, shard.getIndex() );
+    EXPECT_EQ ( 4u, shard.getCount() );
+    EXPECT_TRUE ( shard.isSharded() );
+    EXPECT_EQ ( "1/4", shard.str() );
+    ASSERT_TRUE ( MutantShard::parse ( "0/1", shard ) );
+    EXPECT_FALSE ( shard.isSharded() );
+    EXPECT_FALSE ( MutantShard::parse ( "4/4", shard ) );
+    EXPECT_FALSE ( MutantShard::parse ( "0/0", shard ) );
+    EXPECT_FALSE ( MutantShard::parse ( "1", shard ) );
+    EXPECT_FALSE ( MutantShard::parse ( "a/2", shard ) );
+    EXPECT_FALSE ( MutantShard::parse ( "-1/2", shard ) );
+    EXPECT_FALSE ( MutantShard::parse ( "1/2/3", shard ) );
+    // A failed parse leaves the shard as it was
+    EXPECT_EQ ( "0/1", shard.str() );
+}
+
+TEST ( mutant_shard, owns_disjoint_keys )
+{
+    using namespace ::chimera;
+    // MD5, whatever the process and the machine
+    EXPECT_EQ ( 0xd41d8cd98f00b204ULL, MutantShard::hash ( "" ) );
+    EXPECT_EQ ( "t.cpp|f|3:7|m#1",
+                MutantShard::getKey ( "t.cpp", "f", 3, 7, "m#1" ) );
+    EXPECT_EQ ( "t.cpp|op", MutantShard::getHomKey ( "t.cpp", "op" ) );
+    ::std::vector<unsigned> owned ( 3, 0 );
+    for ( unsigned line = 1; line <= 300; ++line ) {
+        const ::std::string key =
+            MutantShard::getKey ( "t.cpp", "f", line, 1, "m#0" );
+        EXPECT_TRUE ( MutantShard().owns ( key ) );
+        unsigned owners = 0;
+        for ( unsigned i = 0; i < 3; ++i ) {
+            if ( MutantShard ( i, 3 ).owns ( key ) ) {
+                ++owners;
+                ++owned[i];
+            }
+        }
+        EXPECT_EQ ( 1u, owners ) << key;
+    }
+    // Roughly balanced
+    for ( unsigned i = 0; i < 3; ++i ) {
+        EXPECT_GT ( owned[i], 50u );
+    }
+}
+
+TEST ( mutant_sampler, no_limit_selects_all )
+{
+    using namespace ::chimera;
+    MutantSampler sampler ( MutantBudget(), SamplingStrategy::Uniform, 1, 0,
+                            MutantShard(), "target.cpp" );
+    EXPECT_EQ ( 0u, sampler.add ( { "f", 1, 1, "op1", "m", 2 }, false ) );
+    EXPECT_EQ ( 2u, sampler.add ( { "g", 2, 1, "op1", "m", 1 }, false ) );
+    sampler.sample();
+    ASSERT_EQ ( 3u, sampler.size() );
+    for ( ::std::size_t i = 0; i < sampler.size(); ++i ) {
+        EXPECT_TRUE ( sampler.isSelected ( i ) );
+        EXPECT_EQ ( 1.0, sampler.getWeight ( i ) );
+        EXPECT_EQ ( "all", sampler.getStratum ( i ) );
+    }
+}
+
+TEST ( mutant_sampler, quotas_and_weights )
+{
+    using namespace ::chimera;
+    MutantBudget budget;
+    budget.maxMutants = 5;
+    MutantSampler sampler ( budget, SamplingStrategy::ByFunction, 42, 0,
+                            MutantShard(), "target.cpp" );
+    for ( unsigned line = 1; line <= 6; ++line ) {
+        sampler.add ( { "f", line, 1, "op1", "m", 1 }, false );
+    }
+    for ( unsigned line = 7; line <= 8; ++line ) {
+        sampler.add ( { "g", line, 1, "op1", "m", 1 }, false );
+    }
+    sampler.sample();
+    // 5 * 6 / 8 = 3.75 and 5 * 2 / 8 = 1.25: the largest remainder takes
+    // the leftover mutant
+    ::std::map<::std::string, ::std::size_t> selected;
+    for ( ::std::size_t i = 0; i < sampler.size(); ++i ) {
+        if ( sampler.isSelected ( i ) ) {
+            ++selected[sampler.getStratum ( i )];
+        }
+    }
+    EXPECT_EQ ( 4u, selected["f"] );
+    EXPECT_EQ ( 1u, selected["g"] );
+    // A selected mutation stands for candidates / selected of its cell
+    for ( ::std::size_t i = 0; i < sampler.size(); ++i ) {
+        if ( sampler.isSelected ( i ) ) {
+            EXPECT_DOUBLE_EQ ( i < 6 ? 6.0 / 4 : 2.0, sampler.getWeight ( i ) );
+        }
+    }
+}
+
+TEST ( mutant_sampler, per_operator_and_type_limits )
+{
+    using namespace ::chimera;
+    MutantBudget budget;
+    budget.perOperator = 3;
+    budget.perMutatorType = 2;
+    EXPECT_TRUE ( budget.isLimited() );
+    EXPECT_FALSE ( MutantBudget().isLimited() );
+    MutantSampler sampler ( budget, SamplingStrategy::Uniform, 7, 0,
+                            MutantShard(), "target.cpp" );
+    ::std::vector<::std::size_t> first;
+    for ( unsigned line = 1; line <= 4; ++line ) {
+        first.push_back ( sampler.add ( { "f", line, 1, "op1", "m", 2 },
+                                        false ) );
+    }
+    for ( unsigned line = 5; line <= 8; ++line ) {
+        sampler.add ( { "f", line, 1, "op2", "n", 1 }, false );
+    }
+    sampler.sample();
+    ::std::size_t op1 = 0, op2 = 0, type0 = 0, type1 = 0;
+    for ( ::std::size_t i = 0; i < sampler.size(); ++i ) {
+        if ( !sampler.isSelected ( i ) ) {
+            continue;
+        }
+        if ( i < 8 ) {
+            ++op1;
+            ++ ( i % 2 == 0 ? type0 : type1 );
+        } else {
+            ++op2;
+        }
+    }
+    EXPECT_EQ ( 3u, op1 );
+    EXPECT_LE ( type0, 2u );
+    EXPECT_LE ( type1, 2u );
+    EXPECT_EQ ( 2u, op2 );
+    EXPECT_EQ ( ::std::vector<::std::size_t> ( { 0, 2, 4, 6 } ), first );
+}
+
+TEST ( mutant_sampler, by_region_strata )
+{
+    using namespace ::chimera;
+    MutantSampler sampler ( MutantBudget(), SamplingStrategy::ByRegion, 1, 10,
+                            MutantShard(), "target.cpp" );
+    sampler.add ( { "f", 9, 1, "op1", "m", 1 }, false );
+    sampler.add ( { "f", 10, 1, "op1", "m", 1 }, false );
+    sampler.add ( { "f", 25, 1, "op1", "m", 1 }, false );
+    EXPECT_EQ ( "lines 0+", sampler.getStratum ( 0 ) );
+    EXPECT_EQ ( "lines 10+", sampler.getStratum ( 1 ) );
+    EXPECT_EQ ( "lines 20+", sampler.getStratum ( 2 ) );
+}
+
+TEST ( mutant_sampler, shards_split_the_same_sample )
+{
+    using namespace ::chimera;
+    MutantBudget budget;
+    budget.maxMutants = 10;
+    auto fill = [&budget] ( const MutantShard & shard ) {
+        ::std::unique_ptr<MutantSampler> sampler (
+            new MutantSampler ( budget, SamplingStrategy::ByFunction, 3, 0,
+                                shard, "target.cpp" ) );
+        for ( unsigned line = 1; line <= 30; ++line ) {
+            const char *function = line % 3 == 0 ? "f" : "g";
+            sampler->add ( { function, line, 1, "op1", "m", 1 }, false );
+        }
+        sampler->sample();
+        return sampler;
+    };
+    ::std::unique_ptr<MutantSampler> whole = fill ( MutantShard() );
+    // The same seed yields the same sample
+    ::std::unique_ptr<MutantSampler> again = fill ( MutantShard() );
+    ::std::vector<::std::unique_ptr<MutantSampler>> shards;
+    for ( unsigned i = 0; i < 3; ++i ) {
+        shards.push_back ( fill ( MutantShard ( i, 3 ) ) );
+    }
+    ::std::size_t selected = 0;
+    for ( ::std::size_t i = 0; i < whole->size(); ++i ) {
+        EXPECT_EQ ( whole->isSelected ( i ), again->isSelected ( i ) );
+        unsigned owners = 0;
+        for ( const auto &shard : shards ) {
+            owners += shard->isSelected ( i ) ? 1 : 0;
+        }
+        // Each selected mutation is applied by exactly one shard
+        EXPECT_EQ ( whole->isSelected ( i ) ? 1u : 0u, owners );
+        selected += whole->isSelected ( i ) ? 1 : 0;
+    }
+    EXPECT_EQ ( 10u, selected );
+}
+
+TEST ( mutation_journal, resume_loads_the_verdicts )
+{
+    using namespace ::chimera;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "journal.csv";
+    MutationJournal journal;
+    // Closed: nothing is written
+    journal.record ( 9, "lost", true, 9 );
+    ASSERT_TRUE ( journal.open ( path, false ) );
+    journal.record ( 0, "t.cpp|f|3:7|m#0", true, 3 );
+    // The key is the last field, it may contain commas
+    journal.record ( 1, "t.cpp|f|a,b|m#0", false, 0 );
+    journal.recordCheck ( "d41d8cd98f00b204e9800998ecf8427e", true );
+    journal.recordCheck ( "0123", false );
+    journal.close();
+    {
+        // Lines cut by an interruption
+        ::std::ofstream stream ( path, ::std::ios::app );
+        stream << "2,1\ncheck,1\n3,x,4,key\n";
+    }
+
+    ASSERT_TRUE ( journal.open ( path, true ) );
+    EXPECT_EQ ( 2u, journal.size() );
+    bool valid = false;
+    ::chimera::mutant::IdType id = 0;
+    ASSERT_TRUE ( journal.lookup ( 0, "t.cpp|f|3:7|m#0", valid, id ) );
+    EXPECT_TRUE ( valid );
+    EXPECT_EQ ( 3u, id );
+    ASSERT_TRUE ( journal.lookup ( 1, "t.cpp|f|a,b|m#0", valid, id ) );
+    EXPECT_FALSE ( valid );
+    // Another key: the source has changed
+    EXPECT_FALSE ( journal.lookup ( 0, "t.cpp|f|4:7|m#0", valid, id ) );
+    EXPECT_FALSE ( journal.lookup ( 2, "", valid, id ) );
+    EXPECT_FALSE ( journal.lookup ( 9, "lost", valid, id ) );
+    ASSERT_TRUE ( journal.lookupCheck ( "d41d8cd98f00b204e9800998ecf8427e",
+                                        valid ) );
+    EXPECT_TRUE ( valid );
+    ASSERT_TRUE ( journal.lookupCheck ( "0123", valid ) );
+    EXPECT_FALSE ( valid );
+    EXPECT_FALSE ( journal.lookupCheck ( "4567", valid ) );
+
+    // Resuming appends the new verdicts
+    journal.record ( 2, "t.cpp|g|1:1|m#0", true, 4 );
+    journal.close();
+    EXPECT_EQ ( 0u, journal.size() );
+    ASSERT_TRUE ( journal.open ( path, true ) );
+    EXPECT_EQ ( 3u, journal.size() );
+    ASSERT_TRUE ( journal.lookup ( 2, "t.cpp|g|1:1|m#0", valid, id ) );
+    EXPECT_EQ ( 4u, id );
+    journal.close();
+}
+
+TEST ( mutation_journal, discard_entries_keeps_the_checks )
+{
+    using namespace ::chimera;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "journal.csv";
+    MutationJournal journal;
+    ASSERT_TRUE ( journal.open ( path, false ) );
+    journal.record ( 0, "key", true, 1 );
+    journal.recordCheck ( "0123", true );
+    journal.close();
+    ASSERT_TRUE ( journal.open ( path, true ) );
+    journal.discardEntries();
+    EXPECT_EQ ( 0u, journal.size() );
+    bool valid = false;
+    ::chimera::mutant::IdType id = 0;
+    EXPECT_FALSE ( journal.lookup ( 0, "key", valid, id ) );
+    EXPECT_TRUE ( journal.lookupCheck ( "0123", valid ) );
+    // Still appending: the verdict checked again replaces the journaled one
+    journal.record ( 0, "key", true, 2 );
+    journal.close();
+    ASSERT_TRUE ( journal.open ( path, true ) );
+    ASSERT_TRUE ( journal.lookup ( 0, "key", valid, id ) );
+    EXPECT_EQ ( 2u, id );
+    journal.close();
+}
+
+TEST ( mutation_journal, open_without_resume_truncates )
+{
+    using namespace ::chimera;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "journal.csv";
+    MutationJournal journal;
+    ASSERT_TRUE ( journal.open ( path, false ) );
+    journal.record ( 0, "key", true, 1 );
+    journal.recordCheck ( "0123", true );
+    journal.close();
+    ASSERT_TRUE ( journal.open ( path, false ) );
+    EXPECT_EQ ( 0u, journal.size() );
+    journal.close();
+    ASSERT_TRUE ( journal.open ( path, true ) );
+    bool valid;
+    EXPECT_EQ ( 0u, journal.size() );
+    EXPECT_FALSE ( journal.lookupCheck ( "0123", valid ) );
+    journal.close();
+}
+
+TEST ( json, quote )
+{
+    using ::chimera::json::quote;
+    EXPECT_EQ ( "\"\"", quote ( "" ) );
+    EXPECT_EQ ( "\"a \\\"b\\\" \\\\ c\"", quote ( "a \"b\" \\ c" ) );
+    EXPECT_EQ ( "\"\\b\\f\\n\\r\\t\"", quote ( "\b\f\n\r\t" ) );
+    // The other control characters, UTF-8 is copied as it is
+    EXPECT_EQ ( "\"\\u0000\\u001f\\u0001\xc3\xa8\x7f\"",
+                quote ( ::std::string ( "\0\x1f\x01\xc3\xa8\x7f", 6 ) ) );
+}
+/// \}
+
+#endif /* INCLUDE_TESTING_CORE_TESTING_H_ */
@@ -30,12 +30,31 @@
 #include "Testing/ChimeraTest.h"
 
 // Include the header in which mutators are defined
+#include "Operators/Adder/Mutators.h"
+#include "Operators/EvoApprox8u/Mutators.h"
 #include "Operators/Examples/Mutators.h"
+#include "Operators/FLAP/Mutators.h"
+#include "Operators/LoopFirst/Mutators.h"
+#include "Operators/LoopSecond/Mutators.h"
+#include "Operators/TruncateInt/Mutators.h"
+#include "Operators/VPA/Mutators.h"
+#include "Operators/VPA_Native/Mutators.h"
 
 /// \addtogroup MUTATORS_TESTING Test cases for the Sample Mutators
 /// \{
 // Test mutators
 CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::examples::MutatorGreaterOpReplacement,mutator_greater_op_replacement );
+// The loop perforation mutators share the identifier, thus the test cases
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::perforation::MutatorLoopPerforation1,mutator_loop_perforation_first );
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::perforation::MutatorLoopPerforation2,mutator_loop_perforation_second );
+// Matched by the binary operator visitor, as in the Mutation Template
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::vpamutator::VPAFloatOperationMutator,mutator_vpa_operation );
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::vpa_nmutator::VPANFloatOperationMutator,mutator_vpa_n_operation );
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::flapmutator::FLAPFloatOperationMutator,mutator_flap_operation );
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::truncate::MutatorTruncateInt,mutator_trunc_integer );
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::evoapprox8u::MutatorEvoApprox8u,evoapprox8u );
+// Its mutants include inexact_adders.h, the test cases are not matched
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::adder::MutatorAdder,mutator_adder );
 /// \}
 
 #endif /* INCLUDE_TESTING_MUTATORS_TESTING_H_ */
@@ -0,0 +1,145 @@
+//===- PackTesting.h --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file PackTesting.h
+/// \brief This file contains the unit tests of the mutant pack format
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TESTING_PACK_TESTING_H_
+#define INCLUDE_TESTING_PACK_TESTING_H_
+
+#include "Testing/ChimeraTest.h"
+
+#include "Pack/MutantPack.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/// \addtogroup PACK_TESTING Test cases for the mutant pack
+/// \{
+TEST ( mutant_pack, writer_reader_round_trip )
+{
+    using namespace ::chimera::pack;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "mutants.pack";
+    // Binary safe: the contents may hold NULs
+    const ::std::string report = ::std::string ( "op,value\n" ) + '\0' + "1";
+    {
+        PackWriter writer ( path, "target.cpp" );
+        ASSERT_TRUE ( writer.isOpen() );
+        // The blobs of the mutants come interleaved, in any order
+        EXPECT_TRUE ( writer.add ( 5, "target.cpp", "int a = 5;\n" ) );
+        EXPECT_TRUE ( writer.add ( 2, "target.cpp", "int a = 2;\n" ) );
+        EXPECT_TRUE ( writer.add ( 5, "report.csv", report ) );
+        EXPECT_TRUE ( writer.add ( 9, "target.cpp", "" ) );
+        EXPECT_TRUE ( writer.close() );
+    }
+    PackReader reader;
+    ASSERT_TRUE ( reader.open ( path ) );
+    EXPECT_EQ ( "target.cpp", reader.getTargetFilename() );
+    // Sorted by id
+    ASSERT_EQ ( 3u, reader.getMutantsNumber() );
+    EXPECT_EQ ( 2u, reader.getMutantId ( 0 ) );
+    EXPECT_EQ ( 5u, reader.getMutantId ( 1 ) );
+    EXPECT_EQ ( 9u, reader.getMutantId ( 2 ) );
+    EXPECT_FALSE ( reader.hasMutant ( 3 ) );
+
+    Blob blob;
+    ASSERT_TRUE ( reader.getSource ( 2, blob ) );
+    EXPECT_EQ ( "int a = 2;\n", blob.getData() );
+    ASSERT_TRUE ( reader.getSource ( 9, blob ) );
+    EXPECT_EQ ( 0u, blob.size );
+    ASSERT_TRUE ( reader.getBlob ( 5, "report.csv", blob ) );
+    EXPECT_EQ ( report, blob.getData() );
+    EXPECT_FALSE ( reader.getBlob ( 2, "report.csv", blob ) );
+    EXPECT_FALSE ( reader.getSource ( 3, blob ) );
+
+    ::std::vector<Blob> blobs = reader.getBlobs ( 5 );
+    ASSERT_EQ ( 2u, blobs.size() );
+    EXPECT_EQ ( "target.cpp", blobs[0].getName() );
+    EXPECT_EQ ( "int a = 5;\n", blobs[0].getData() );
+    EXPECT_EQ ( "report.csv", blobs[1].getName() );
+    EXPECT_TRUE ( reader.getBlobs ( 3 ).empty() );
+}
+
+TEST ( mutant_pack, writer_rejects_repeated_blob )
+{
+    using namespace ::chimera::pack;
+    const ::std::string path =
+        ::chimera::testing::createTemporaryDirectory() + "mutants.pack";
+    {
+        PackWriter writer ( path, "target.cpp" );
+        ASSERT_TRUE ( writer.add ( 1, "target.cpp", "int a = 1;\n" ) );
+        // A mutant is saved once: a second copy would be a dead payload
+        EXPECT_FALSE ( writer.add ( 1, "target.cpp", "int a = 2;\n" ) );
+        EXPECT_TRUE ( writer.add ( 1, "report.csv", "op,1\n" ) );
+        EXPECT_TRUE ( writer.add ( 2, "target.cpp", "int a = 2;\n" ) );
+        EXPECT_TRUE ( writer.close() );
+    }
+    PackReader reader;
+    ASSERT_TRUE ( reader.open ( path ) );
+    ASSERT_EQ ( 2u, reader.getMutantsNumber() );
+    ::std::vector<Blob> blobs = reader.getBlobs ( 1 );
+    ASSERT_EQ ( 2u, blobs.size() );
+    EXPECT_EQ ( "int a = 1;\n", blobs[0].getData() );
+    EXPECT_EQ ( "report.csv", blobs[1].getName() );
+    Blob blob;
+    ASSERT_TRUE ( reader.getSource ( 2, blob ) );
+    EXPECT_EQ ( "int a = 2;\n", blob.getData() );
+}
+
+TEST ( mutant_pack, reader_rejects_invalid_pack )
+{
+    using namespace ::chimera::pack;
+    const ::std::string directory =
+        ::chimera::testing::createTemporaryDirectory();
+    const ::std::string path = directory + "mutants.pack";
+    {
+        PackWriter writer ( path, "target.cpp" );
+        ASSERT_TRUE ( writer.add ( 1, "target.cpp", "int a;\n" ) );
+        ASSERT_TRUE ( writer.close() );
+    }
+    ::std::string content;
+    {
+        ::std::ifstream in ( path, ::std::ios::binary );
+        content.assign ( ::std::istreambuf_iterator<char> ( in ),
+                         ::std::istreambuf_iterator<char>() );
+    }
+    // Truncated: the tables lie out of the file
+    {
+        ::std::ofstream out ( path, ::std::ios::binary | ::std::ios::trunc );
+        out << content.substr ( 0, content.size() - 1 );
+    }
+    PackReader reader;
+    EXPECT_FALSE ( reader.open ( path ) );
+    EXPECT_EQ ( 0u, reader.getMutantsNumber() );
+    // Not a pack
+    {
+        ::std::ofstream out ( path, ::std::ios::binary | ::std::ios::trunc );
+        out << ::std::string ( sizeof ( PackHeader ), 'x' );
+    }
+    EXPECT_FALSE ( reader.open ( path ) );
+    EXPECT_FALSE ( reader.open ( directory + "missing.pack" ) );
+}
+/// \}
+
+#endif /* INCLUDE_TESTING_PACK_TESTING_H_ */
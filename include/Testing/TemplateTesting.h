@@ -0,0 +1,141 @@
+//===- TemplateTesting.h ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file TemplateTesting.h
+/// \brief This file contains the unit tests of the Mutation Template, which
+///        analyzes a small source file
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TESTING_TEMPLATE_TESTING_H_
+#define INCLUDE_TESTING_TEMPLATE_TESTING_H_
+
+#include "Testing/ChimeraTest.h"
+
+#include "Core/MutationOperator.h"
+#include "Core/MutationTemplate.h"
+#include "Core/Mutator.h"
+
+#include "clang/Tooling/CompilationDatabase.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+/// \addtogroup TEMPLATE_TESTING Test cases for the Mutation Template
+/// \{
+
+/// @brief Test mutator replacing the + operators with a fixed text, which may
+///        not compile
+class PlusReplacement : public ::chimera::mutator::Mutator
+{
+public:
+    PlusReplacement ( ::std::string replacement,
+                      ::chimera::mutator::ValidationPolicy policy )
+        : Mutator ( ::chimera::mutator::StatementMatcherType,
+                    "plus_replacement", "Replaces + with a fixed text", 1 ),
+          replacement ( replacement ), policy ( policy ) {}
+
+    virtual clang::ast_matchers::StatementMatcher
+    getStatementMatcher() override {
+        using namespace clang::ast_matchers;
+        return stmt ( binaryOperator ( hasOperatorName ( "+" ) )
+                      .bind ( "plus_op" ) );
+    }
+    virtual ::chimera::mutator::ValidationPolicy
+    getValidationPolicy() const override {
+        return this->policy;
+    }
+    virtual bool getMatchedNode (
+        const ::chimera::mutator::NodeType &node,
+        clang::ast_type_traits::DynTypedNode &dynNode ) override {
+        const clang::BinaryOperator *op =
+            node.Nodes.getNodeAs<clang::BinaryOperator> ( "plus_op" );
+        if ( op == nullptr ) {
+            return false;
+        }
+        dynNode = clang::ast_type_traits::DynTypedNode::create ( *op );
+        return true;
+    }
+    virtual bool produceEdits ( const ::chimera::mutator::NodeType &node,
+                                ::chimera::mutator::MutatorType type,
+                                ::chimera::mutant::EditScript &edits )
+    override {
+        const clang::BinaryOperator *op =
+            node.Nodes.getNodeAs<clang::BinaryOperator> ( "plus_op" );
+        return replaceText ( node, op->getOperatorLoc(), this->replacement,
+                             edits );
+    }
+
+private:
+    ::std::string replacement;
+    ::chimera::mutator::ValidationPolicy policy;
+};
+
+/// @brief Fixture analyzing a source file with two + operators
+class mutation_template : public ::testing::Test
+{
+protected:
+    void SetUp() override {
+        this->root = ::chimera::testing::createTemporaryDirectory();
+        this->source = this->root + "target.cpp";
+        ::std::ofstream stream ( this->source );
+        stream << "int sum(int a, int b) {\n"
+               "  return a + b + 1;\n"
+               "}\n";
+        stream.close();
+        this->command.Directory = this->root;
+        this->command.CommandLine = { "clang-tool", "-fsyntax-only", "-w",
+                                      this->source
+                                    };
+    }
+
+    /// @brief Analyze the source file with a single mutator, trusting it and
+    ///        checking all the sampled mutants
+    int analyze ( ::chimera::m_operator::MutatorPtr mutator ) {
+        ::chimera::m_operator::MutationOperator op ( "plus_operator" );
+        op.addMutator ( mutator );
+        ::chimera::MutationTemplate t ( this->command, this->source,
+                                        this->root + "mutants" );
+        t.setTrustedMutators ( true );
+        t.setValidationSample ( 100 );
+        t.loadOperator ( &op );
+        return t.analyze();
+    }
+
+    ::std::string root;
+    ::std::string source;
+    ::clang::tooling::CompileCommand command;
+};
+
+TEST_F ( mutation_template, sampled_trusted_mutants_pass )
+{
+    EXPECT_EQ ( 0, this->analyze ( ::std::make_shared<PlusReplacement> (
+                       "-", ::chimera::mutator::SampleValidation ) ) );
+}
+
+TEST_F ( mutation_template, sampled_trusted_mutant_failing_fails_the_run )
+{
+    // The mutants don't compile, the mutator is wrong about its policy
+    EXPECT_NE ( 0, this->analyze ( ::std::make_shared<PlusReplacement> (
+                       "+ )", ::chimera::mutator::SampleValidation ) ) );
+}
+/// \}
+
+#endif /* INCLUDE_TESTING_TEMPLATE_TESTING_H_ */
@@ -0,0 +1,157 @@
+//===- ToolingTesting.h -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ToolingTesting.h
+/// \brief This file contains the unit tests of the tooling components
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TESTING_TOOLING_TESTING_H_
+#define INCLUDE_TESTING_TOOLING_TESTING_H_
+
+#include "Testing/ChimeraTest.h"
+
+#include "Pack/MutantPack.h"
+#include "Tooling/ShardMerger.h"
+#include "Utils.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/// \addtogroup TOOLING_TESTING Test cases for the tooling components
+/// \{
+
+/// @brief Fixture holding the outputs of two shards 0/2 and 1/2
+/// @details The mutants 1 and 2 are HOM ones, the FOM ids start from 3. The
+///          FOM mutants of a single run are, in order: 0:3, 1:3, 1:4, 0:4
+///          (shard:id), they are renumbered from 3 in such order.
+class shard_merger : public ::testing::Test
+{
+protected:
+    void SetUp() override {
+        this->root = ::chimera::testing::createTemporaryDirectory();
+        this->shards = { this->root + "shard0", this->root + "shard1" };
+        this->output = this->root + "merged";
+        write ( this->shards[0], "shard.csv", "shard,0,2,3\n"
+                "mutant,1,0,1,0,1\n"
+                "mutant,3,1,0,1,1\n"
+                "mutant,4,1,0,4,1\n" );
+        write ( this->shards[0], "report.csv", "1,hom\n3,a\n4,d\n" );
+        write ( this->shards[0], "sampling_weights.csv", "1,1\n3,2\n4,2\n" );
+        write ( this->shards[1], "shard.csv", "shard,1,2,3\n"
+                "mutant,3,1,0,2,1\n"
+                "mutant,4,1,0,3,1\n" );
+        write ( this->shards[1], "report.csv", "3,b\n4,c\n" );
+        write ( this->shards[1], "sampling_weights.csv", "3,4\n4,4\n" );
+        // The directories without a shard.csv are the same in every shard
+        for ( const ::std::string &shard : this->shards ) {
+            ::chimera::fs::createDirectories ( shard +
+                                               ::chimera::fs::pathSep +
+                                               "resources" );
+        }
+    }
+
+    /// @brief Write a file of the target of a shard
+    void write ( const ::std::string &shard, const ::std::string &file,
+                 const ::std::string &content ) {
+        const ::std::string dir =
+            shard + ::chimera::fs::pathSep + "target.cpp" +
+            ::chimera::fs::pathSep;
+        ::chimera::fs::createDirectories (
+            ::llvm::sys::path::parent_path ( dir + file ) );
+        ::std::ofstream stream ( dir + file, ::std::ios::binary );
+        stream << content;
+    }
+
+    /// @brief Read a file of the merged target
+    ::std::string read ( const ::std::string &file ) {
+        ::std::ifstream stream ( this->output + ::chimera::fs::pathSep +
+                                 "target.cpp" + ::chimera::fs::pathSep + file,
+                                 ::std::ios::binary );
+        return ::std::string ( ::std::istreambuf_iterator<char> ( stream ),
+                               ::std::istreambuf_iterator<char>() );
+    }
+
+    ::std::string root;
+    ::std::vector<::std::string> shards;
+    ::std::string output;
+};
+
+TEST_F ( shard_merger, renumbers_tree_mutants )
+{
+    write ( this->shards[0], "1/target.cpp", "hom" );
+    write ( this->shards[0], "3/target.cpp", "a" );
+    write ( this->shards[0], "4/target.cpp", "d" );
+    write ( this->shards[0], "4/report.csv", "d report" );
+    write ( this->shards[1], "3/target.cpp", "b" );
+    write ( this->shards[1], "4/target.cpp", "c" );
+    ::chimera::ShardMerger merger ( this->shards, this->output );
+    ASSERT_EQ ( 0, merger.run() );
+    // In the order of a single run, the HOM ids are kept
+    EXPECT_EQ ( "1,hom\n3,a\n4,b\n5,c\n6,d\n", read ( "report.csv" ) );
+    EXPECT_EQ ( "1,1\n3,2\n4,4\n5,4\n6,2\n", read ( "sampling_weights.csv" ) );
+    EXPECT_EQ ( "hom", read ( "1/target.cpp" ) );
+    EXPECT_EQ ( "a", read ( "3/target.cpp" ) );
+    EXPECT_EQ ( "b", read ( "4/target.cpp" ) );
+    EXPECT_EQ ( "c", read ( "5/target.cpp" ) );
+    EXPECT_EQ ( "d", read ( "6/target.cpp" ) );
+    EXPECT_EQ ( "d report", read ( "6/report.csv" ) );
+    EXPECT_TRUE ( ::llvm::sys::fs::is_directory (
+                      this->output + ::chimera::fs::pathSep + "resources" ) );
+}
+
+TEST_F ( shard_merger, renumbers_packed_mutants )
+{
+    const char *sources[2][2] = { { "a", "d" }, { "b", "c" } };
+    for ( unsigned i = 0; i < 2; ++i ) {
+        ::chimera::pack::PackWriter writer (
+            this->shards[i] + ::chimera::fs::pathSep + "target.cpp" +
+            ::chimera::fs::pathSep + "mutants.pack", "target.cpp" );
+        ASSERT_TRUE ( writer.add ( 3, "target.cpp", sources[i][0] ) );
+        ASSERT_TRUE ( writer.add ( 4, "target.cpp", sources[i][1] ) );
+        ASSERT_TRUE ( writer.close() );
+    }
+    ::chimera::ShardMerger merger ( this->shards, this->output );
+    ASSERT_EQ ( 0, merger.run() );
+    ::chimera::pack::PackReader reader;
+    ASSERT_TRUE ( reader.open ( this->output + ::chimera::fs::pathSep +
+                                "target.cpp" + ::chimera::fs::pathSep +
+                                "mutants.pack" ) );
+    ASSERT_EQ ( 4u, reader.getMutantsNumber() );
+    const char *expected[] = { "a", "b", "c", "d" };
+    for ( ::chimera::mutant::IdType id = 3; id <= 6; ++id ) {
+        ::chimera::pack::Blob blob;
+        ASSERT_TRUE ( reader.getSource ( id, blob ) );
+        EXPECT_EQ ( expected[id - 3], blob.getData() );
+    }
+}
+
+TEST_F ( shard_merger, rejects_missing_shards )
+{
+    ::chimera::ShardMerger merger ( { this->shards[1] }, this->output );
+    EXPECT_EQ ( 1, merger.run() );
+}
+/// \}
+
+#endif /* INCLUDE_TESTING_TOOLING_TESTING_H_ */
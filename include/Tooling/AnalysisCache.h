@@ -0,0 +1,87 @@
+//===- AnalysisCache.h ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file AnalysisCache.h
+/// \brief  This file contains the persistent cache of the source files
+///         analyses, used to skip the unchanged ones
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TOOLING_ANALYSISCACHE_H_
+#define INCLUDE_TOOLING_ANALYSISCACHE_H_
+
+#include "Utils.h"
+
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+#include <vector>
+
+namespace chimera {
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief On-disk cache of the analyses, in <output_dir>/.cache
+/// @details Each source file has an entry holding the key of its last
+///          successful analysis and the directory of its outputs. The key
+///          hashes everything the outputs depend on: when it matches, the
+///          outputs still on disk are reused as they are.
+///          Distinct source files use distinct entries, so the cache can be
+///          used by concurrent analyses.
+class AnalysisCache {
+ public:
+  /// @brief Ctor
+  /// @param outputPath The output directory
+  explicit AnalysisCache(const ::std::string& outputPath);
+
+  /// @brief Compute the key of the analysis of a source file
+  /// @param preprocessedSource The preprocessed content of the source file,
+  ///        so that the changes to the included headers are caught too
+  /// @param command The effective compile command of the source file
+  /// @param operators The identifiers of the loaded operators
+  /// @param confMap The functions/operators configuration
+  /// @param options The tool options affecting the outputs
+  static ::std::string computeKey(
+      ::llvm::StringRef preprocessedSource,
+      const ::clang::tooling::CompileCommand& command,
+      const ::std::vector<::std::string>& operators,
+      const conf::FunOpConfMap& confMap,
+      const ::std::vector<::std::string>& options);
+
+  /// @brief If the last analysis of a source file had the same key, and its
+  /// outputs are still in place
+  bool lookup(const ::std::string& sourcePath, const ::std::string& key,
+              const ::std::string& targetOutputDir) const;
+
+  /// @brief Record a successful analysis
+  /// @return If the entry has been written
+  bool store(const ::std::string& sourcePath, const ::std::string& key,
+             const ::std::string& targetOutputDir) const;
+
+  /// @brief Drop the entry of a source file, its outputs are being rewritten
+  void invalidate(const ::std::string& sourcePath) const;
+
+ private:
+  ::std::string getEntryPath(const ::std::string& sourcePath) const;
+
+  const ::std::string cacheDir;  ///< With trailing pathSep
+};
+
+}  // end chimera namespace
+#endif /* INCLUDE_TOOLING_ANALYSISCACHE_H_ */
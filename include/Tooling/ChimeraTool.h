@@ -27,11 +27,17 @@
 #define SRC_INCLUDE_CHIMERA_H_
 
 #include "Core/MutationOperator.h"
+#include "Core/TimeReport.h"
+#include "Utils.h"
 
 #include "llvm/ADT/StringMap.h"
 
+#include <functional>
+#include <memory>
+#include <string>
+
 // Forward declarations
-namespace clang { namespace tooling { class CompilationDatabase; } }
+namespace clang { namespace tooling { class CompilationDatabase; struct CompileCommand; } }
 
 
 namespace chimera
@@ -40,6 +46,10 @@ namespace chimera
 using MutationOperatorPtrMap =
     ::llvm::StringMap<m_operator::MutationOperatorPtr>;
 ///< Map of MutationOperator ptr
+using MutationOperatorFactory =
+    ::std::function<m_operator::MutationOperatorPtr()>;
+///< Function that builds a new instance of a MutationOperator
+using MutationOperatorFactoryMap = ::llvm::StringMap<MutationOperatorFactory>;
 
 struct SourcePreprocessingOptions {
     bool Preprocess : 1; ///< Preprocess the input (equivalent to -E), include
@@ -67,6 +77,14 @@ public:
     /// operation fails.
     bool registerMutationOperator ( m_operator::MutationOperatorPtr );
 
+    /// \brief Register a mutation operator through its factory
+    /// \details The mutators are stateful: when source files are analyzed
+    /// concurrently each of them gets its own instance of the operator.
+    /// \param The factory of the mutation operator to register
+    /// \return If succeeded, if the operator's identifier already exists the
+    /// operation fails.
+    bool registerMutationOperator ( MutationOperatorFactory );
+
     /// \brief Unregister a mutation operator
     /// \param The identifier of the mutation operator
     /// \return If succeeded, id est the operator was registered
@@ -82,8 +100,27 @@ public:
     int run ( int argc, const char **argv );
 
 private:
+    /// \brief Preprocess and analyze a single source file
+    /// \param sourcePath The absolute path of the source file
+    /// \param command The compile command of the source file
+    /// \param outputPath The output directory
+    /// \param confMap The functions/operators configuration
+    /// \param isolated If the file has to use its own operators instances
+    /// \return status
+    int runOnSourceFile ( ::std::string sourcePath,
+                          ::clang::tooling::CompileCommand command,
+                          const ::std::string &outputPath,
+                          const conf::FunOpConfMap &confMap, bool isolated );
+    /// \brief Write the time report in the output directory, as
+    /// time_report.json, and print it as a table
+    void writeTimeReport ( const ::std::string &outputPath ) const;
+
     ::clang::tooling::CompilationDatabase *compilationDatabasePtr;
     MutationOperatorPtrMap registeredOperatorMap;
+    MutationOperatorFactoryMap
+    registeredFactoryMap; ///< Factories of the registered operators
+    ::std::unique_ptr<TimeReport>
+    timeReport; ///< Timings and counters, nullptr without -time-report
 };
 } // End chimera namespace
 
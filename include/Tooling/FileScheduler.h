@@ -0,0 +1,78 @@
+//===- FileScheduler.h ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file FileScheduler.h
+/// \brief  This file contains the scheduler used to analyze several source
+///         files concurrently
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TOOLING_FILESCHEDULER_H_
+#define INCLUDE_TOOLING_FILESCHEDULER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chimera {
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Work-stealing scheduler of source files
+/// @details The files are sorted by size, largest first, and dealt round robin
+///          to the per-worker queues. A worker takes its next file from the
+///          head of its own queue; once empty, it steals the largest file left
+///          at the head of the other queues, so that big files never end up
+///          as stragglers.
+class FileScheduler {
+ public:
+  using Task = ::std::function<void(const ::std::string&)>;
+
+  /// @brief Ctor
+  /// @param jobs Number of worker threads
+  explicit FileScheduler(unsigned jobs);
+
+  /// @brief Run \p task on each file, returns when all the files are done
+  /// @param files The files to process
+  /// @param task The action to perform on a file, it must be thread safe
+  void run(const ::std::vector<::std::string>& files, const Task& task);
+
+ private:
+  struct WorkItem {
+    ::std::string file;
+    ::std::uint64_t size;
+  };
+  struct WorkerQueue {
+    ::std::mutex mutex;
+    ::std::deque<WorkItem> items;
+  };
+
+  /// @brief Take the next file of a worker, eventually stealing it
+  /// @return false if there is nothing left to do
+  bool next(unsigned worker, WorkItem& item);
+
+  const unsigned jobs;
+  ::std::vector<::std::unique_ptr<WorkerQueue>> queues;
+};
+
+}  // end chimera namespace
+#endif /* INCLUDE_TOOLING_FILESCHEDULER_H_ */
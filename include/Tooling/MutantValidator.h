@@ -0,0 +1,141 @@
+//===- MutantValidator.h ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantValidator.h
+/// \brief  This file contains the validation engine used to syntactically
+///         check the mutants of a target
+/// \details The mutated source is never written on disk: it is mapped as a
+///          virtual file on top of the real filesystem, so that the frontend
+///          reads it straight from memory.
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TOOLING_MUTANTVALIDATOR_H_
+#define INCLUDE_TOOLING_MUTANTVALIDATOR_H_
+
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward declarations
+namespace clang {
+class ASTUnit;
+class PCHContainerOperations;
+}
+
+namespace chimera {
+
+/// @brief Available validation engines
+enum class ValidationMode {
+  InMemory,  ///< Full parse of each mutant, mapped in memory
+  Preamble   ///< Reuse a precompiled preamble among the mutants
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Syntax checker for the mutants of a single target
+/// @details The compile command of the target is adapted once, at
+///          construction time, swapping the target with a virtual path. Each
+///          check maps the mutated buffer on such path through an in-memory
+///          overlay filesystem, thus nothing is written to the output
+///          directory.
+class MutantValidator {
+ public:
+  /// @brief Ctor
+  /// @param command The compile command of the target
+  /// @param targetPath The path to the original target
+  /// @param virtualPath The path on which mutants are mapped, it does not
+  ///        need to exist
+  MutantValidator(const ::clang::tooling::CompileCommand& command,
+                  const ::std::string& targetPath,
+                  const ::std::string& virtualPath);
+  virtual ~MutantValidator() {}
+
+  /// @brief Check the syntax of a mutant
+  /// @param code The whole mutated content of the target
+  /// @param additionalCommands Mutator specific compile commands
+  /// @return If the mutant passes the check
+  virtual bool check(::llvm::StringRef code,
+                     const ::std::vector<::std::string>& additionalCommands);
+
+  const ::std::string& getTargetPath() const { return this->targetPath; }
+  const ::std::string& getVirtualPath() const { return this->virtualPath; }
+
+ protected:
+  /// @brief Return the compile command for a mutant, extended with the
+  /// mutator specific compile commands
+  ::clang::tooling::CompileCommand getCommand(
+      const ::std::vector<::std::string>& additionalCommands) const;
+
+  ::clang::tooling::CompileCommand command;  ///< Command with swapped target
+  const ::std::string targetPath;   ///< Original target path
+  const ::std::string virtualPath;  ///< Path of the in-memory mutant
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Syntax checker that reuses a precompiled preamble
+/// @details All the mutants of a target share the same #include directives,
+///          so the preamble is built once from the original target and each
+///          check only reparses the main file, remapped on the original path.
+///          When a mutant edits the preamble region (e.g. a mutator injects an
+///          #include) the check falls back to the full in-memory parse of
+///          MutantValidator, leaving the shared preamble untouched.
+///          A translation unit is kept for each distinct set of mutator
+///          specific compile commands.
+class PreambleMutantValidator : public MutantValidator {
+ public:
+  PreambleMutantValidator(const ::clang::tooling::CompileCommand& command,
+                          const ::std::string& targetPath,
+                          const ::std::string& virtualPath);
+  ~PreambleMutantValidator() override;
+
+  bool check(::llvm::StringRef code,
+             const ::std::vector<::std::string>& additionalCommands) override;
+
+ private:
+  /// @brief Retrieve (eventually building it) the translation unit for a set
+  /// of additional compile commands
+  /// @return nullptr if the original target cannot be loaded
+  ::clang::ASTUnit* getUnit(
+      const ::std::vector<::std::string>& additionalCommands);
+  /// @brief If \p code has the same preamble of the original target
+  bool sharesPreamble(::llvm::StringRef code) const;
+
+  ::clang::tooling::CompileCommand preambleCommand;  ///< Unswapped command
+  ::std::shared_ptr<::clang::PCHContainerOperations> pchContainerOps;
+  ::std::map<::std::vector<::std::string>, ::std::unique_ptr<::clang::ASTUnit>>
+      units;
+  ::std::string originalPreamble;  ///< Preamble of the original target
+  bool preambleComputed;
+};
+
+/// @brief Create the validation engine for a target
+/// @param mode The validation engine to use
+/// @param command The compile command of the target
+/// @param targetPath The path to the original target
+/// @param virtualPath The path on which mutants are mapped
+::std::unique_ptr<MutantValidator> createMutantValidator(
+    ValidationMode mode, const ::clang::tooling::CompileCommand& command,
+    const ::std::string& targetPath, const ::std::string& virtualPath);
+
+}  // end chimera namespace
+#endif /* INCLUDE_TOOLING_MUTANTVALIDATOR_H_ */
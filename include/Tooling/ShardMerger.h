@@ -0,0 +1,87 @@
+//===- ShardMerger.h --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ShardMerger.h
+/// \brief  This file contains the merge of the outputs of a sharded
+///         mutation campaign
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TOOLING_SHARDMERGER_H_
+#define INCLUDE_TOOLING_SHARDMERGER_H_
+
+#include "Core/Mutant.h"
+
+#include <string>
+#include <vector>
+
+namespace chimera {
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Merge of the output directories of the shards i/N of a campaign
+/// @details Each shard writes, next to report.csv, a shard.csv: the header
+///          shard,<i>,<N>,<first FOM id>, then a row for each mutant report
+///          mutant,<id>,<phase>,<group>,<ordinal>,<reported>, in the order
+///          of report.csv. The rows of all the shards, sorted by (phase,
+///          group, ordinal), are in the order of a single run, so the FOM
+///          mutants are renumbered from the first FOM id in such order. The
+///          HOM mutants keep their ids, reserved in the same way by every
+///          shard. The report, the sampling weights and the mutants (tree,
+///          delta or pack) are rewritten with the merged ids.
+class ShardMerger {
+ public:
+  /// @brief Ctor
+  /// @param shardDirs The output directories of all the shards
+  /// @param outputDir The output directory of the merge
+  ShardMerger(const ::std::vector<::std::string>& shardDirs,
+              const ::std::string& outputDir);
+
+  /// @brief Merge the outputs of all the source files
+  /// @return 0 OK, 1 if a source file couldn't be merged
+  int run();
+
+ private:
+  /// @brief A mutant report of a shard, see shard.csv
+  struct Entry {
+    mutant::IdType id;
+    unsigned phase;
+    mutant::IdType group;  ///< The HOM id of the deferred mutants
+    unsigned long long ordinal;
+    bool reported;
+    ::std::size_t shard;  ///< Index in shardDirs
+    ::std::string reportRow;
+    ::std::string weightRow;
+  };
+
+  /// @brief Merge the outputs of a source file
+  /// @param target The name of the output directory of the source file
+  bool mergeTarget(const ::std::string& target);
+
+  /// @brief Load the entries of a shard, with their report and weight rows
+  bool loadShard(const ::std::string& targetDir, ::std::size_t shard,
+                 unsigned& index, unsigned& count,
+                 mutant::IdType& firstId, bool& hasWeights,
+                 ::std::vector<Entry>& entries) const;
+
+  const ::std::vector<::std::string> shardDirs;
+  const ::std::string outputDir;
+};
+
+}  // end chimera namespace
+#endif /* INCLUDE_TOOLING_SHARDMERGER_H_ */
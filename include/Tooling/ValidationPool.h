@@ -0,0 +1,97 @@
+//===- ValidationPool.h -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ValidationPool.h
+/// \brief  This file contains the pool of workers that check the mutants of a
+///         target concurrently
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TOOLING_VALIDATIONPOOL_H_
+#define INCLUDE_TOOLING_VALIDATIONPOOL_H_
+
+#include "Tooling/MutantValidator.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chimera {
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Pool of workers that syntactically check mutants
+/// @details Each worker owns a validation engine, thus a frontend of its own.
+///          The verdicts are returned as futures: it is up to the caller to
+///          consume them in submission order, to keep ids and reports
+///          deterministic.
+///          With a single job no thread is spawned and each check is
+///          performed at submission time, on the caller thread.
+class ValidationPool {
+  using Task = ::std::packaged_task<bool(MutantValidator&)>;
+
+ public:
+  using ValidatorFactory =
+      ::std::function<::std::unique_ptr<MutantValidator>()>;
+  /// @brief Called by the worker with the duration of a check, in seconds
+  using CheckObserver = ::std::function<void(double)>;
+
+  /// @brief Ctor
+  /// @param jobs Number of workers
+  /// @param factory Function that builds the validation engine of a worker
+  ValidationPool(unsigned jobs, const ValidatorFactory& factory);
+  /// @brief Dtor, the pending checks are completed before joining the workers
+  ~ValidationPool();
+
+  /// @brief Queue the check of a mutant
+  /// @param code The whole mutated content of the target
+  /// @param additionalCommands Mutator specific compile commands
+  /// @param observer If set, the check is timed
+  /// @return The verdict of the check
+  ::std::future<bool> submit(
+      const ::std::string& code,
+      const ::std::vector<::std::string>& additionalCommands,
+      const CheckObserver& observer = CheckObserver());
+
+  unsigned getJobs() const { return this->jobs; }
+
+  /// @brief Maximum number of verdicts that should be left unconsumed, it
+  /// keeps all the workers busy bounding the memory used by the snapshots
+  unsigned getMaxPending() const { return this->jobs > 1 ? 2 * this->jobs : 0; }
+
+ private:
+  /// @brief Body of a worker thread
+  void work(MutantValidator& validator);
+
+  const unsigned jobs;
+  ::std::vector<::std::unique_ptr<MutantValidator>> validators;
+  ::std::vector<::std::thread> workers;
+  ::std::deque<Task> tasks;  ///< Checks waiting for a worker
+  ::std::mutex tasksMutex;
+  ::std::condition_variable tasksCondition;
+  bool stopping;
+};
+
+}  // end chimera namespace
+#endif /* INCLUDE_TOOLING_VALIDATIONPOOL_H_ */
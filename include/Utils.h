@@ -81,6 +81,17 @@ void deleteDirectory(const llvm::Twine &path);
 
 } // End chimera::fs namespace
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief JSON functions
+namespace json {
+
+/// @brief Quote a string as a JSON string
+/// @details The quotes, the backslashes and the control characters are
+/// escaped, the other bytes are copied as they are (UTF-8).
+std::string quote(const std::string &value);
+
+} // End chimera::json namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Syntax checker
 namespace syntax {
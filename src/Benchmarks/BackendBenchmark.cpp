@@ -0,0 +1,156 @@
+//===- BackendBenchmark.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file BackendBenchmark.cpp
+/// \brief Microbenchmark of the matching backends
+/// \details It generates a large translation unit of arithmetic and relational
+///          operations, then it times the matchers of the binary operator
+///          mutators registered as functionDecl(forEachDescendant(...))
+///          against the BinaryOperatorMatcher visitor backend.
+///          The parsing time, measured with an empty finder, is subtracted.
+///          Usage: backend-benchmark [functions] [runs]
+//===----------------------------------------------------------------------===//
+
+#include "Core/BinaryOperatorMatcher.h"
+#include "Operators/Adder/Mutators.h"
+#include "Operators/EvoApprox8u/Mutators.h"
+#include "Operators/Examples/Mutators.h"
+#include "Operators/FLAP/Mutators.h"
+#include "Operators/TruncateInt/Mutators.h"
+#include "Operators/VPA/Mutators.h"
+#include "Operators/VPA_Native/Mutators.h"
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Tooling/Tooling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace clang;
+using namespace clang::ast_matchers;
+
+namespace {
+/// @brief Count the matches of a mutator over all the runs
+class CountingCallback : public MatchFinder::MatchCallback {
+public:
+  CountingCallback() : matches(0) {}
+  void run(const MatchFinder::MatchResult &result) override {
+    // Both backends must bind the function, as the mutators expect
+    if (result.Nodes.getNodeAs<FunctionDecl>("functionDecl") != nullptr) {
+      ++this->matches;
+    }
+  }
+  unsigned matches;
+};
+
+std::string generateSource(unsigned functions) {
+  std::string code;
+  for (unsigned i = 0; i < functions; ++i) {
+    const std::string n = std::to_string(i);
+    code += "double f" + n + "(float a, double b, int c, unsigned d) {\n"
+            "  float x = a * a + (float)c;\n"
+            "  double y = b / (double)a - b * x;\n"
+            "  int z = c + (int)d * c - 3;\n"
+            "  for (int k = 0; k < c; ++k) { x += a * 0.5f; y -= x * b; }\n"
+            "  if (x > y && z > c) { z = z / 2 + c * (c - 1); }\n"
+            "  return (x + y) * (b - a) + z;\n"
+            "}\n";
+  }
+  return code;
+}
+
+/// @brief Best wall time of runs parses of code, in milliseconds
+double timeFinder(MatchFinder &finder, const std::string &code,
+                  unsigned runs) {
+  double best = 0;
+  for (unsigned run = 0; run < runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    tooling::runToolOnCode(
+        tooling::newFrontendActionFactory(&finder)->create(), code,
+        "benchmark.cpp");
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+  }
+  return best;
+}
+} // end anonymous namespace
+
+int main(int argc, const char **argv) {
+  const unsigned functions = argc > 1 ? std::atoi(argv[1]) : 5000;
+  const unsigned runs = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 3;
+  const std::string code = generateSource(functions);
+
+  std::vector<std::unique_ptr<chimera::mutator::Mutator>> mutators;
+  mutators.emplace_back(new chimera::examples::MutatorGreaterOpReplacement());
+  mutators.emplace_back(new chimera::adder::MutatorAdder());
+  mutators.emplace_back(new chimera::truncate::MutatorTruncateInt());
+  mutators.emplace_back(new chimera::evoapprox8u::MutatorEvoApprox8u());
+  mutators.emplace_back(new chimera::vpamutator::VPAFloatOperationMutator());
+  mutators.emplace_back(
+      new chimera::vpa_nmutator::VPANFloatOperationMutator());
+  mutators.emplace_back(new chimera::flapmutator::FLAPFloatOperationMutator());
+
+  MatchFinder emptyFinder;
+  const double parsing = timeFinder(emptyFinder, code, runs);
+
+  std::vector<CountingCallback> matcherCounts(mutators.size());
+  MatchFinder matcherFinder;
+  for (unsigned i = 0; i < mutators.size(); ++i) {
+    matcherFinder.addMatcher(
+        functionDecl(isDefinition(),
+                     forEachDescendant(mutators[i]->getStatementMatcher()))
+            .bind("functionDecl"),
+        &matcherCounts[i]);
+  }
+  const double matcherTime = timeFinder(matcherFinder, code, runs) - parsing;
+
+  std::vector<CountingCallback> visitorCounts(mutators.size());
+  chimera::BinaryOperatorMatcher visitor;
+  MatchFinder visitorFinder;
+  for (unsigned i = 0; i < mutators.size(); ++i) {
+    visitor.addMatcher(visitorFinder, mutators[i]->getStatementMatcher(),
+                       &visitorCounts[i]);
+  }
+  const double visitorTime = timeFinder(visitorFinder, code, runs) - parsing;
+
+  std::cout << "Functions: " << functions << ", parsing: " << parsing
+            << " ms\n";
+  std::cout << "ASTMatcher backend: " << matcherTime << " ms\n";
+  std::cout << "Visitor backend: " << visitorTime << " ms\n";
+  bool agree = true;
+  for (unsigned i = 0; i < mutators.size(); ++i) {
+    std::cout << "  " << mutators[i]->getIdentifier() << ": "
+              << matcherCounts[i].matches / runs << " / "
+              << visitorCounts[i].matches / runs << " matches\n";
+    agree = agree && matcherCounts[i].matches == visitorCounts[i].matches;
+  }
+  if (visitorTime > 0) {
+    std::cout << "Speedup: " << matcherTime / visitorTime << "x\n";
+  }
+  // The two backends must agree
+  return agree ? 0 : 1;
+}
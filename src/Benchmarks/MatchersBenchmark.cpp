@@ -0,0 +1,151 @@
+//===- MatchersBenchmark.cpp ------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MatchersBenchmark.cpp
+/// \brief Microbenchmark of the operand type matchers
+/// \details It generates a large translation unit of float, double and int
+///          operations, then it times the VPA operation matcher written with
+///          hasCanonicalType(asString(...)) against chimera::matchers.
+///          The parsing time, measured with an empty finder, is subtracted.
+///          Usage: matchers-benchmark [functions] [runs]
+//===----------------------------------------------------------------------===//
+
+#include "Core/Matchers.h"
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Tooling/Tooling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace clang;
+using namespace clang::ast_matchers;
+
+namespace {
+// The matcher removed from the operators, kept here as a baseline
+#define XHS_INTERNAL_MATCHER(id) ignoringParenImpCasts(expr().bind(id))
+#define XHS_MATCHER(type, id)                                                  \
+  allOf(hasType(qualType(hasCanonicalType(asString(type)))),                   \
+        anyOf(XHS_INTERNAL_MATCHER(id),                                        \
+              ignoringParenImpCasts(                                           \
+                  castExpr(has(expr(XHS_INTERNAL_MATCHER(id)))))))
+
+StatementMatcher stringMatcher() {
+  return binaryOperator(
+      anyOf(binaryOperator(hasLHS(XHS_MATCHER("float", "lhs")),
+                           hasRHS(XHS_MATCHER("float", "rhs")))
+                .bind("floatOp"),
+            binaryOperator(hasLHS(XHS_MATCHER("double", "lhs")),
+                           hasRHS(XHS_MATCHER("double", "rhs")))
+                .bind("doubleOp"),
+            binaryOperator(hasLHS(XHS_MATCHER("double", "lhs")),
+                           hasRHS(XHS_MATCHER("float", "rhs")))
+                .bind("doubleOp"),
+            binaryOperator(hasLHS(XHS_MATCHER("float", "lhs")),
+                           hasRHS(XHS_MATCHER("double", "rhs")))
+                .bind("doubleOp")));
+}
+
+/// @brief Count the matches, split by the bound operation, over all the runs
+class CountingCallback : public MatchFinder::MatchCallback {
+public:
+  CountingCallback() : floatOps(0), doubleOps(0) {}
+  void run(const MatchFinder::MatchResult &result) override {
+    if (result.Nodes.getNodeAs<BinaryOperator>("floatOp") != nullptr) {
+      ++this->floatOps;
+    } else {
+      ++this->doubleOps;
+    }
+  }
+  unsigned floatOps;
+  unsigned doubleOps;
+};
+
+std::string generateSource(unsigned functions) {
+  std::string code;
+  for (unsigned i = 0; i < functions; ++i) {
+    const std::string n = std::to_string(i);
+    code += "double f" + n + "(float a, double b, int c, unsigned d) {\n"
+            "  float x = a * a + (float)c;\n"
+            "  double y = b / (double)a - b * x;\n"
+            "  int z = c + (int)d * c - 3;\n"
+            "  for (int k = 0; k < c; ++k) { x += a * 0.5f; y -= x * b; }\n"
+            "  return (x + y) * (b - a) + z;\n"
+            "}\n";
+  }
+  return code;
+}
+
+/// @brief Best wall time of runs parses of code, in milliseconds
+double timeFinder(MatchFinder &finder, const std::string &code,
+                  unsigned runs) {
+  double best = 0;
+  for (unsigned run = 0; run < runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    tooling::runToolOnCode(
+        tooling::newFrontendActionFactory(&finder)->create(), code,
+        "benchmark.cpp");
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+  }
+  return best;
+}
+} // end anonymous namespace
+
+int main(int argc, const char **argv) {
+  const unsigned functions = argc > 1 ? std::atoi(argv[1]) : 5000;
+  const unsigned runs = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 3;
+  const std::string code = generateSource(functions);
+
+  MatchFinder emptyFinder;
+  const double parsing = timeFinder(emptyFinder, code, runs);
+
+  CountingCallback stringCount;
+  MatchFinder stringFinder;
+  stringFinder.addMatcher(stringMatcher(), &stringCount);
+  const double stringTime = timeFinder(stringFinder, code, runs) - parsing;
+
+  CountingCallback kindCount;
+  MatchFinder kindFinder;
+  kindFinder.addMatcher(chimera::matchers::floatOperation(), &kindCount);
+  const double kindTime = timeFinder(kindFinder, code, runs) - parsing;
+
+  std::cout << "Functions: " << functions << ", parsing: " << parsing
+            << " ms\n";
+  std::cout << "asString matchers: " << stringTime << " ms, "
+            << stringCount.floatOps / runs << " float / "
+            << stringCount.doubleOps / runs << " double operations\n";
+  std::cout << "Type kind matchers: " << kindTime << " ms, "
+            << kindCount.floatOps / runs << " float / "
+            << kindCount.doubleOps / runs << " double operations\n";
+  if (kindTime > 0) {
+    std::cout << "Speedup: " << stringTime / kindTime << "x\n";
+  }
+  // The two matchers must agree
+  return stringCount.floatOps == kindCount.floatOps &&
+                 stringCount.doubleOps == kindCount.doubleOps
+             ? 0
+             : 1;
+}
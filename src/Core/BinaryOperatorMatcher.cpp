@@ -0,0 +1,138 @@
+//===- BinaryOperatorMatcher.cpp --------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file BinaryOperatorMatcher.cpp
+/// \brief This file implements the class BinaryOperatorMatcher
+//===----------------------------------------------------------------------===//
+
+#include "Core/BinaryOperatorMatcher.h"
+#include "Core/FunctionSelector.h"
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+
+using namespace clang;
+using namespace clang::ast_matchers;
+using namespace chimera;
+
+namespace clang {
+namespace ast_matchers {
+/// @brief Matches any node, binding the function under visit as the
+/// Mutation Template does
+AST_MATCHER_P(Stmt, bindsFunction, const FunctionDecl *const *, function) {
+  Builder->setBinding("functionDecl",
+                      ast_type_traits::DynTypedNode::create(**function));
+  return true;
+}
+} // end namespace ast_matchers
+} // end namespace clang
+
+namespace {
+/// @brief Collect the binary operators of a function, in traversal order
+class BinaryOperatorCollector
+    : public RecursiveASTVisitor<BinaryOperatorCollector> {
+public:
+  explicit BinaryOperatorCollector(::std::vector<const BinaryOperator *> &ops)
+      : ops(ops) {}
+
+  // Visit what forEachDescendant visits
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  /// @details Called also for the CompoundAssignOperator nodes
+  bool VisitBinaryOperator(BinaryOperator *op) {
+    this->ops.push_back(op);
+    return true;
+  }
+
+private:
+  ::std::vector<const BinaryOperator *> &ops;
+};
+
+} // end anonymous namespace
+
+chimera::BinaryOperatorMatcher::BinaryOperatorMatcher(
+    const FunctionSelector *selector)
+    : selector(selector), function(nullptr), walked(nullptr) {}
+
+chimera::BinaryOperatorMatcher::~BinaryOperatorMatcher() {}
+
+void chimera::BinaryOperatorMatcher::addMatcher(
+    MatchFinder &finder, const StatementMatcher &matcher,
+    MatchFinder::MatchCallback *callback,
+    const ::std::vector<m_operator::IdType> &operatorIds) {
+  ::std::unique_ptr<Entry> entry(new Entry(*this));
+  // The function is read when the matcher is evaluated, at visit time
+  entry->finder.addMatcher(stmt(bindsFunction(&this->function), matcher),
+                           callback);
+  entry->callback = callback;
+  entry->operatorIds = operatorIds;
+  // Where the wrapped matcher would have been, to keep the order of the
+  // results
+  finder.addMatcher(functionDecl(isDefinition()).bind("functionDecl"),
+                    entry.get());
+  this->entries.push_back(::std::move(entry));
+}
+
+bool chimera::BinaryOperatorMatcher::isSelected(const FunctionDecl &function,
+                                                const Entry &entry) const {
+  if (this->selector == nullptr) {
+    return true;
+  }
+  for (const m_operator::IdType &operatorId : entry.operatorIds) {
+    if (this->selector->isSelected(function, operatorId)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const ::std::vector<const BinaryOperator *> &
+chimera::BinaryOperatorMatcher::getOperators(const FunctionDecl &function) {
+  if (this->walked != &function) {
+    this->operators.clear();
+    BinaryOperatorCollector(this->operators)
+        .TraverseDecl(const_cast<FunctionDecl *>(&function));
+    this->walked = &function;
+  }
+  return this->operators;
+}
+
+void chimera::BinaryOperatorMatcher::Entry::run(
+    const MatchFinder::MatchResult &Result) {
+  const FunctionDecl *function =
+      Result.Nodes.getNodeAs<FunctionDecl>("functionDecl");
+  assert(function && "FunctionDecl is nullptr");
+  if (!this->backend.isSelected(*function, *this)) {
+    return;
+  }
+  this->backend.function = function;
+  for (const BinaryOperator *op : this->backend.getOperators(*function)) {
+    this->finder.match(*op, *Result.Context);
+  }
+  this->backend.function = nullptr;
+}
+
+void chimera::BinaryOperatorMatcher::Entry::onEndOfTranslationUnit() {
+  // The nodes of the next translation unit could have the same addresses
+  this->backend.walked = nullptr;
+  this->backend.operators.clear();
+  this->callback->onEndOfTranslationUnit();
+}
@@ -0,0 +1,112 @@
+//===- CandidateCounter.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file CandidateCounter.cpp
+/// \brief This file implements the class CandidateCounter
+//===----------------------------------------------------------------------===//
+
+#include "Core/CandidateCounter.h"
+#include "Utils.h"
+
+#include <fstream>
+
+using ::chimera::json::quote;
+
+/// @brief Write a map of totals as a JSON object
+static void writeTotals(::std::ostream &stream, const char *name,
+                        const ::std::map<::std::string, ::std::size_t> &totals,
+                        bool last) {
+  stream << "  " << quote(name) << ": {";
+  const char *separator = "\n";
+  for (const auto &total : totals) {
+    stream << separator << "    " << quote(total.first) << ": "
+           << total.second;
+    separator = ",\n";
+  }
+  stream << (totals.empty() ? "}" : "\n  }") << (last ? "\n" : ",\n");
+}
+
+void chimera::CandidateCounter::add(const Candidate &candidate) {
+  this->candidates.push_back(candidate);
+  if (!candidate.functionName.empty()) {
+    this->perFunction[candidate.functionName] += candidate.mutations;
+  }
+  this->perOperator[candidate.operatorId] += candidate.mutations;
+  this->perMutator[candidate.mutatorId] += candidate.mutations;
+  this->totalMutations += candidate.mutations;
+}
+
+bool chimera::CandidateCounter::write(const ::std::string &directory,
+                                      CountFormat format) const {
+  switch (format) {
+    case CountFormat::JSON:
+      return this->writeJSON(directory);
+    case CountFormat::CSV:
+    default:
+      return this->writeCSV(directory);
+  }
+}
+
+bool chimera::CandidateCounter::writeCSV(const ::std::string &directory) const {
+  ::std::ofstream candidatesStream(directory + "candidates.csv");
+  for (const Candidate &candidate : this->candidates) {
+    candidatesStream << candidate.functionName << "," << candidate.line << ","
+                     << candidate.column << "," << candidate.operatorId << ","
+                     << candidate.mutatorId << "," << candidate.mutations
+                     << "\n";
+  }
+  ::std::ofstream countsStream(directory + "counts.csv");
+  for (const auto &total : this->perFunction) {
+    countsStream << "function," << total.first << "," << total.second << "\n";
+  }
+  for (const auto &total : this->perOperator) {
+    countsStream << "operator," << total.first << "," << total.second << "\n";
+  }
+  for (const auto &total : this->perMutator) {
+    countsStream << "mutator," << total.first << "," << total.second << "\n";
+  }
+  candidatesStream.close();
+  countsStream.close();
+  return candidatesStream.good() && countsStream.good();
+}
+
+bool chimera::CandidateCounter::writeJSON(
+    const ::std::string &directory) const {
+  ::std::ofstream stream(directory + "candidates.json");
+  stream << "{\n  \"total\": " << this->totalMutations
+         << ",\n  \"candidates\": [";
+  const char *separator = "\n";
+  for (const Candidate &candidate : this->candidates) {
+    stream << separator << "    {\"function\": "
+           << quote(candidate.functionName) << ", \"line\": " << candidate.line
+           << ", \"col\": " << candidate.column
+           << ", \"operator\": " << quote(candidate.operatorId)
+           << ", \"mutator\": " << quote(candidate.mutatorId)
+           << ", \"mutations\": " << candidate.mutations << "}";
+    separator = ",\n";
+  }
+  stream << (this->candidates.empty() ? "],\n" : "\n  ],\n");
+  writeTotals(stream, "functions", this->perFunction, false);
+  writeTotals(stream, "operators", this->perOperator, false);
+  writeTotals(stream, "mutators", this->perMutator, true);
+  stream << "}\n";
+  stream.close();
+  return stream.good();
+}
@@ -0,0 +1,163 @@
+//===- ContextIndex.cpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ContextIndex.cpp
+/// \brief This file implements the class ContextIndex
+//===----------------------------------------------------------------------===//
+
+#include "Core/ContextIndex.h"
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+
+using namespace clang;
+using namespace chimera;
+
+namespace {
+/// @brief Single traversal of a function, recording the context of each
+/// statement on the way down
+class ContextBuilder : public RecursiveASTVisitor<ContextBuilder> {
+public:
+  explicit ContextBuilder(ContextIndex::StmtContextMap &contexts)
+      : contexts(contexts), parent(nullptr) {}
+
+  // Visit what the MatchFinder visits
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  /// @details The signature differs from the base one on purpose: the
+  /// children are traversed through this function, recursively, thus the
+  /// context of the parent is at hand.
+  bool TraverseStmt(Stmt *stmt) {
+    if (stmt == nullptr) {
+      return true;
+    }
+    const StmtContext saved = this->context;
+    const Stmt *savedParent = this->parent;
+    if (this->parent != nullptr && this->parent == this->context.control) {
+      this->context.inCondition = !isBody(*this->parent, *stmt);
+    }
+    this->contexts[stmt] = this->context;
+    this->enter(*stmt);
+    this->parent = stmt;
+    const bool retval = RecursiveASTVisitor<ContextBuilder>::TraverseStmt(stmt);
+    this->context = saved;
+    this->parent = savedParent;
+    return retval;
+  }
+
+  bool TraverseVarDecl(VarDecl *decl) {
+    const VarDecl *saved = this->context.varDecl;
+    this->context.varDecl = decl;
+    const bool retval =
+        RecursiveASTVisitor<ContextBuilder>::TraverseVarDecl(decl);
+    this->context.varDecl = saved;
+    return retval;
+  }
+
+private:
+  /// @brief If child is the body of a control statement, i.e. not in the
+  /// control part
+  static bool isBody(const Stmt &control, const Stmt &child) {
+    if (const ForStmt *forStmt = dyn_cast<ForStmt>(&control)) {
+      return forStmt->getBody() == &child;
+    }
+    if (const WhileStmt *whileStmt = dyn_cast<WhileStmt>(&control)) {
+      return whileStmt->getBody() == &child;
+    }
+    if (const DoStmt *doStmt = dyn_cast<DoStmt>(&control)) {
+      return doStmt->getBody() == &child;
+    }
+    if (const CXXForRangeStmt *range = dyn_cast<CXXForRangeStmt>(&control)) {
+      return range->getBody() == &child;
+    }
+    const IfStmt *ifStmt = cast<IfStmt>(&control);
+    return ifStmt->getThen() == &child || ifStmt->getElse() == &child;
+  }
+
+  /// @brief Update the context for the children of stmt
+  void enter(const Stmt &stmt) {
+    if (const ForStmt *forStmt = dyn_cast<ForStmt>(&stmt)) {
+      this->context.forStmt = forStmt;
+      this->enterLoop(stmt);
+    } else if (const WhileStmt *whileStmt = dyn_cast<WhileStmt>(&stmt)) {
+      this->context.whileStmt = whileStmt;
+      this->enterLoop(stmt);
+    } else if (const DoStmt *doStmt = dyn_cast<DoStmt>(&stmt)) {
+      this->context.doStmt = doStmt;
+      this->enterLoop(stmt);
+    } else if (isa<CXXForRangeStmt>(&stmt)) {
+      this->enterLoop(stmt);
+    } else if (const IfStmt *ifStmt = dyn_cast<IfStmt>(&stmt)) {
+      this->context.ifStmt = ifStmt;
+      this->context.control = &stmt;
+    } else if (const CallExpr *call = dyn_cast<CallExpr>(&stmt)) {
+      this->context.call = call;
+    } else if (const ArraySubscriptExpr *subscript =
+                   dyn_cast<ArraySubscriptExpr>(&stmt)) {
+      this->context.subscript = subscript;
+    } else if (const BinaryOperator *bop = dyn_cast<BinaryOperator>(&stmt)) {
+      if (bop->getOpcode() == BO_Assign) {
+        this->context.assignment = bop;
+      }
+    }
+  }
+
+  void enterLoop(const Stmt &loop) {
+    this->context.loop = &loop;
+    ++this->context.loopDepth;
+    this->context.control = &loop;
+  }
+
+  ContextIndex::StmtContextMap &contexts;
+  StmtContext context; ///< Context of the children of parent
+  const Stmt *parent;  ///< The statement being traversed
+};
+} // end anonymous namespace
+
+const StmtContext &chimera::ContextIndex::get(const FunctionDecl &function,
+                                              const Stmt &stmt) {
+  auto entry = this->functions.find(&function);
+  if (entry == this->functions.end()) {
+    // First query on this function, index it whole
+    entry = this->functions.insert(::std::make_pair(&function,
+                                                    StmtContextMap())).first;
+    ContextBuilder builder(entry->second);
+    builder.TraverseDecl(const_cast<FunctionDecl *>(&function));
+  }
+  auto context = entry->second.find(&stmt);
+  return context != entry->second.end() ? context->second : this->none;
+}
+
+const StmtContext &chimera::ContextIndex::get(ASTContext &context,
+                                              const Stmt &stmt) {
+  ast_type_traits::DynTypedNode node =
+      ast_type_traits::DynTypedNode::create(stmt);
+  for (;;) {
+    auto parents = context.getParents(node);
+    if (parents.empty()) {
+      return this->none;
+    }
+    node = parents[0];
+    if (const FunctionDecl *function = node.get<FunctionDecl>()) {
+      return this->get(*function, stmt);
+    }
+  }
+}
@@ -0,0 +1,220 @@
+//===- DeferredMutant.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file DeferredMutant.cpp
+/// \brief This file implements the class DeferredMutant
+//===----------------------------------------------------------------------===//
+
+#include "Core/DeferredMutant.h"
+#include "Core/MutantDelta.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace chimera::mutant;
+
+chimera::mutant::DeferredMutant::DeferredMutant(const ::std::string &original)
+    : original(original), current(original), mutationsNumber(0) {}
+
+unsigned
+chimera::mutant::DeferredMutant::addMutation(const ::std::string &code) {
+  const unsigned mutation = this->mutationsNumber++;
+  // An edit per changed region, the mutation doesn't depend on the ones
+  // between them
+  const EditScript edits = computeEdits(this->current, code);
+  if (edits.empty()) {
+    // Nothing changed, the mutation doesn't belong to any group
+    return mutation;
+  }
+  // From the last edit, the positions before it don't change
+  unsigned group = noGroup;
+  for (auto edit = edits.rbegin(); edit != edits.rend(); ++edit) {
+    group = this->addEdit(edit->offset, edit->offset + edit->length,
+                          edit->replacement, group);
+  }
+  // The highest index so far, the mutations stay sorted
+  this->groups[group].mutations.push_back(mutation);
+  return mutation;
+}
+
+unsigned chimera::mutant::DeferredMutant::addEdit(::std::size_t hunkStart,
+                                                  ::std::size_t hunkEnd,
+                                                  const ::std::string &text,
+                                                  unsigned group) {
+  const ::std::string &prev = this->current;
+
+  // Find the pieces overlapping or touching the hunk, positions are in the
+  // coordinates of prev. Delta is the shift between prev and the original.
+  long long deltaAtStart = 0;
+  ::std::size_t before = 0; // Pieces entirely before the hunk
+  long long delta = 0;
+  ::std::size_t overlapping = 0;
+  ::std::size_t start = hunkStart, end = hunkEnd; // Merged range
+  for (const Piece &p : this->pieces) {
+    const ::std::size_t pStart = p.origStart + delta;
+    const ::std::size_t pEnd = pStart + p.text.size();
+    if (pStart > hunkEnd) {
+      break;
+    }
+    delta += (long long)p.text.size() - (long long)(p.origEnd - p.origStart);
+    if (pEnd < hunkStart) {
+      ++before;
+      deltaAtStart = delta;
+      continue;
+    }
+    ++overlapping;
+    start = ::std::min(start, pStart);
+    end = ::std::max(end, pEnd);
+  }
+  const long long deltaAtEnd = delta;
+
+  Piece merged;
+  merged.origStart = start - deltaAtStart;
+  merged.origEnd = end - deltaAtEnd;
+  merged.text = prev.substr(start, hunkStart - start) + text +
+                prev.substr(hunkEnd, end - hunkEnd);
+  // The edit depends on the overlapping pieces: their groups become one
+  merged.group = group;
+  for (::std::size_t i = before; i < before + overlapping; ++i) {
+    merged.group = this->mergeGroups(merged.group, this->pieces[i].group);
+  }
+  if (merged.group == noGroup) {
+    merged.group = this->groups.size();
+    this->groups.push_back(EditGroup());
+  }
+  const unsigned mergedGroup = merged.group;
+
+  this->pieces.erase(this->pieces.begin() + before,
+                     this->pieces.begin() + before + overlapping);
+  this->pieces.insert(this->pieces.begin() + before, ::std::move(merged));
+  this->current.replace(hunkStart, hunkEnd - hunkStart, text);
+  return mergedGroup;
+}
+
+unsigned chimera::mutant::DeferredMutant::mergeGroups(unsigned a, unsigned b) {
+  if (a == noGroup || a == b) {
+    return b;
+  }
+  if (b == noGroup) {
+    return a;
+  }
+  ::std::vector<unsigned> &into = this->groups[a].mutations;
+  ::std::vector<unsigned> &from = this->groups[b].mutations;
+  ::std::vector<unsigned> mutations;
+  ::std::merge(into.begin(), into.end(), from.begin(), from.end(),
+               ::std::back_inserter(mutations));
+  into = ::std::move(mutations);
+  from.clear();
+  for (Piece &p : this->pieces) {
+    if (p.group == b) {
+      p.group = a;
+    }
+  }
+  return a;
+}
+
+unsigned chimera::mutant::DeferredMutant::getGroupsNumber() const {
+  unsigned number = 0;
+  for (const EditGroup &g : this->groups) {
+    if (!g.mutations.empty()) {
+      ++number;
+    }
+  }
+  return number;
+}
+
+::std::string chimera::mutant::DeferredMutant::apply(
+    const ::std::vector<bool> &selected) const {
+  ::std::string code;
+  code.reserve(this->original.size());
+  ::std::size_t position = 0;
+  for (const Piece &p : this->pieces) {
+    if (!selected[p.group]) {
+      continue;
+    }
+    code.append(this->original, position, p.origStart - position);
+    code.append(p.text);
+    position = p.origEnd;
+  }
+  code.append(this->original, position, ::std::string::npos);
+  return code;
+}
+
+/// @brief Bisect the items in [first, last) over the accepted ones
+static void
+bisect(const ::std::function<bool(const ::std::vector<bool> &)> &check,
+       ::std::vector<bool> &selected, ::std::size_t first, ::std::size_t last) {
+  if (first >= last) {
+    return;
+  }
+  ::std::vector<bool> candidate = selected;
+  ::std::fill(candidate.begin() + first, candidate.begin() + last, true);
+  if (check(candidate)) {
+    selected = candidate;
+    return;
+  }
+  if (last - first == 1) {
+    return; // Offending item, drop it
+  }
+  const ::std::size_t middle = first + (last - first) / 2;
+  bisect(check, selected, first, middle);
+  bisect(check, selected, middle, last);
+}
+
+::std::vector<bool> chimera::mutant::bisectSelection(
+    ::std::size_t size,
+    const ::std::function<bool(const ::std::vector<bool> &)> &check) {
+  ::std::vector<bool> selected(size, false);
+  bisect(check, selected, 0, size);
+  return selected;
+}
+
+::std::string chimera::mutant::DeferredMutant::validate(
+    const CheckFunction &check, ::std::vector<bool> &keptMutations) const {
+  // The groups left by the merges
+  ::std::vector<unsigned> live;
+  for (unsigned g = 0; g < this->groups.size(); ++g) {
+    if (!this->groups[g].mutations.empty()) {
+      live.push_back(g);
+    }
+  }
+  auto byGroup = [this, &live](const ::std::vector<bool> &liveSelected) {
+    ::std::vector<bool> selected(this->groups.size(), false);
+    for (::std::size_t i = 0; i < live.size(); ++i) {
+      selected[live[i]] = liveSelected[i];
+    }
+    return selected;
+  };
+  const ::std::vector<bool> selected = byGroup(bisectSelection(
+      live.size(),
+      [this, &check, &byGroup](const ::std::vector<bool> &liveSelected) {
+        return check(this->apply(byGroup(liveSelected)));
+      }));
+
+  keptMutations.assign(this->mutationsNumber, true);
+  for (::std::size_t g = 0; g < this->groups.size(); ++g) {
+    if (!selected[g]) {
+      for (unsigned mutation : this->groups[g].mutations) {
+        keptMutations[mutation] = false;
+      }
+    }
+  }
+  return this->apply(selected);
+}
@@ -0,0 +1,199 @@
+//===- FunctionSelector.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file FunctionSelector.cpp
+/// \brief This file implements the class FunctionSelector
+//===----------------------------------------------------------------------===//
+
+#include "Core/FunctionSelector.h"
+#include "Log.h"
+
+#include "clang/AST/Decl.h"
+
+#include <algorithm>
+
+using namespace chimera;
+using namespace chimera::log;
+
+::std::string chimera::globToRegex(::llvm::StringRef glob) {
+  ::std::string regex;
+  for (::std::size_t i = 0; i < glob.size(); ++i) {
+    const char c = glob[i];
+    switch (c) {
+    case '*':
+      regex += ".*";
+      break;
+    case '?':
+      regex += ".";
+      break;
+    case '[': {
+      // Copy the class as is, [!...] is the negated one
+      ::std::size_t end = glob.find(']', i + 1);
+      if (end == ::llvm::StringRef::npos) {
+        regex += "\\[";
+        break;
+      }
+      ::llvm::StringRef cls = glob.slice(i + 1, end);
+      regex += "[";
+      if (cls.startswith("!")) {
+        regex += "^";
+        cls = cls.drop_front();
+      }
+      regex += cls.str() + "]";
+      i = end;
+      break;
+    }
+    case '.':
+    case '^':
+    case '$':
+    case '|':
+    case '(':
+    case ')':
+    case '+':
+    case '{':
+    case '}':
+    case '\\':
+      regex += '\\';
+      regex += c;
+      break;
+    default:
+      regex += c;
+    }
+  }
+  return regex;
+}
+
+chimera::FunctionSelector::FunctionSelector(
+    const conf::FunOpConfMap &map,
+    const ::std::vector<m_operator::IdType> &operators) {
+  // CHIMERA_ALL_FUNCTIONS overrides the other rows
+  auto allFunctions = map.find("CHIMERA_ALL_FUNCTIONS");
+  for (const auto &row : map) {
+    if (allFunctions != map.end() && row.first != allFunctions->first) {
+      continue;
+    }
+    ::std::vector<m_operator::IdType> rowOperators;
+    if (::std::find(row.second.begin(), row.second.end(),
+                    "CHIMERA_ALL_OPERATORS") != row.second.end()) {
+      rowOperators = operators;
+    } else {
+      for (const m_operator::IdType &op : row.second) {
+        // Skip the operators not loaded
+        if (::std::find(operators.begin(), operators.end(), op) !=
+            operators.end()) {
+          rowOperators.push_back(op);
+        }
+      }
+    }
+    for (const m_operator::IdType &op : rowOperators) {
+      if (allFunctions != map.end()) {
+        this->selections[op].all = true;
+      } else {
+        this->addSelector(op, row.first);
+      }
+    }
+  }
+  for (auto &entry : this->selections) {
+    Selection &selection = entry.second;
+    selection.automaton = compile(selection.patterns);
+    selection.qualifiedAutomaton = compile(selection.qualifiedPatterns);
+  }
+}
+
+void chimera::FunctionSelector::addSelector(
+    const m_operator::IdType &operatorId, const ::std::string &selector) {
+  Selection &selection = this->selections[operatorId];
+  ::llvm::StringRef name(selector);
+  const bool qualified = name.find("::") != ::llvm::StringRef::npos;
+  if (name.startswith("re:")) {
+    (qualified ? selection.qualifiedPatterns : selection.patterns)
+        .push_back(name.drop_front(3).str());
+  } else if (name.find_first_of("*?[") != ::llvm::StringRef::npos) {
+    (qualified ? selection.qualifiedPatterns : selection.patterns)
+        .push_back(globToRegex(name));
+  } else if (qualified) {
+    selection.qualifiedNames.push_back(selector);
+  } else {
+    selection.names.insert(selector);
+  }
+}
+
+::std::unique_ptr<::llvm::Regex> chimera::FunctionSelector::compile(
+    const ::std::vector<::std::string> &patterns) {
+  if (patterns.empty()) {
+    return nullptr;
+  }
+  // A single alternation, anchored to match whole names
+  ::std::string regex = "^(";
+  for (::std::size_t i = 0; i < patterns.size(); ++i) {
+    regex += (i > 0 ? "|(" : "(") + patterns[i] + ")";
+  }
+  regex += ")$";
+  ::std::unique_ptr<::llvm::Regex> automaton(new ::llvm::Regex(regex));
+  ::std::string error;
+  if (!automaton->isValid(error)) {
+    ChimeraLogger::error("Invalid function selector " + regex + ": " + error);
+    return nullptr;
+  }
+  return automaton;
+}
+
+::std::vector<m_operator::IdType>
+chimera::FunctionSelector::getOperators() const {
+  ::std::vector<m_operator::IdType> operators;
+  for (const auto &entry : this->selections) {
+    operators.push_back(entry.first);
+  }
+  return operators;
+}
+
+bool chimera::FunctionSelector::isSelected(
+    const ::clang::FunctionDecl &function,
+    const m_operator::IdType &operatorId) const {
+  auto entry = this->selections.find(operatorId);
+  if (entry == this->selections.end()) {
+    return false;
+  }
+  const Selection &selection = entry->second;
+  if (selection.all) {
+    return true;
+  }
+  const ::std::string name = function.getNameAsString();
+  if (selection.names.count(name) > 0 ||
+      (selection.automaton && selection.automaton->match(name))) {
+    return true;
+  }
+  if (selection.qualifiedNames.empty() && !selection.qualifiedAutomaton) {
+    return false;
+  }
+  // As hasName: ::ns::foo is fully qualified, ns::foo may be nested
+  const ::std::string qualifiedName = function.getQualifiedNameAsString();
+  for (const ::std::string &selector : selection.qualifiedNames) {
+    ::llvm::StringRef ref(selector);
+    if (ref.startswith("::") ? ref.drop_front(2) == qualifiedName
+                             : (qualifiedName == selector ||
+                                ::llvm::StringRef(qualifiedName)
+                                    .endswith("::" + selector))) {
+      return true;
+    }
+  }
+  return selection.qualifiedAutomaton &&
+         selection.qualifiedAutomaton->match(qualifiedName);
+}
@@ -0,0 +1,116 @@
+//===- Matchers.cpp ---------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file Matchers.cpp
+/// \brief This file implements the AST matchers shared among the mutators
+//===----------------------------------------------------------------------===//
+
+#include "Core/Matchers.h"
+
+using namespace clang;
+using namespace clang::ast_matchers;
+
+namespace chimera {
+namespace matchers {
+namespace {
+/// @brief Classify a floating point operand, by its canonical builtin kind
+enum class Precision { None, Float, Double };
+
+Precision getPrecision(const Expr *operand) {
+  const QualType canonical = operand->getType().getCanonicalType();
+  const BuiltinType *builtin = dyn_cast<BuiltinType>(canonical.getTypePtr());
+  if (builtin == nullptr || canonical.hasLocalQualifiers()) {
+    return Precision::None;
+  }
+  switch (builtin->getKind()) {
+  case BuiltinType::Float:
+    return Precision::Float;
+  case BuiltinType::Double:
+    return Precision::Double;
+  default:
+    return Precision::None;
+  }
+}
+
+/// @brief Matches the float/double operations, binding them by precision
+AST_MATCHER_P(BinaryOperator, bindsPrecision, bool, mixedPrecision) {
+  const Precision lhs = getPrecision(Node.getLHS());
+  const Precision rhs = getPrecision(Node.getRHS());
+  if (lhs == Precision::None || rhs == Precision::None ||
+      (lhs != rhs && !mixedPrecision)) {
+    return false;
+  }
+  const bool isFloat = lhs == Precision::Float && rhs == Precision::Float;
+  Builder->setBinding(isFloat ? "floatOp" : "doubleOp",
+                      ast_type_traits::DynTypedNode::create(Node));
+  return true;
+}
+} // end anonymous namespace
+} // end matchers namespace
+} // end chimera namespace
+
+const char chimera::matchers::floatOperationKey[] =
+    "chimera::matchers::floatOperation";
+const char chimera::matchers::integerOperationKey[] =
+    "chimera::matchers::integerOperation";
+
+internal::Matcher<QualType> chimera::matchers::isFloat() {
+  return hasBuiltinKind(BuiltinType::Float);
+}
+
+internal::Matcher<QualType> chimera::matchers::isDouble() {
+  return hasBuiltinKind(BuiltinType::Double);
+}
+
+internal::Matcher<QualType> chimera::matchers::isInt() {
+  return hasBuiltinKind(BuiltinType::Int);
+}
+
+internal::Matcher<QualType> chimera::matchers::isUnsignedInt() {
+  return hasBuiltinKind(BuiltinType::UInt);
+}
+
+internal::Matcher<Expr> chimera::matchers::operand(const std::string &id) {
+  // Without parenthesis and implicit casts, also bypassing an explicit cast:
+  // reach it and then go on the child, where the first rule applies again
+  return anyOf(
+      ignoringParenImpCasts(expr().bind(id)),
+      ignoringParenImpCasts(
+          castExpr(has(expr(ignoringParenImpCasts(expr().bind(id)))))));
+}
+
+internal::Matcher<Expr>
+chimera::matchers::operand(const internal::Matcher<QualType> &type,
+                           const std::string &id) {
+  return allOf(hasType(type), operand(id));
+}
+
+StatementMatcher chimera::matchers::floatOperation(bool mixedPrecision) {
+  // The precision is checked first, on the operands' types, then the
+  // operands are bound
+  return binaryOperator(bindsPrecision(mixedPrecision), hasLHS(operand("lhs")),
+                        hasRHS(operand("rhs")));
+}
+
+StatementMatcher chimera::matchers::integerOperation() {
+  return binaryOperator(hasLHS(operand(isInteger(), "lhs")),
+                        hasRHS(operand(isInteger(), "rhs")))
+      .bind("int_op");
+}
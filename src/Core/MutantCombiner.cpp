@@ -0,0 +1,198 @@
+//===- MutantCombiner.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantCombiner.cpp
+/// \brief This file implements the class MutantCombiner
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantCombiner.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+using namespace chimera::mutant;
+
+/// @brief Attempts per requested combination, before sampling gives up
+static const ::std::size_t sampleAttempts = 32;
+
+chimera::mutant::MutantCombiner::MutantCombiner(unsigned maxOrder,
+                                                ::std::size_t budget)
+    : maxOrder(maxOrder), budget(budget) {}
+
+void chimera::mutant::MutantCombiner::add(IdType id, EditScript edits) {
+  if (edits.empty()) {
+    return;
+  }
+  FirstOrder mutant;
+  mutant.id = id;
+  mutant.begin = edits.front().offset;
+  mutant.end = 0;
+  for (const Edit &edit : edits) {
+    mutant.end = ::std::max(mutant.end, edit.offset + edit.length);
+  }
+  mutant.edits = ::std::move(edits);
+  this->mutants.push_back(::std::move(mutant));
+}
+
+bool chimera::mutant::MutantCombiner::conflicts(::std::size_t a,
+                                                ::std::size_t b) const {
+  const FirstOrder &first = this->mutants[a];
+  const FirstOrder &second = this->mutants[b];
+  // Distant mutants are the common case, the spans tell it at once
+  if (first.end < second.begin || second.end < first.begin) {
+    return false;
+  }
+  EditScript composed;
+  return !composeEdits(first.edits, second.edits, composed);
+}
+
+bool chimera::mutant::MutantCombiner::compose(
+    const ::std::vector<::std::size_t> &indexes,
+    Combination &combination) const {
+  combination.parents.clear();
+  combination.edits.clear();
+  for (::std::size_t index : indexes) {
+    EditScript composed;
+    if (!composeEdits(combination.edits, this->mutants[index].edits,
+                      composed)) {
+      return false;
+    }
+    combination.edits = ::std::move(composed);
+    combination.parents.push_back(this->mutants[index].id);
+  }
+  ::std::sort(combination.parents.begin(), combination.parents.end());
+  return true;
+}
+
+namespace {
+/// @brief Depth first visit of the k-subsets of pairwise compatible mutants,
+/// in lexicographic order of their indexes
+/// @param visit Called on each subset, it returns false to stop the visit
+template <typename Compatible, typename Visit>
+bool visitSubsets(::std::size_t n, unsigned k, Compatible compatible,
+                  Visit visit, ::std::vector<::std::size_t> &subset) {
+  if (subset.size() == k) {
+    return visit(subset);
+  }
+  const ::std::size_t first = subset.empty() ? 0 : subset.back() + 1;
+  for (::std::size_t i = first; i + (k - subset.size()) <= n; ++i) {
+    bool ok = true;
+    for (::std::size_t j : subset) {
+      if (!compatible(j, i)) {
+        ok = false;
+        break;
+      }
+    }
+    if (!ok) {
+      continue;
+    }
+    subset.push_back(i);
+    const bool goOn = visitSubsets(n, k, compatible, visit, subset);
+    subset.pop_back();
+    if (!goOn) {
+      return false;
+    }
+  }
+  return true;
+}
+} // end anonymous namespace
+
+::std::size_t
+chimera::mutant::MutantCombiner::count(unsigned k, ::std::size_t limit) const {
+  ::std::size_t counted = 0;
+  ::std::vector<::std::size_t> subset;
+  visitSubsets(this->mutants.size(), k,
+               [this](::std::size_t a, ::std::size_t b) {
+                 return !this->conflicts(a, b);
+               },
+               [&counted, limit](const ::std::vector<::std::size_t> &) {
+                 return ++counted <= limit;
+               },
+               subset);
+  return counted;
+}
+
+void chimera::mutant::MutantCombiner::enumerate(
+    unsigned k, ::std::vector<Combination> &out) const {
+  ::std::vector<::std::size_t> subset;
+  visitSubsets(this->mutants.size(), k,
+               [this](::std::size_t a, ::std::size_t b) {
+                 return !this->conflicts(a, b);
+               },
+               [this, &out](const ::std::vector<::std::size_t> &indexes) {
+                 Combination combination;
+                 if (this->compose(indexes, combination)) {
+                   out.push_back(::std::move(combination));
+                 }
+                 return true;
+               },
+               subset);
+}
+
+void chimera::mutant::MutantCombiner::sample(
+    unsigned k, ::std::size_t n, ::std::vector<Combination> &out) const {
+  // The raw mt19937 output is portable, the distributions are not
+  ::std::mt19937 generator(k);
+  ::std::set<::std::vector<::std::size_t>> drawn;
+  ::std::vector<::std::size_t> indexes;
+  for (::std::size_t attempt = 0;
+       drawn.size() < n && attempt < n * sampleAttempts; ++attempt) {
+    indexes.clear();
+    while (indexes.size() < k) {
+      const ::std::size_t index = generator() % this->mutants.size();
+      if (::std::find(indexes.begin(), indexes.end(), index) ==
+          indexes.end()) {
+        indexes.push_back(index);
+      }
+    }
+    ::std::sort(indexes.begin(), indexes.end());
+    if (drawn.count(indexes) != 0) {
+      continue;
+    }
+    bool ok = true;
+    for (unsigned i = 0; i < k && ok; ++i) {
+      for (unsigned j = i + 1; j < k && ok; ++j) {
+        ok = !this->conflicts(indexes[i], indexes[j]);
+      }
+    }
+    Combination combination;
+    if (ok && this->compose(indexes, combination)) {
+      drawn.insert(indexes);
+      out.push_back(::std::move(combination));
+    }
+  }
+}
+
+::std::vector<Combination> chimera::mutant::MutantCombiner::combine() const {
+  ::std::vector<Combination> combinations;
+  for (unsigned k = 2; k <= this->maxOrder && k <= this->mutants.size(); ++k) {
+    const ::std::size_t left = this->budget - combinations.size();
+    if (left == 0) {
+      break;
+    }
+    if (this->count(k, left) <= left) {
+      this->enumerate(k, combinations);
+    } else {
+      this->sample(k, left, combinations);
+    }
+  }
+  return combinations;
+}
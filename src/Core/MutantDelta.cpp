@@ -0,0 +1,424 @@
+//===- MutantDelta.cpp ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantDelta.cpp
+/// \brief This file implements the delta storage of the mutants
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantDelta.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <sstream>
+
+using namespace chimera::mutant;
+
+/// @brief Magic of the delta files, followed by the format version
+static const char deltaMagic[] = "CHIMERA-DELTA 1";
+/// @brief Length of the trailer holding the offset of the index
+static const ::std::size_t trailerSize = 21;
+/// @brief Above this number of changed lines a single edit is stored
+static const int maxLineEdits = 64;
+
+/// @brief Split a range of \p text in lines, the newline belongs to the line
+static void splitLines(const ::std::string &text, ::std::size_t start,
+                       ::std::size_t end,
+                       ::std::vector<::std::size_t> &lineStarts) {
+  lineStarts.clear();
+  ::std::size_t pos = start;
+  while (pos < end) {
+    lineStarts.push_back(pos);
+    ::std::size_t newline = text.find('\n', pos);
+    pos = (newline == ::std::string::npos || newline >= end) ? end
+                                                             : newline + 1;
+  }
+  lineStarts.push_back(end);
+}
+
+/// @brief Append the edit replacing original[oStart, oEnd) with
+/// code[cStart, cEnd), trimmed of the common prefix and suffix
+static void appendEdit(EditScript &edits, const ::std::string &original,
+                       ::std::size_t oStart, ::std::size_t oEnd,
+                       const ::std::string &code, ::std::size_t cStart,
+                       ::std::size_t cEnd) {
+  while (oStart < oEnd && cStart < cEnd && original[oStart] == code[cStart]) {
+    ++oStart;
+    ++cStart;
+  }
+  while (oStart < oEnd && cStart < cEnd &&
+         original[oEnd - 1] == code[cEnd - 1]) {
+    --oEnd;
+    --cEnd;
+  }
+  if (oStart == oEnd && cStart == cEnd) {
+    return;
+  }
+  Edit edit;
+  edit.offset = oStart;
+  edit.length = oEnd - oStart;
+  edit.replacement = code.substr(cStart, cEnd - cStart);
+  edits.push_back(::std::move(edit));
+}
+
+EditScript chimera::mutant::computeEdits(const ::std::string &original,
+                                         const ::std::string &code) {
+  EditScript edits;
+  // Restrict to what differs between the common prefix and suffix
+  const ::std::size_t minSize = ::std::min(original.size(), code.size());
+  ::std::size_t prefix = 0;
+  while (prefix < minSize && original[prefix] == code[prefix]) {
+    ++prefix;
+  }
+  ::std::size_t suffix = 0;
+  while (suffix < minSize - prefix &&
+         original[original.size() - 1 - suffix] ==
+             code[code.size() - 1 - suffix]) {
+    ++suffix;
+  }
+  const ::std::size_t oEnd = original.size() - suffix;
+  const ::std::size_t cEnd = code.size() - suffix;
+
+  // Line diff (Myers) of the differing region, it splits distant changes
+  ::std::vector<::std::size_t> a, b;
+  splitLines(original, prefix, oEnd, a);
+  splitLines(code, prefix, cEnd, b);
+  const int n = a.size() - 1, m = b.size() - 1;
+  auto sameLine = [&](int x, int y) {
+    return a[x + 1] - a[x] == b[y + 1] - b[y] &&
+           original.compare(a[x], a[x + 1] - a[x], code, b[y],
+                            b[y + 1] - b[y]) == 0;
+  };
+  const int maxD = ::std::min(n + m, maxLineEdits);
+  ::std::vector<int> v(2 * maxD + 3, 0);
+  ::std::vector<::std::vector<int>> trace;
+  int found = -1;
+  for (int d = 0; d <= maxD && found < 0; ++d) {
+    trace.push_back(v);
+    for (int k = -d; k <= d; k += 2) {
+      const int i = k + maxD + 1;
+      int x = (k == -d || (k != d && v[i - 1] < v[i + 1])) ? v[i + 1]
+                                                           : v[i - 1] + 1;
+      int y = x - k;
+      while (x < n && y < m && sameLine(x, y)) {
+        ++x;
+        ++y;
+      }
+      v[i] = x;
+      if (x >= n && y >= m) {
+        found = d;
+        break;
+      }
+    }
+  }
+  if (found < 0) {
+    // Too many changes, a single edit is more compact anyway
+    appendEdit(edits, original, prefix, oEnd, code, prefix, cEnd);
+    return edits;
+  }
+
+  // Backtrack the matching lines
+  ::std::vector<::std::pair<int, int>> matches;
+  int x = n, y = m;
+  for (int d = found; d >= 0; --d) {
+    const ::std::vector<int> &prev = trace[d];
+    const int k = x - y;
+    int prevX = 0, prevY = 0;
+    if (d > 0) {
+      const int i = k + maxD + 1;
+      const int prevK =
+          (k == -d || (k != d && prev[i - 1] < prev[i + 1])) ? k + 1 : k - 1;
+      prevX = prev[prevK + maxD + 1];
+      prevY = prevX - prevK;
+    }
+    while (x > prevX && y > prevY) {
+      matches.emplace_back(--x, --y);
+    }
+    x = prevX;
+    y = prevY;
+  }
+  ::std::reverse(matches.begin(), matches.end());
+
+  // The ranges between matching lines are the edits
+  int lastA = 0, lastB = 0;
+  matches.emplace_back(n, m); // Sentinel
+  for (const auto &match : matches) {
+    if (match.first > lastA || match.second > lastB) {
+      appendEdit(edits, original, a[lastA], a[match.first], code, b[lastB],
+                 b[match.second]);
+    }
+    lastA = match.first + 1;
+    lastB = match.second + 1;
+  }
+  return edits;
+}
+
+::std::string chimera::mutant::applyEdits(const ::std::string &original,
+                                          const EditScript &edits) {
+  ::std::string code;
+  ::std::size_t pos = 0;
+  for (const Edit &edit : edits) {
+    code.append(original, pos, edit.offset - pos);
+    code.append(edit.replacement);
+    pos = edit.offset + edit.length;
+  }
+  code.append(original, pos, ::std::string::npos);
+  return code;
+}
+
+/// @brief If the edit \p a ends after the start of \p b, both sorted by offset
+/// @details Two insertions at the same offset don't overlap, see
+///          appendSorted().
+static bool overlaps(const Edit &a, const Edit &b) {
+  return a.offset + a.length > b.offset;
+}
+
+static bool editLess(const Edit &a, const Edit &b) {
+  return a.offset < b.offset || (a.offset == b.offset && a.length < b.length);
+}
+
+/// @brief Append \p edit to the sorted script \p edits, the insertions at the
+/// same offset are joined in order
+/// @return false if it overlaps the last edit
+static bool appendSorted(EditScript &edits, Edit &&edit) {
+  if (!edits.empty()) {
+    Edit &last = edits.back();
+    if (last.offset == edit.offset && last.length == 0 && edit.length == 0) {
+      last.replacement += edit.replacement;
+      return true;
+    }
+    if (overlaps(last, edit)) {
+      return false;
+    }
+  }
+  edits.push_back(::std::move(edit));
+  return true;
+}
+
+bool chimera::mutant::normalizeEdits(EditScript &edits) {
+  edits.erase(::std::remove_if(edits.begin(), edits.end(),
+                               [](const Edit &edit) {
+                                 return edit.length == 0 &&
+                                        edit.replacement.empty();
+                               }),
+              edits.end());
+  ::std::stable_sort(edits.begin(), edits.end(), editLess);
+  EditScript normalized;
+  normalized.reserve(edits.size());
+  for (Edit &edit : edits) {
+    if (!appendSorted(normalized, ::std::move(edit))) {
+      return false;
+    }
+  }
+  edits = ::std::move(normalized);
+  return true;
+}
+
+bool chimera::mutant::composeEdits(const EditScript &first,
+                                   const EditScript &second,
+                                   EditScript &composed) {
+  // Stable: at the same position the edits of first come before
+  EditScript merged;
+  merged.reserve(first.size() + second.size());
+  ::std::merge(first.begin(), first.end(), second.begin(), second.end(),
+               ::std::back_inserter(merged), editLess);
+  composed.clear();
+  composed.reserve(merged.size());
+  for (Edit &edit : merged) {
+    if (!appendSorted(composed, ::std::move(edit))) {
+      composed.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MutantDeltaWriter
+chimera::mutant::MutantDeltaWriter::MutantDeltaWriter(
+    const ::std::string &path, const ::std::string &filename,
+    const ::std::string &original)
+    : stream(path, ::std::ios::out | ::std::ios::binary | ::std::ios::trunc),
+      original(original) {
+  this->stream << deltaMagic << "\n"
+               << "target " << filename.size() << "\n"
+               << filename << "\n"
+               << "original " << original.size() << "\n"
+               << original << "\n";
+}
+
+chimera::mutant::MutantDeltaWriter::~MutantDeltaWriter() { this->close(); }
+
+bool chimera::mutant::MutantDeltaWriter::add(IdType id,
+                                             const ::std::string &code) {
+  return this->add(id, computeEdits(this->original, code));
+}
+
+bool chimera::mutant::MutantDeltaWriter::add(IdType id,
+                                             const EditScript &edits) {
+  // A second record of a mutant would be dead, the reader keeps the last one
+  if (!this->stream.is_open() || !this->ids.insert(id).second) {
+    return false;
+  }
+  this->index.emplace_back(id, this->stream.tellp());
+  this->stream << "mutant " << id << " " << edits.size() << "\n";
+  for (const Edit &edit : edits) {
+    this->stream << edit.offset << " " << edit.length << " "
+                 << edit.replacement.size() << "\n"
+                 << edit.replacement << "\n";
+  }
+  return this->stream.good();
+}
+
+bool chimera::mutant::MutantDeltaWriter::close() {
+  if (!this->stream.is_open()) {
+    return false;
+  }
+  const ::std::uint64_t indexOffset = this->stream.tellp();
+  this->stream << "index " << this->index.size() << "\n";
+  for (const auto &entry : this->index) {
+    this->stream << entry.first << " " << entry.second << "\n";
+  }
+  // Fixed size trailer, so that the reader finds the index from the end
+  char trailer[trailerSize + 1];
+  snprintf(trailer, sizeof(trailer), "%020llu\n",
+           static_cast<unsigned long long>(indexOffset));
+  this->stream << trailer;
+  const bool good = this->stream.good();
+  this->stream.close();
+  return good;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MutantDeltaReader
+
+/// @brief Read a "<tag> <length>\n<content>\n" block
+static bool readBlock(::std::istream &stream, const ::std::string &tag,
+                      ::std::string &content) {
+  ::std::string readTag;
+  ::std::size_t length;
+  if (!(stream >> readTag >> length) || readTag != tag ||
+      stream.get() != '\n') {
+    return false;
+  }
+  content.resize(length);
+  if (length > 0 && !stream.read(&content[0], length)) {
+    return false;
+  }
+  return stream.get() == '\n';
+}
+
+bool chimera::mutant::MutantDeltaReader::open(const ::std::string &path) {
+  this->index.clear();
+  if (this->stream.is_open()) {
+    this->stream.close();
+  }
+  this->stream.clear();
+  this->stream.open(path, ::std::ios::in | ::std::ios::binary);
+  ::std::string magic;
+  if (!this->stream || !::std::getline(this->stream, magic) ||
+      magic != deltaMagic) {
+    return false;
+  }
+  if (!readBlock(this->stream, "target", this->filename) ||
+      !readBlock(this->stream, "original", this->original)) {
+    return false;
+  }
+
+  // Locate the index through the trailer
+  this->stream.seekg(-static_cast<::std::streamoff>(trailerSize),
+                     ::std::ios::end);
+  ::std::uint64_t indexOffset;
+  if (!(this->stream >> indexOffset)) {
+    return false;
+  }
+  this->stream.seekg(indexOffset);
+  ::std::string tag;
+  ::std::size_t entries;
+  if (!(this->stream >> tag >> entries) || tag != "index") {
+    return false;
+  }
+  for (::std::size_t i = 0; i < entries; ++i) {
+    IdType id;
+    ::std::uint64_t offset;
+    if (!(this->stream >> id >> offset)) {
+      return false;
+    }
+    this->index[id] = offset;
+  }
+  return true;
+}
+
+::std::vector<IdType> chimera::mutant::MutantDeltaReader::getMutantIds() const {
+  ::std::vector<IdType> ids;
+  for (const auto &entry : this->index) {
+    ids.push_back(entry.first);
+  }
+  return ids;
+}
+
+bool chimera::mutant::MutantDeltaReader::getEdits(IdType id,
+                                                  EditScript &edits) {
+  auto entry = this->index.find(id);
+  if (entry == this->index.end()) {
+    return false;
+  }
+  this->stream.clear();
+  this->stream.seekg(entry->second);
+  ::std::string tag;
+  IdType readId;
+  ::std::size_t size;
+  if (!(this->stream >> tag >> readId >> size) || tag != "mutant" ||
+      readId != id || this->stream.get() != '\n') {
+    return false;
+  }
+  edits.clear();
+  ::std::size_t end = 0;
+  for (::std::size_t i = 0; i < size; ++i) {
+    Edit edit;
+    ::std::size_t length;
+    if (!(this->stream >> edit.offset >> edit.length >> length) ||
+        this->stream.get() != '\n') {
+      return false;
+    }
+    edit.replacement.resize(length);
+    if (length > 0 && !this->stream.read(&edit.replacement[0], length)) {
+      return false;
+    }
+    // The edits must be sorted and inside the original
+    if (this->stream.get() != '\n' || edit.offset < end ||
+        edit.offset + edit.length > this->original.size()) {
+      return false;
+    }
+    end = edit.offset + edit.length;
+    edits.push_back(::std::move(edit));
+  }
+  return true;
+}
+
+bool chimera::mutant::MutantDeltaReader::materialize(IdType id,
+                                                     ::std::string &code) {
+  EditScript edits;
+  if (!this->getEdits(id, edits)) {
+    return false;
+  }
+  code = applyEdits(this->original, edits);
+  return true;
+}
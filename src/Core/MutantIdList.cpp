@@ -0,0 +1,69 @@
+//===- MutantIdList.cpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantIdList.cpp
+/// \brief This file implements the class MutantIdList
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantIdList.h"
+
+#include "llvm/ADT/SmallVector.h"
+
+bool chimera::mutant::MutantIdList::parse(::llvm::StringRef list,
+                                          MutantIdList &ids) {
+  ids.ranges.clear();
+  ::llvm::SmallVector<::llvm::StringRef, 8> items;
+  list.split(items, ',', -1, false);
+  for (::llvm::StringRef item : items) {
+    ::std::pair<::llvm::StringRef, ::llvm::StringRef> range = item.split('-');
+    IdType first, last;
+    if (range.first.trim().getAsInteger(10, first)) {
+      return false;
+    }
+    last = first;
+    if ((!range.second.empty() &&
+         range.second.trim().getAsInteger(10, last)) ||
+        last < first) {
+      return false;
+    }
+    ids.ranges.push_back(::std::make_pair(first, last));
+  }
+  return true;
+}
+
+bool chimera::mutant::MutantIdList::contains(IdType id) const {
+  for (const auto &range : this->ranges) {
+    if (range.first <= id && id <= range.second) {
+      return true;
+    }
+  }
+  return false;
+}
+
+::std::vector<chimera::mutant::IdType> chimera::mutant::MutantIdList::select(
+    const ::std::vector<IdType> &existing) const {
+  ::std::vector<IdType> selected;
+  for (IdType id : existing) {
+    if (this->contains(id)) {
+      selected.push_back(id);
+    }
+  }
+  return selected;
+}
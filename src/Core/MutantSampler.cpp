@@ -0,0 +1,174 @@
+//===- MutantSampler.cpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantSampler.cpp
+/// \brief This file implements the class MutantSampler
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantSampler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+chimera::MutantSampler::MutantSampler(const MutantBudget &budget,
+                                      SamplingStrategy strategy, unsigned seed,
+                                      unsigned regionLines,
+                                      const MutantShard &shard,
+                                      const ::std::string &target)
+    : budget(budget), strategy(strategy), seed(seed),
+      regionLines(regionLines > 0 ? regionLines : 1), shard(shard),
+      target(target) {}
+
+::std::string
+chimera::MutantSampler::stratumOf(const Candidate &candidate) const {
+  switch (this->strategy) {
+  case SamplingStrategy::ByFunction:
+    return candidate.functionName;
+  case SamplingStrategy::ByMutator:
+    return candidate.mutatorId;
+  case SamplingStrategy::ByRegion:
+    return "lines " +
+           ::std::to_string(candidate.line / this->regionLines *
+                                this->regionLines) +
+           "+";
+  case SamplingStrategy::Uniform:
+  default:
+    return "all";
+  }
+}
+
+::std::size_t chimera::MutantSampler::add(const Candidate &candidate,
+                                          bool isHom) {
+  const ::std::size_t first = this->units.size();
+  const ::std::string stratum = this->stratumOf(candidate);
+  for (unsigned type = 0; type < candidate.mutations; ++type) {
+    Unit unit;
+    unit.stratum = stratum;
+    unit.operatorId = candidate.operatorId;
+    unit.functionName = candidate.functionName;
+    unit.mutatorType = candidate.mutatorId + "#" + ::std::to_string(type);
+    unit.cell = unit.stratum + "|" + unit.operatorId + "|" +
+                unit.functionName + "|" + unit.mutatorType;
+    unit.selected = false;
+    unit.owned = owns(this->shard, this->target, candidate, type, isHom);
+    ++this->cellSizes[unit.cell];
+    this->units.push_back(::std::move(unit));
+  }
+  return first;
+}
+
+bool chimera::MutantSampler::owns(const MutantShard &shard,
+                                  const ::std::string &target,
+                                  const Candidate &candidate, unsigned type,
+                                  bool isHom) {
+  // A HOM mutant is never split among the shards
+  return shard.owns(
+      isHom ? MutantShard::getHomKey(target, candidate.operatorId)
+            : MutantShard::getKey(target, candidate.functionName,
+                                  candidate.line, candidate.column,
+                                  candidate.mutatorId + "#" +
+                                      ::std::to_string(type)));
+}
+
+::std::map<::std::string, ::std::size_t> chimera::MutantSampler::allot(
+    const ::std::map<::std::string, ::std::size_t> &sizes) const {
+  ::std::map<::std::string, ::std::size_t> quotas;
+  const ::std::size_t total = this->units.size();
+  if (this->budget.maxMutants == 0 || this->budget.maxMutants >= total) {
+    return sizes;
+  }
+  // Proportional share, the remainders decide the leftover mutants
+  ::std::vector<::std::pair<::std::size_t, ::std::string>> remainders;
+  ::std::size_t allotted = 0;
+  for (const auto &size : sizes) {
+    const ::std::size_t share = size.second * this->budget.maxMutants;
+    quotas[size.first] = share / total;
+    allotted += share / total;
+    remainders.push_back(::std::make_pair(share % total, size.first));
+  }
+  ::std::stable_sort(
+      remainders.begin(), remainders.end(),
+      [](const ::std::pair<::std::size_t, ::std::string> &a,
+         const ::std::pair<::std::size_t, ::std::string> &b) {
+        return a.first > b.first;
+      });
+  for (::std::size_t i = 0; allotted < this->budget.maxMutants; ++i) {
+    ++quotas[remainders[i].second];
+    ++allotted;
+  }
+  return quotas;
+}
+
+void chimera::MutantSampler::sample() {
+  ::std::map<::std::string, ::std::size_t> sizes;
+  for (const Unit &unit : this->units) {
+    ++sizes[unit.stratum];
+  }
+  ::std::map<::std::string, ::std::size_t> quotas = this->allot(sizes);
+
+  // Seeded random order, so that each cell is sampled uniformly
+  ::std::vector<::std::size_t> order(this->units.size());
+  ::std::iota(order.begin(), order.end(), 0);
+  // Fisher-Yates on the raw mt19937 output, ::std::shuffle and the
+  // distributions are implementation-defined
+  ::std::mt19937 generator(this->seed);
+  for (::std::size_t i = order.size(); i > 1; --i) {
+    ::std::swap(order[i - 1], order[generator() % i]);
+  }
+
+  ::std::map<::std::string, ::std::size_t> perOperator, perFunction,
+      perMutatorType;
+  auto fits = [](::std::size_t limit, ::std::size_t used) {
+    return limit == 0 || used < limit;
+  };
+  for (::std::size_t index : order) {
+    Unit &unit = this->units[index];
+    if (quotas[unit.stratum] == 0 ||
+        !fits(this->budget.perOperator, perOperator[unit.operatorId]) ||
+        !fits(this->budget.perFunction, perFunction[unit.functionName]) ||
+        !fits(this->budget.perMutatorType,
+              perMutatorType[unit.mutatorType])) {
+      continue;
+    }
+    unit.selected = true;
+    --quotas[unit.stratum];
+    ++perOperator[unit.operatorId];
+    ++perFunction[unit.functionName];
+    ++perMutatorType[unit.mutatorType];
+    ++this->cellSelected[unit.cell];
+  }
+}
+
+bool chimera::MutantSampler::isAnySelected(::std::size_t first,
+                                           ::std::size_t count) const {
+  for (::std::size_t i = first; i < first + count; ++i) {
+    if (this->isSelected(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+double chimera::MutantSampler::getWeight(::std::size_t index) const {
+  const ::std::string &cell = this->units[index].cell;
+  return static_cast<double>(this->cellSizes.at(cell)) /
+         this->cellSelected.at(cell);
+}
@@ -0,0 +1,156 @@
+//===- MutantSchemata.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantSchemata.cpp
+/// \brief This file implements the class MutantSchemata
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantSchemata.h"
+#include "Core/DeferredMutant.h"
+
+#include <algorithm>
+
+using namespace chimera::mutant;
+
+/// @brief Declarations prepended to the schemata, C and C++ compatible
+static const char *schemataPrelude =
+    "/* Mutant schemata generated by Clang-Chimera: set CHIMERA_MUTANT_ID to "
+    "select a mutant, 0 selects the original code */\n"
+    "#include <stdlib.h>\n"
+    "static long chimera_mutant_id(void) {\n"
+    "  static long id = -1;\n"
+    "  if (id < 0) {\n"
+    "    const char *value = getenv(\"CHIMERA_MUTANT_ID\");\n"
+    "    id = value != NULL ? atol(value) : 0;\n"
+    "  }\n"
+    "  return id;\n"
+    "}\n";
+
+chimera::mutant::MutantSchemata::MutantSchemata(const ::std::string &original,
+                                                const ::std::string &filename)
+    : original(original), filename(filename) {}
+
+bool chimera::mutant::MutantSchemata::addMutant(IdType id,
+                                                const ::std::string &code,
+                                                ::std::size_t siteStart,
+                                                ::std::size_t siteEnd) {
+  if (siteStart >= siteEnd || siteEnd > this->original.size()) {
+    return false;
+  }
+  // The changes must lie within the site
+  const ::std::size_t minSize = ::std::min(this->original.size(), code.size());
+  ::std::size_t prefix = 0;
+  while (prefix < minSize && this->original[prefix] == code[prefix]) {
+    ++prefix;
+  }
+  ::std::size_t suffix = 0;
+  while (suffix < minSize - prefix &&
+         this->original[this->original.size() - 1 - suffix] ==
+             code[code.size() - 1 - suffix]) {
+    ++suffix;
+  }
+  if (prefix == minSize && this->original.size() == code.size()) {
+    return false; // Nothing to guard
+  }
+  if (prefix < siteStart || this->original.size() - suffix > siteEnd) {
+    return false;
+  }
+  ::std::string text = code.substr(
+      siteStart, siteEnd - siteStart + code.size() - this->original.size());
+
+  // Same site: chain it, otherwise it must not overlap the others
+  auto site = ::std::lower_bound(
+      this->sites.begin(), this->sites.end(), siteStart,
+      [](const Site &s, ::std::size_t start) { return s.start < start; });
+  if (site != this->sites.end() && site->start == siteStart &&
+      site->end == siteEnd) {
+    site->mutants.push_back(::std::make_pair(id, ::std::move(text)));
+    return true;
+  }
+  if ((site != this->sites.end() && site->start < siteEnd) ||
+      (site != this->sites.begin() && (site - 1)->end > siteStart)) {
+    return false;
+  }
+  Site newSite;
+  newSite.start = siteStart;
+  newSite.end = siteEnd;
+  newSite.mutants.push_back(::std::make_pair(id, ::std::move(text)));
+  this->sites.insert(site, ::std::move(newSite));
+  return true;
+}
+
+::std::string
+chimera::mutant::MutantSchemata::render(const ::std::vector<bool> &selected,
+                                        bool dense) const {
+  ::std::string code = schemataPrelude;
+  code += "#line 1 \"" + this->filename + "\"\n";
+  IdType selector = 0;
+  ::std::size_t position = 0;
+  for (::std::size_t i = 0; i < this->sites.size(); ++i) {
+    if (!selected[i]) {
+      continue;
+    }
+    const Site &site = this->sites[i];
+    code.append(this->original, position, site.start - position);
+    code += "(";
+    for (const auto &mutant : site.mutants) {
+      selector = dense ? selector + 1 : mutant.first;
+      code += "chimera_mutant_id() == " + ::std::to_string(selector) + " ? (" +
+              mutant.second + ") : ";
+    }
+    code += "(";
+    code.append(this->original, site.start, site.end - site.start);
+    code += "))";
+    position = site.end;
+  }
+  code.append(this->original, position, ::std::string::npos);
+  return code;
+}
+
+::std::string chimera::mutant::MutantSchemata::build(
+    const CheckFunction &check, ::std::vector<IdType> &selectors,
+    ::std::vector<IdType> &dropped) const {
+  const ::std::vector<bool> selected = bisectSelection(
+      this->sites.size(), [this, &check](const ::std::vector<bool> &sites) {
+        return check(this->render(sites, false));
+      });
+  selectors.clear();
+  dropped.clear();
+  for (::std::size_t i = 0; i < this->sites.size(); ++i) {
+    for (const auto &mutant : this->sites[i].mutants) {
+      (selected[i] ? selectors : dropped).push_back(mutant.first);
+    }
+  }
+  // Same code, with selectors numbered from 1
+  return this->render(selected, true);
+}
+
+::std::string
+chimera::mutant::MutantSchemata::getMutantCode(IdType id) const {
+  for (const Site &site : this->sites) {
+    for (const auto &mutant : site.mutants) {
+      if (mutant.first == id) {
+        return this->original.substr(0, site.start) + mutant.second +
+               this->original.substr(site.end);
+      }
+    }
+  }
+  return this->original;
+}
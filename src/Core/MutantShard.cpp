@@ -0,0 +1,60 @@
+//===- MutantShard.cpp ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantShard.cpp
+/// \brief This file implements the class MutantShard
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantShard.h"
+
+#include "llvm/Support/MD5.h"
+
+#include <cstdint>
+
+bool chimera::MutantShard::parse(::llvm::StringRef spec, MutantShard &shard) {
+  ::std::pair<::llvm::StringRef, ::llvm::StringRef> parts = spec.split('/');
+  unsigned index, count;
+  if (parts.first.getAsInteger(10, index) ||
+      parts.second.getAsInteger(10, count) || count == 0 || index >= count) {
+    return false;
+  }
+  shard = MutantShard(index, count);
+  return true;
+}
+
+bool chimera::MutantShard::owns(::llvm::StringRef key) const {
+  if (!this->isSharded()) {
+    return true;
+  }
+  return hash(key) % this->count == this->index;
+}
+
+::std::uint64_t chimera::MutantShard::hash(::llvm::StringRef key) {
+  // Unlike ::std::hash
+  ::llvm::MD5 md5;
+  md5.update(key);
+  ::llvm::MD5::MD5Result result;
+  md5.final(result);
+  ::std::uint64_t value = 0;
+  for (unsigned i = 0; i < 8; ++i) {
+    value = (value << 8) | result[i];
+  }
+  return value;
+}
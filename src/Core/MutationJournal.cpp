@@ -0,0 +1,109 @@
+//===- MutationJournal.cpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutationJournal.cpp
+/// \brief This file implements the class MutationJournal
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutationJournal.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+bool chimera::MutationJournal::open(const ::std::string &path, bool resume) {
+  this->entries.clear();
+  this->checks.clear();
+  if (resume) {
+    ::std::ifstream input(path);
+    ::std::string line;
+    while (::std::getline(input, line)) {
+      // The key is the last field, it may contain commas
+      ::llvm::SmallVector<::llvm::StringRef, 4> fields;
+      ::llvm::StringRef(line).split(fields, ',', 3);
+      if (fields.size() == 3 && fields[0] == "check" &&
+          (fields[1] == "0" || fields[1] == "1")) {
+        this->checks[fields[2].str()] = fields[1] == "1";
+        continue;
+      }
+      ::std::size_t ordinal;
+      unsigned valid;
+      Entry entry;
+      if (fields.size() != 4 || fields[0].getAsInteger(10, ordinal) ||
+          fields[1].getAsInteger(10, valid) ||
+          fields[2].getAsInteger(10, entry.id)) {
+        continue; // e.g. the last line, cut by the interruption
+      }
+      entry.valid = valid != 0;
+      entry.key = fields[3].str();
+      this->entries[ordinal] = ::std::move(entry);
+    }
+  }
+  this->stream.open(path, resume ? ::std::ios::app : ::std::ios::trunc);
+  return this->stream.is_open();
+}
+
+bool chimera::MutationJournal::lookup(::std::size_t ordinal,
+                                      const ::std::string &key, bool &valid,
+                                      mutant::IdType &id) const {
+  auto entry = this->entries.find(ordinal);
+  if (entry == this->entries.end() || entry->second.key != key) {
+    return false;
+  }
+  valid = entry->second.valid;
+  id = entry->second.id;
+  return true;
+}
+
+void chimera::MutationJournal::record(::std::size_t ordinal,
+                                      const ::std::string &key, bool valid,
+                                      mutant::IdType id) {
+  if (!this->isOpen()) {
+    return;
+  }
+  // Flushed, it has to survive a crash
+  this->stream << ordinal << "," << (valid ? 1 : 0) << "," << id << "," << key
+               << std::endl;
+}
+
+bool chimera::MutationJournal::lookupCheck(const ::std::string &key,
+                                           bool &valid) const {
+  auto check = this->checks.find(key);
+  if (check == this->checks.end()) {
+    return false;
+  }
+  valid = check->second;
+  return true;
+}
+
+void chimera::MutationJournal::recordCheck(const ::std::string &key,
+                                           bool valid) {
+  if (!this->isOpen()) {
+    return;
+  }
+  this->stream << "check," << (valid ? 1 : 0) << "," << key << std::endl;
+}
+
+void chimera::MutationJournal::close() {
+  if (this->stream.is_open()) {
+    this->stream.close();
+  }
+  this->entries.clear();
+  this->checks.clear();
+}
@@ -26,14 +26,28 @@
 //===----------------------------------------------------------------------===//
 
 #include "Core/MutationTemplate.h"
-#include "Tooling/FrontendActions.h"
 #include "Tooling/CompilationDatabaseUtils.h"
-
+#include "Core/BinaryOperatorMatcher.h"
+#include "Core/DeferredMutant.h"
+#include "Core/FunctionSelector.h"
+#include "Core/MutantCombiner.h"
+#include "Core/MutantSampler.h"
+#include "Core/MutantSchemata.h"
+#include "Tooling/MutantValidator.h"
+#include "Tooling/ValidationPool.h"
+
+#include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 #include <algorithm>
+#include <deque>
+#include <future>
+#include <map>
 
 using namespace clang;
 using namespace clang::tooling;
@@ -45,119 +59,252 @@ using namespace chimera::log;
 
 #define DEBUG_TYPE "mutation_template"
 
-static mutant::IdType mutantCounterInitial = 1;
+static const mutant::IdType mutantCounterInitial = 1;
+
+namespace clang {
+namespace ast_matchers {
+/// @brief Matches the functions selected for an operator
+AST_MATCHER_P2(FunctionDecl, isSelectedBy, const chimera::FunctionSelector *,
+               selector, chimera::m_operator::IdType, operatorId) {
+  return selector->isSelected(Node, operatorId);
+}
+
+/// @brief Matches the functions selected for at least one of the operators
+AST_MATCHER_P2(FunctionDecl, isSelectedByAny, const chimera::FunctionSelector *,
+               selector, ::std::vector<chimera::m_operator::IdType>,
+               operatorIds) {
+  for (const chimera::m_operator::IdType &operatorId : operatorIds) {
+    if (selector->isSelected(Node, operatorId)) {
+      return true;
+    }
+  }
+  return false;
+}
+} // end namespace ast_matchers
+} // end namespace clang
 
 
 // FIXME: When a function name is not found -> LLVM IO ERROR.
 
+
+class MutatorMatcherCallback;
+
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief    This class manages the creation and deletion of rewriter objects
-/// @details  It works with a reservation mechanism:
-///            - a slot can be reserved, when the slot is required a rewriter is
-///            (eventually created and)
-///              returned,
-///            - if the slot doesn't exist a local over-writtable slot is used.
-///            The max number of local
-///              slots is given by \tparam localSlots, the max pallelisms in
-///              using the Rewriters managed by this
-///              class.
-/// @tparam   ContentType It must have a ctor without arguments
-/// FIXME Generalize it
-template <typename IdType, typename ContentType, int localSlots = 1>
-class SlotManager {
-  using RewriterPtr =
-      ::std::unique_ptr<Rewriter>; ///< Rewriter pointer abstraction
-  using SlotType = ::std::unique_ptr<ContentType>;
+/// @brief What is needed to report a single mutation
+struct MutationRecord {
+  MutatorMatcherCallback *callback; ///< Callback that applied the mutation
+  bool nodeIsValid;                 ///< If the report entry can be created
+  ::std::string functionName;       ///< Name of the mutated function
+  SourceLocation location;          ///< Location of the matched node
+  MutatorType type;                 ///< Applied mutation type
+  bool hasSite;                     ///< If the matched node is an expression
+  unsigned siteStart;               ///< Offset of the matched expression
+  unsigned siteEnd;                 ///< Offset past the matched expression
+  bool hasCandidate;                ///< If sampled or sharded
+  ::std::size_t candidate;          ///< Index among the candidate mutations
+  ::std::size_t ordinal;            ///< Position in the journal
+  ::std::string journalKey;         ///< Key in the journal
+  bool isJournaled;                 ///< If the verdict is the journaled one
+  mutant::IdType journaledId;       ///< Journaled id, if journaled as valid
+};
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief A coarse grain match, recorded during the AST traversal
+/// @details The AST outlives the traversal, up to the end of the translation
+///          unit, so the bound nodes are still valid in the second phase.
+struct MatchRecord {
+  MatchRecord(MutatorMatcherCallback *callback,
+              const MatchFinder::MatchResult &result)
+      : callback(callback), nodes(result.Nodes), context(result.Context),
+        nodeIsValid(false), isCandidate(false), candidate(0) {}
+  MutatorMatcherCallback *callback;      ///< Callback of the matching mutator
+  BoundNodes nodes;                      ///< Nodes bound by the matcher
+  ASTContext *context;                   ///< Context of the bound nodes
+  ast_type_traits::DynTypedNode node;    ///< The matched node, if valid
+  bool nodeIsValid;                      ///< If the mutator found the node
+  SourceRange range;                     ///< Range of the matched node
+  bool isCandidate;            ///< If it passed the fine grain matching
+  ::std::size_t candidate;     ///< Index of its first candidate mutation
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief The matches of a target, in traversal order
+/// @details The traversal only records the matches (first phase), the fine
+///          grain matching, the mutation and the validation are scheduled
+///          afterwards over this list (second phase). Processing the records
+///          in traversal order, every mutator sees the same sequence of
+///          match/mutate calls as when they were interleaved with the
+///          traversal.
+class chimera::MatchWorkList {
 public:
-  SlotManager() {}
-
-  /// @brief Try to reserve a slot, eg if you knew you're going to use it
-  /// @param toReserve Which slot should be reserved
-  /// @return bool If the reservation succeeds
-  bool reserve(IdType toReserve) {
-    auto retval = this->slots.insert(std::pair<IdType, SlotType>(
-        toReserve, ::std::unique_ptr<ContentType>(nullptr)));
-    DEBUG(::llvm::dbgs() << "Reserving id:" << toReserve
-                         << ".Operation: " << retval.second << "\n");
-    return retval.second;
-  }
-
-  /// @brief Set a slot, differs from reserve because it also fills the slot
-  /// @param toReserve Which slot should be reserved
-  /// @param content The content of the slot
-  /// @return bool If the reservation succeeds
-  bool setSlot(IdType toReserve, const ContentType &content) {
-    auto retval = this->slots.insert(std::pair<IdType, SlotType>(
-        toReserve, ::std::unique_ptr<ContentType>(new ContentType(content))));
-    return retval.second;
-  }
-
-  /// @brief Try to reserve a slot using the local slot if it is valid.
-  /// @return bool If the reservation succeeds
-  bool reserveLocalSlot() {
-    // Check localSlot
-    if (this->localSlot.second) {
-      auto retval = this->slots.insert(::std::move(localSlot));
-      return retval.second;
-    }
-    return false;
+  void push(MatchRecord &&record) {
+    this->records.push_back(::std::move(record));
   }
 
-  /// @brief Try to release a previously reserved slot
-  /// @param toRelease
-  /// @return bool If the release succeeds
-  bool release(IdType toRelease) { return this->slots.erase(toRelease) == 1; }
+  ::std::vector<MatchRecord> &getRecords() { return this->records; }
 
-  /// @brief Retrieve a reserved slot if exists
-  /// @param slotId
-  /// @param content
-  /// @return bool If it exist
-  bool getReservedSlot(IdType slotId, ContentType &content) {
-    try {
-      content = *(this->slots.at(slotId));
-      return true;
-    } catch (const std::out_of_range &oor) { // Not present
-      return false;
+  /// @brief Run the second phase on all the records, then empty the list
+  /// @param sampler If not null, it selects the mutations to apply, once
+  ///        all the candidates have been added to it
+  void process(MutantSampler *sampler);
+
+private:
+  ::std::vector<MatchRecord> records;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Outcome of a FOM mutant, shared with the identical ones that follow
+struct CanonicalMutant {
+  CanonicalMutant() : id(0), valid(false) {}
+  mutant::IdType id; ///< Assigned once resolved
+  bool valid;        ///< Verdict, meaningful once resolved
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief A mutant whose verdict is still owed by the validation pool
+/// @details The mutant id is assigned only when the verdict is consumed, since
+///          the counter advances on valid mutants only.
+///          A duplicate is never checked: it takes the verdict of its
+///          canonical mutant, submitted (and so resolved) before it.
+struct PendingMutant {
+  PendingMutant() : isDuplicate(false), isSampled(false) {}
+  MutationRecord mutation;     ///< The mutation that generated the mutant
+  ::std::future<bool> verdict; ///< Verdict of the syntax check
+  ::std::string code;          ///< Snapshot of the mutated main file
+  mutant::EditScript edits;    ///< Edits on the original, if built from them
+  ::std::shared_ptr<CanonicalMutant> canonical; ///< Set if deduplicated
+  bool isDuplicate; ///< If canonical refers to an earlier mutant
+  bool isSampled;   ///< If checked as a sample of a trusted mutator
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Mutants of a target waiting for their verdict, in submission order
+class chimera::PendingMutantQueue {
+public:
+  /// @param homOrder Highest order of the combinations of the valid FOM
+  ///        mutants, below 2 they are not combined
+  /// @param homBudget Maximum number of combinations
+  /// @param journal The journal of the target, for the checks of the deferred
+  ///        HOM mutants, the combinations and the mutant schemata
+  PendingMutantQueue(unsigned homOrder, ::std::size_t homBudget,
+                     MutationJournal &journal)
+      : journal(journal), schemataCallback(nullptr) {
+    if (homOrder >= 2) {
+      this->combiner.reset(new mutant::MutantCombiner(homOrder, homBudget));
     }
   }
 
-  /// @brief It creates the content of a slot, of a local one if wasn't reserved
-  /// or of the reserved one.
-  ///        If the content of the reserved slot already exist, it returns it.
-  /// @param mngr
-  /// @param lang
-  /// @param wasReserved If the slot was reserved
-  /// @return Rewriter A rewriter
-  template <typename... Args>
-  ContentType &getSlot(IdType slot, bool &wasReserved, Args &&... args) {
-    wasReserved = true;
-    try {
-      // Try to access the object, seeing if manages an object
-      if (!this->slots.at(slot)) {
-        // Create one
-        this->slots.at(slot)
-            .reset(new ContentType(::std::forward<Args>(args)...));
-      }
+  void push(PendingMutant &&pending) {
+    this->mutants.push_back(::std::move(pending));
+  }
 
-      return *(this->slots.at(slot));
-    } catch (const std::out_of_range &oor) {
-      wasReserved = false;
-      // Renew the localSlot
-      localSlot.first = slot;
-      localSlot.second.reset(new ContentType(::std::forward<Args>(args)...));
-      return *localSlot.second;
-    }
+  /// @brief Consume the verdicts, in submission order, until no more than
+  /// \p maxPending mutants are left pending
+  void resolve(::std::size_t maxPending);
+
+  /// @brief Look for an identical mutant among the ones already submitted
+  /// @details The mutants are identified by a 128 bits hash of their content
+  ///          and of the compile commands of their mutator.
+  /// @param code The whole mutated content of the target
+  /// @param additionalCommands Compile commands of the mutator
+  /// @param isDuplicate Set if an identical mutant has been found
+  /// @return The outcome of the identical mutant, or a new one to fill
+  ::std::shared_ptr<CanonicalMutant>
+  identify(const ::std::string &code,
+           const ::std::vector<::std::string> &additionalCommands,
+           bool &isDuplicate);
+
+  /// @brief Record a mutation of a HOM mutant, whose check is deferred to the
+  /// end of the translation unit
+  /// @param id The reserved id of the HOM mutant
+  /// @param mutation The applied mutation
+  /// @param original The content of the target before any mutation
+  /// @param code The whole mutated content after the mutation
+  /// @param additionalCommands Compile commands of the mutator
+  void defer(mutant::IdType id, MutationRecord &&mutation,
+             ::llvm::StringRef original, const ::std::string &code,
+             const ::std::vector<::std::string> &additionalCommands);
+
+  /// @brief Try to guard a valid FOM mutant in the mutant schemata
+  /// @param id The mutant id
+  /// @param mutation The mutation, it must have a site
+  /// @param original The content of the target
+  /// @param code The whole mutated content of the target
+  /// @param additionalCommands Compile commands of the mutator
+  /// @return If the mutant is part of the schemata, thus it has not to be
+  ///         saved on its own
+  bool guard(mutant::IdType id, const MutationRecord &mutation,
+             ::llvm::StringRef original, const ::std::string &code,
+             const ::std::vector<::std::string> &additionalCommands);
+
+  /// @brief Record a valid FOM mutant as a parent of the combinations
+  /// @param id The mutant id
+  /// @param pending The mutant, its edits are computed if it has none
+  /// @param original The content of the target
+  void addFirstOrder(mutant::IdType id, const PendingMutant &pending,
+                     ::llvm::StringRef original);
+
+  /// @brief Keep the content of a valid HOM mutant, saved once at the end of
+  /// the translation unit: each mutation replaces the previous content
+  /// @param id The reserved id of the HOM mutant
+  /// @param callback The callback saving it
+  /// @param code The whole mutated content after the mutation
+  void keepHom(mutant::IdType id, MutatorMatcherCallback *callback,
+               const ::std::string &code) {
+    this->homs[id] = ::std::make_pair(callback, code);
   }
 
+  /// @brief Consume all the verdicts, the deferred mutants included, and
+  /// eventually save the combinations and the mutant schemata
+  void finish(ValidationPool &pool);
+
 private:
-  // Each rewriter is associated with a key, in this case the mutantId
-  ::std::map<IdType, SlotType> slots;
-  ::std::pair<IdType, SlotType> localSlot; // Local slot
+  /// @brief Check the combinations of the FOM mutants, then report and save
+  /// the valid ones
+  void combine(ValidationPool &pool);
+
+  /// @brief A HOM mutant validated once, at the end of the translation unit
+  struct DeferredHomMutant {
+    explicit DeferredHomMutant(const ::std::string &original)
+        : mutant(original) {}
+    mutant::DeferredMutant mutant;
+    ::std::vector<MutationRecord> mutations; ///< By mutation index
+    ::std::vector<::std::string> commands;   ///< Union of the mutators' ones
+  };
+
+  /// @brief Append the commands not already present
+  static void mergeCommands(::std::vector<::std::string> &commands,
+                            const ::std::vector<::std::string> &toAdd);
+
+  /// @brief Submit the check of a whole content, a journaled verdict is
+  /// ready at once
+  /// @param key Set to the key of the check in the journal, if open
+  /// @param journaled Set if the verdict is the journaled one, otherwise it
+  ///        has to be recorded once consumed
+  ::std::future<bool> submit(ValidationPool &pool, const ::std::string &code,
+                             const ::std::vector<::std::string> &commands,
+                             ::std::string &key, bool &journaled);
+
+  /// @brief Check a whole content, journaling the verdict
+  bool check(ValidationPool &pool, const ::std::string &code,
+             const ::std::vector<::std::string> &commands);
+
+  MutationJournal &journal;
+  ::std::deque<PendingMutant> mutants;
+  ::std::map<::std::string, ::std::shared_ptr<CanonicalMutant>>
+      canonicals; ///< By content hash
+  ::std::map<mutant::IdType, ::std::unique_ptr<DeferredHomMutant>> deferred;
+  ::std::map<mutant::IdType,
+             ::std::pair<MutatorMatcherCallback *, ::std::string>>
+      homs; ///< Latest valid content of the HOM mutants, to save
+  ::std::unique_ptr<mutant::MutantSchemata> schemata;
+  ::std::vector<::std::string> schemataCommands; ///< Union of the mutators'
+  MutatorMatcherCallback *schemataCallback;      ///< Callback saving it
+  ::std::unique_ptr<mutant::MutantCombiner> combiner; ///< If combining
+  ::std::map<mutant::IdType, MutationRecord> parents; ///< Of the combiner
+  ::std::string original; ///< Target content, for the combinations
 };
 
-static SlotManager<mutant::IdType, Rewriter> rwManager;
-
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief MatchCallback child : The callback called for the mutator's matchers
 class MutatorMatcherCallback : public MatchFinder::MatchCallback {
@@ -166,12 +313,22 @@ public:
    * @brief Constructor, save a pointer to the MutationTemplate from which it
    * has been created
    */
-  MutatorMatcherCallback(MutationTemplate &mutTempl, MutatorPtr mutator,
-                         mutant::IdType staticId = 0,
-                         std::string tempDirName = "temp")
-      : MatchCallback(), mutationTemplate(mutTempl), mutator(mutator),
-        sourceManager(nullptr), context(nullptr), localMutantId(staticId),
-        tempDirName(tempDirName) {}
+  MutatorMatcherCallback(MutationTemplate &mutTempl,
+                         const m_operator::IdType &operatorId,
+                         MutatorPtr mutator, mutant::IdType staticId = 0)
+      : MatchCallback(), mutationTemplate(mutTempl), operatorId(operatorId),
+        mutator(mutator), sourceManager(nullptr), context(nullptr),
+        localMutantId(staticId),
+        timeScope({mutTempl.getTimeScope().file, operatorId,
+                   mutator->getIdentifier()}) {}
+
+  /// @brief Add to a counter of the mutator, if the time report is enabled
+  void count(TimeCounter counter, ::std::uint64_t value = 1) {
+    if (this->mutationTemplate.getTimeReport() != nullptr) {
+      this->mutationTemplate.getTimeReport()->addCount(this->timeScope,
+                                                       counter, value);
+    }
+  }
 
   /// @brief Set the local pointer to the source manager
   /// @param manager A pointer to the source manager
@@ -208,14 +365,20 @@ public:
   ///          If the mutant fails some step, the value is set back to default,
   ///          until at least one mutations succeeds
   Rewriter &initializeMutant(mutant::IdType &id) {
-    id = this->localMutantId;
-    if (id == 0) {
+    id = this->getMutantId();
+    bool wasReserved;
+    return this->mutationTemplate.getRewriterSlots().getSlot(
+        id, wasReserved, *(this->sourceManager), this->context->getLangOpts());
+  }
+
+  /// @brief Return the id of the next mutant of this callback
+  /// @details The reserved one for a HOM mutator, otherwise the mutant counter
+  mutant::IdType getMutantId() const {
+    if (this->localMutantId == 0) {
       // As for the FOM mutator
-      id = this->mutationTemplate.mutantCounter;
+      return this->mutationTemplate.mutantCounter;
     }
-    bool wasReserved;
-    return rwManager.getSlot(id, wasReserved, *(this->sourceManager),
-                             this->context->getLangOpts());
+    return this->localMutantId;
   }
 
   /// @brief Called when a mutant has been created, it finalizes the used
@@ -231,7 +394,7 @@ public:
         // If the localMutantId was 0, it has to be set and ...
         this->localMutantId = this->mutationTemplate.mutantCounter++;
         // ... the rewriter reserved
-        rwManager.reserveLocalSlot();
+        this->mutationTemplate.getRewriterSlots().reserveLocalSlot();
       }
     } else
       // FOM, increment and do nothing
@@ -245,98 +408,464 @@ public:
   ///          this functions shouldn't be called.
   ///          It works with both FOM and HOM mutators.
   /// @param Result MatchResult object
-  void applyMutations(const MatchFinder::MatchResult &Result) {
+  /// @param record The recorded match, with the matched node
+  void applyMutations(const MatchFinder::MatchResult &Result,
+                      const MatchRecord &record) {
     // Local variables
     mutant::IdType mutantId; // Mutant Id
-    ::clang::ast_type_traits::DynTypedNode
-        matchedNode; // It will contain the matched node
+    const ::clang::ast_type_traits::DynTypedNode &matchedNode = record.node;
     // Matched node validty
-    bool nodeIsValid = this->mutator->getMatchedNode(Result, matchedNode);
+    const bool nodeIsValid = record.nodeIsValid;
 
+    const MutantSampler *sampler = this->mutationTemplate.getSampler();
+    const MutantShard &shard = this->mutationTemplate.getShard();
+    const Candidate candidate = this->makeCandidate(Result, record);
     // Loop on mutator types
     for (MutatorType i = 0; i < this->mutator->getTypes(); ++i) {
+      if (sampler != nullptr && !sampler->isSelected(record.candidate + i)) {
+        continue; // Sampled out
+      }
+      if (sampler == nullptr && shard.isSharded() &&
+          !MutantSampler::owns(
+              shard, this->mutationTemplate.getTargetFilename().str(),
+              candidate, i, this->mutator->isHom())) {
+        continue; // Applied by another shard
+      }
+      const ::std::size_t ordinal = this->mutationTemplate.nextOrdinal();
       // Per mutation type actions:
-      // * Set local mutantId and retrieve a rewriter
-      Rewriter &localRw = this->initializeMutant(mutantId);
+      // * Set local mutantId and, unless the mutator describes the mutation
+      //   as edits, retrieve a rewriter
+      mutantId = this->getMutantId();
 
       // Verbose messages
       if (nodeIsValid) {
-        ChimeraLogger::verbose(
+        CHIMERA_VERBOSE(
             "[" + std::to_string(mutantId) + "] Applying mutation in " +
             matchedNode.getSourceRange().getBegin().printToString(
                 *(this->sourceManager)));
       } else {
-        ChimeraLogger::verbose("[" + std::to_string(mutantId) +
-                               "] Applying mutation in <invalid>. Report for "
-                               "this mutant will not be generated");
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Applying mutation in <invalid>. Report for "
+                        "this mutant will not be generated");
       }
 
-      // Apply the mutation calling the mutate method
-      this->mutator->mutate(Result, i, localRw);
+      // Apply the mutation: a FOM mutant is built straight from its edits,
+      // otherwise calling the mutate method
+      const ::llvm::StringRef original = this->sourceManager->getBufferData(
+          this->sourceManager->getMainFileID());
+      mutant::EditScript edits;
+      ::std::string code;
+      bool modified = false;
+      {
+        // Timed up to the mutated code
+        TimeReport::Timer mutateTimer(this->mutationTemplate.getTimeReport(),
+                                      this->timeScope, TimePhase::Mutate);
+        if (!this->mutator->isHom() &&
+            this->mutator->produceEdits(Result, i, edits)) {
+          if (!mutant::normalizeEdits(edits)) {
+            ChimeraLogger::error("[" + std::to_string(mutantId) + "] " +
+                                 this->mutator->getIdentifier() +
+                                 " produced overlapping edits");
+            continue;
+          }
+          modified = !edits.empty();
+          if (modified) {
+            code = mutant::applyEdits(original.str(), edits);
+          }
+        } else {
+          Rewriter &localRw = this->initializeMutant(mutantId);
+          this->mutator->mutate(Result, i, localRw);
+          // Check if actually a rewriteBuffer has been created, id est if the
+          // buffer has been modified.
+          modified = localRw.getRewriteBufferFor(
+                         localRw.getSourceMgr().getMainFileID()) != nullptr;
+          if (modified) {
+            code = this->getMutatedCode(localRw);
+          }
+        }
+      }
 
-      // Check if actually a rewriteBuffer has been created, id est if the
-      // buffer has been modified.
-      if (localRw.getRewriteBufferFor(localRw.getSourceMgr().getMainFileID()) !=
-          nullptr) {
+      if (modified) {
         // The source file has been somehow modified, continue
-        // Check if the mutant is valid
-        ChimeraLogger::verboseAndIncr("[" + std::to_string(mutantId) +
-                                      "][ RUN  ] Checking mutant");
-
-        if (this->checkMutant(localRw)) {
-          ChimeraLogger::verbosePreDecr("[" + std::to_string(mutantId) +
-                                        "][ PASS ] Checking mutant");
-
-          // The mutant is valid, continue
-          // Save the report if the matched node is valid
-          if (nodeIsValid) {
-            this->createReportEntry(
-                mutantId, Result.Nodes.getNodeAs<FunctionDecl>("functionDecl")
-                              ->getNameAsString(),
-                matchedNode.getSourceRange().getBegin(),
-                this->mutator->getIdentifier(), i);
-          }
+        MutationRecord mutation;
+        mutation.callback = this;
+        mutation.nodeIsValid = nodeIsValid;
+        if (nodeIsValid) {
+          mutation.functionName =
+              Result.Nodes.getNodeAs<FunctionDecl>("functionDecl")
+                  ->getNameAsString();
+          mutation.location = matchedNode.getSourceRange().getBegin();
+        }
+        mutation.type = i;
+        mutation.hasCandidate = sampler != nullptr || shard.isSharded();
+        mutation.candidate = record.candidate + i;
+        mutation.ordinal = ordinal;
+        mutation.journalKey = this->getJournalKey(mutation);
+        mutation.isJournaled = false;
+        mutation.journaledId = 0;
+        mutation.hasSite =
+            !this->mutator->isHom() && this->mutationTemplate.isSchemata() &&
+            nodeIsValid &&
+            this->getExpressionSite(matchedNode, mutation.siteStart,
+                                    mutation.siteEnd);
+
+        if (this->mutator->isHom() && this->localMutantId != 0 &&
+            this->mutationTemplate.isDeferredHomValidation()) {
+          // The whole HOM mutant will be checked once
+          CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                          "] Check deferred to the end of the "
+                          "translation unit");
+          this->mutationTemplate.getPendingMutants().defer(
+              mutantId, ::std::move(mutation), original, code,
+              this->mutator->getAdditionalCompileCommands());
+          continue;
+        }
 
-          // Save the mutant to file if this feature is enabled
-          if (this->mutationTemplate.isGenerateMutants()) {
-            this->saveMutant(mutantId, localRw);
-          } else {
-            ChimeraLogger::verbose("[" + std::to_string(mutantId) +
-                                   "] Saving disabled");
-          }
-          // Increment mutantCounter if the mutator is not an HOM
-          this->finalizeMutant();
+        // Queue the check of the mutant, the snapshot makes it independent
+        // from the next mutations on the same rewriter
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "][ RUN  ] Checking mutant");
+        PendingMutant pending;
+        bool journaledValid;
+        mutant::IdType journaledId;
+        pending.mutation = ::std::move(mutation);
+        pending.code = ::std::move(code);
+        pending.edits = ::std::move(edits);
+        if (!this->mutator->isHom() &&
+            this->mutationTemplate.isDeduplicate()) {
+          pending.canonical =
+              this->mutationTemplate.getPendingMutants().identify(
+                  pending.code, this->mutator->getAdditionalCompileCommands(),
+                  pending.isDuplicate);
+        }
+        if (pending.isDuplicate) {
+          // Same content of an earlier mutant, so the same verdict
+          CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                          "] Duplicate, check skipped");
+          pending.code.clear();
+          pending.edits.clear();
+        } else if (this->mutationTemplate.getJournal().lookup(
+                       pending.mutation.ordinal, pending.mutation.journalKey,
+                       journaledValid, journaledId)) {
+          // Checked before the interruption
+          CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                          "] Journaled, check skipped");
+          ::std::promise<bool> journaled;
+          journaled.set_value(journaledValid);
+          pending.verdict = journaled.get_future();
+          pending.mutation.isJournaled = true;
+          pending.mutation.journaledId = journaledId;
+        } else if (!this->needsCheck(pending.mutation, pending.isSampled)) {
+          // Trusted mutator, valid by construction
+          CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                          "] Trusted mutator, check skipped");
+          ::std::promise<bool> trusted;
+          trusted.set_value(true);
+          pending.verdict = trusted.get_future();
         } else {
-          // The mutant is invalid
-          ChimeraLogger::verbosePreDecr("[" + std::to_string(mutantId) +
-                                        "][ FAIL ] Checking mutant");
-#ifdef _CHIMERA_DEBUG_
-          // DEBUG
-          rw.getEditBuffer(rw.getSourceMgr().getMainFileID())
-              .write(llvm::outs());
-#endif
+          ValidationPool::CheckObserver observer;
+          if (TimeReport *report = this->mutationTemplate.getTimeReport()) {
+            // The callbacks outlive the validation pool
+            const TimeScope *scope = &this->timeScope;
+            observer = [report, scope](double seconds) {
+              report->addCheck(*scope, seconds);
+            };
+          }
+          pending.verdict = this->mutationTemplate.getValidationPool().submit(
+              pending.code, this->mutator->getAdditionalCompileCommands(),
+              observer);
         }
+        this->mutationTemplate.getPendingMutants().push(::std::move(pending));
+
+        // A HOM mutant without an id gets it from this very verdict
+        this->mutationTemplate.getPendingMutants().resolve(
+            this->mutator->isHom() && this->localMutantId == 0
+                ? 0
+                : this->mutationTemplate.getValidationPool().getMaxPending());
       } else {
-        ChimeraLogger::verbose("[" + std::to_string(mutantId) +
-                               "] Application didn't produce changes");
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Application didn't produce changes");
       }
       //      this->deleteLocalRewriter();  // Delete the rewriter
     }
   }
 
-  /// @brief Save a mutant given an unique id and the Rewriter that contains the
-  /// sourceBuffer
+  /// @brief Return the key of a mutation in the journal
+  ::std::string getJournalKey(const MutationRecord &mutation) const {
+    unsigned line = 0, column = 0;
+    if (mutation.nodeIsValid) {
+      FullSourceLoc fullLoc(mutation.location, *(this->sourceManager));
+      line = fullLoc.getSpellingLineNumber();
+      column = fullLoc.getSpellingColumnNumber();
+    }
+    return MutantShard::getKey(
+        this->mutationTemplate.getTargetFilename().str(),
+        mutation.functionName, line, column,
+        this->mutator->getIdentifier() + "#" + std::to_string(mutation.type));
+  }
+
+  /// @brief If a mutant has to be checked, according to the validation
+  /// policy of the mutator in the trusted mutators mode
+  /// @param mutation The mutation that generated the mutant
+  /// @param sampled Set if it is checked as a sample
+  bool needsCheck(const MutationRecord &mutation, bool &sampled) {
+    sampled = false;
+    if (!this->mutationTemplate.isTrustedMutators()) {
+      return true;
+    }
+    switch (this->mutator->getValidationPolicy()) {
+    case NeverValidate:
+      return false;
+    case SampleValidation: {
+      const int sample = this->mutationTemplate.getValidationSample();
+      sampled = MutationTemplate::sampleValidation(
+          sample >= 0 ? sample : this->mutator->getValidationSample(),
+          mutation.journalKey);
+      return sampled;
+    }
+    case AlwaysValidate:
+    default:
+      return true;
+    }
+  }
+
+  /// @brief Consume the verdict of a mutant generated by this callback
+  /// @details It assigns the mutant id, then reports and/or saves the mutant
+  ///          if it passed the check.
+  /// @param pending The mutant, it must be the oldest pending one
+  void resolveMutant(PendingMutant &pending) {
+    const mutant::IdType mutantId = this->getMutantId();
+
+    if (pending.isDuplicate) {
+      this->resolveDuplicate(mutantId, pending);
+      return;
+    }
+
+    bool valid = pending.verdict.get();
+    if (pending.mutation.isJournaled && valid &&
+        pending.mutation.journaledId != mutantId) {
+      // The analysis diverged from the interrupted one (e.g. a mutator whose
+      // state isn't rebuilt), its journaled verdicts can't be trusted
+      ChimeraLogger::warning(
+          "[" + std::to_string(mutantId) + "] Journaled as mutant " +
+          std::to_string(pending.mutation.journaledId) +
+          ", the next mutations are checked again");
+      this->mutationTemplate.getJournal().discardEntries();
+      valid = this->mutationTemplate.getValidationPool()
+                  .submit(pending.code,
+                          this->mutator->getAdditionalCompileCommands())
+                  .get();
+      pending.mutation.isJournaled = false;
+    }
+    if (!pending.mutation.isJournaled) {
+      this->mutationTemplate.getJournal().record(
+          pending.mutation.ordinal, pending.mutation.journalKey, valid,
+          valid ? mutantId : 0);
+    }
+    if (pending.canonical) {
+      pending.canonical->id = mutantId;
+      pending.canonical->valid = valid;
+    }
+    this->count(valid ? TimeCounter::Valid : TimeCounter::Invalid);
+    if (valid) {
+      CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                      "][ PASS ] Checking mutant");
+
+      // The mutant is valid, continue
+      this->reportMutation(mutantId, pending.mutation);
+      if (!this->mutator->isHom()) {
+        this->mutationTemplate.getPendingMutants().addFirstOrder(
+            mutantId, pending,
+            this->sourceManager->getBufferData(
+                this->sourceManager->getMainFileID()));
+      }
+
+      // Save the mutant to file if this feature is enabled
+      if (this->mutationTemplate.isGenerateMutants()) {
+        if (pending.mutation.hasSite &&
+            this->mutationTemplate.getPendingMutants().guard(
+                mutantId, pending.mutation,
+                this->sourceManager->getBufferData(
+                    this->sourceManager->getMainFileID()),
+                pending.code, this->mutator->getAdditionalCompileCommands())) {
+          CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                          "] Guarded in the mutant schemata");
+        } else if (this->mutator->isHom()) {
+          // The next mutations pile up in the same mutant, it is saved once
+          this->mutationTemplate.getPendingMutants().keepHom(mutantId, this,
+                                                             pending.code);
+        } else {
+          this->saveMutant(mutantId, pending.code, &pending.edits);
+        }
+      } else {
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Saving disabled");
+      }
+      // Increment mutantCounter if the mutator is not an HOM
+      this->finalizeMutant();
+    } else {
+      // The mutant is invalid
+      CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                      "][ FAIL ] Checking mutant");
+      if (pending.isSampled) {
+        // The unchecked mutants of the mutator could be invalid as well
+        ChimeraLogger::error("[" + std::to_string(mutantId) + "] " +
+                             this->mutator->getIdentifier() +
+                             " is trusted, but a sampled mutant failed the "
+                             "check");
+        this->mutationTemplate.addTrustViolation();
+      }
+#ifdef _CHIMERA_DEBUG_
+      // DEBUG
+      llvm::outs() << pending.code;
+#endif
+    }
+  }
+
+  /// @brief Consume a duplicate mutant: it's reported, pointing to its
+  /// canonical mutant, but neither checked nor saved
+  void resolveDuplicate(mutant::IdType mutantId, PendingMutant &pending) {
+    const CanonicalMutant &canonical = *pending.canonical;
+    if (!canonical.valid) {
+      CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                      "][ FAIL ] Duplicate of an invalid mutant");
+      return;
+    }
+    CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                    "][ PASS ] Duplicate of [" +
+                    std::to_string(canonical.id) + "]");
+    this->reportMutation(mutantId, pending.mutation, canonical.id);
+    this->finalizeMutant();
+  }
+
+  /// @brief Create the report entry of a mutation applied by this callback
+  /// @details The entry is saved only if the matched node is valid
+  /// @param duplicateOf The id of the identical mutant, 0 if none
+  void reportMutation(mutant::IdType id, const MutationRecord &mutation,
+                      mutant::IdType duplicateOf = 0) {
+    if (mutation.nodeIsValid) {
+      this->createReportEntry(id, mutation.functionName, mutation.location,
+                              this->mutator->getIdentifier(), mutation.type,
+                              duplicateOf);
+    }
+    if (!mutation.hasCandidate) {
+      return;
+    }
+    if (this->mutationTemplate.getBudget().isLimited()) {
+      // Weights of the sampled mutants: id,stratum,weight
+      const MutantSampler &sampler = *this->mutationTemplate.getSampler();
+      this->mutationTemplate.getSamplingStream()
+          << id << "," << sampler.getStratum(mutation.candidate) << ","
+          << sampler.getWeight(mutation.candidate) << std::endl;
+    }
+    if (this->mutationTemplate.getShard().isSharded()) {
+      // Position in a single run, for the merge: the deferred HOM mutants
+      // are reported at the end, by id
+      const bool deferred = this->mutator->isHom() &&
+                            this->mutationTemplate.isDeferredHomValidation();
+      this->mutationTemplate.getShardStream()
+          << "mutant," << id << "," << (deferred ? 1 : 0) << ","
+          << (deferred ? id : 0) << "," << mutation.candidate << ","
+          << (mutation.nodeIsValid ? 1 : 0) << std::endl;
+    }
+  }
+
+  /// @brief Report and save a valid combination of FOM mutants, under a new
+  /// mutant id
+  /// @details Its report entry is the one of the first parent, with the
+  ///          mutators and the types of all the parents joined by '+', and
+  ///          the parent ids as 7th column: parents:<id>;<id>...
+  /// @param parents The records of the parents, by ascending id
+  void saveCombination(const mutant::Combination &combination,
+                       const ::std::vector<const MutationRecord *> &parents,
+                       const ::std::string &code) {
+    const mutant::IdType id = this->mutationTemplate.mutantCounter++;
+    ::std::string mutators, types, ids;
+    for (unsigned i = 0; i < parents.size(); ++i) {
+      const char *separator = i == 0 ? "" : "+";
+      mutators += separator +
+                  parents[i]->callback->getMutator()->getIdentifier();
+      types += separator + std::to_string(parents[i]->type);
+      ids += (i == 0 ? "" : ";") + std::to_string(combination.parents[i]);
+    }
+    CHIMERA_VERBOSE("[" + std::to_string(id) +
+                    "][ PASS ] Combination of " + ids);
+    FullSourceLoc fullLoc(parents.front()->location, *(this->sourceManager));
+    this->mutationTemplate.getReportStream()
+        << id << "," << parents.front()->functionName << ","
+        << fullLoc.getSpellingLineNumber() << ","
+        << fullLoc.getSpellingColumnNumber() << "," << mutators << ","
+        << types << ",parents:" << ids << std::endl;
+    if (this->isGenerateMutants()) {
+      this->saveMutant(id, code, &combination.edits);
+    }
+  }
+
+  MutatorPtr getMutator() const { return this->mutator; }
+  bool isGenerateMutants() { return this->mutationTemplate.isGenerateMutants(); }
+  std::string getTargetFilename() {
+    return this->mutationTemplate.getTargetFilename().str();
+  }
+
+  /// @brief Save a mutant given an unique id and its source
   /// @param id Mutant unique id
-  /// @param rewriter Rewriter object with RewriteBuffer that contains the
-  /// source modification
+  /// @param code The whole mutated content of the target
+  /// @param edits The edit script of the mutant, if built from one, so that
+  ///        the delta storage doesn't have to compute it
   /// @return If the Mutant is correctly saved
-  bool saveMutant(mutant::IdType id, Rewriter &rewriter) {
+  bool saveMutant(mutant::IdType id, const ::std::string &code,
+                  const mutant::EditScript *edits = nullptr) {
+    TimeReport::Timer saveTimer(this->mutationTemplate.getTimeReport(),
+                                this->timeScope, TimePhase::Save);
+    if (this->mutationTemplate.getMutantStorage() ==
+        mutant::MutantStorage::Pack) {
+      CHIMERA_VERBOSE("[" + std::to_string(id) + "] Packing mutant");
+      if (!this->mutationTemplate.getPackWriter().add(
+              id, this->mutationTemplate.getTargetFilename().str(), code)) {
+        ChimeraLogger::error("An error occurred writing the mutant " +
+                             std::to_string(id) + " in " +
+                             this->mutationTemplate.getPackPath());
+        return false;
+      }
+      this->count(TimeCounter::BytesWritten, code.size());
+      return true;
+    }
+    if (this->mutationTemplate.getMutantStorage() ==
+        mutant::MutantStorage::Delta) {
+      CHIMERA_VERBOSE("[" + std::to_string(id) +
+                      "] Saving mutant as delta");
+      const bool fromEdits = edits != nullptr && !edits->empty();
+      const bool added =
+          fromEdits ? this->mutationTemplate.getDeltaWriter().add(id, *edits)
+                    : this->mutationTemplate.getDeltaWriter().add(id, code);
+      if (!added) {
+        ChimeraLogger::error("An error occurred writing the mutant " +
+                             std::to_string(id) + " in " +
+                             this->mutationTemplate.getDeltaPath());
+        return false;
+      }
+      if (this->mutationTemplate.getTimeReport() != nullptr) {
+        // Only the replacements, the delta writer computes the edits of a
+        // code on its own
+        ::std::uint64_t bytes = 0;
+        if (fromEdits) {
+          for (const mutant::Edit &edit : *edits) {
+            bytes += edit.replacement.size();
+          }
+        } else {
+          bytes = code.size();
+        }
+        this->count(TimeCounter::BytesWritten, bytes);
+      }
+      return true;
+    }
+
     std::string filename(this->mutationTemplate.getTargetFilename().data());
     std::string mutantPath = this->mutationTemplate.getTargetOutputDirectory() +
                              std::to_string(id) + chimera::fs::pathSep;
     std::string filePath = mutantPath + filename;
-    ChimeraLogger::verbose("[" + std::to_string(id) + "] Saving mutant in " +
-                           clang::tooling::getAbsolutePath(filePath));
+    CHIMERA_VERBOSE("[" + std::to_string(id) + "] Saving mutant in " +
+                    clang::tooling::getAbsolutePath(filePath));
 
     // Create folder for this mutant
     chimera::fs::createDirectories(mutantPath);
@@ -347,8 +876,8 @@ public:
     llvm::raw_fd_ostream file(filePath.c_str(), fileError,
                               llvm::sys::fs::F_Text);
     if (!file.has_error()) {
-      rewriter.getEditBuffer(rewriter.getSourceMgr().getMainFileID())
-          .write(file);
+      file << code;
+      this->count(TimeCounter::BytesWritten, code.size());
     } else {
       ChimeraLogger::error("An error occurred during the file opening: " +
                            fileError.message());
@@ -358,60 +887,83 @@ public:
     return true;
   }
 
-  /// @brief Check syntactically a mutant identified by id
-  /// @param id Mutant unique id
-  /// @return If the mutant passes the check
-  bool checkMutant(Rewriter &rw) {
-    // Create a temp directory and a temp file
-    std::string tempDir = this->mutationTemplate.getTargetOutputDirectory() +
-                          this->tempDirName + chimera::fs::pathSep;
-    std::string tempFilePath =
-        tempDir + this->mutationTemplate.getTargetFilename().data();
-
-    // Create the directory
-    chimera::fs::createDirectories(tempDir);
-
-    // Create temp file
-    ::std::error_code fileError;
-    ::llvm::raw_fd_ostream tempFile(tempFilePath, fileError,
-                                    llvm::sys::fs::F_Text);
-    if (!tempFile.has_error()) {
-      // Write the temp file
-      rw.getEditBuffer(rw.getSourceMgr().getMainFileID()).write(tempFile);
-      tempFile.close(); // Close the file stream
-
-      ChimeraLogger::verbose("Building CompilationDatabase");
-      // Get compileCommands for this target
-      CompileCommand command = this->mutationTemplate.getCompileCommand();
-
-      // Modify the compile command
-      ::chimera::cd_utils::changeCompileCommandTarget(
-          command, this->mutationTemplate.getTargetPath(), tempFilePath, true);
-
-      // Adding compile commands from the mutator
-      const ::std::vector<::std::string> &mutatorCompileCommands =
-          this->mutator->getAdditionalCompileCommands();
-      command.CommandLine.insert(command.CommandLine.end(),
-                                 mutatorCompileCommands.begin(),
-                                 mutatorCompileCommands.end());
+  /// @brief Save the mutant schemata of the target and the mapping between
+  /// its selectors and the mutant ids (schemata.csv)
+  /// @details The mutants whose site doesn't compile once guarded are saved
+  ///          on their own.
+  void saveSchemata(const mutant::MutantSchemata &schemata,
+                    const mutant::MutantSchemata::CheckFunction &check) {
+    CHIMERA_VERBOSE_AND_INCR("[ RUN  ] Building the mutant schemata");
+    ::std::vector<mutant::IdType> selectors, dropped;
+    const ::std::string code = schemata.build(check, selectors, dropped);
+    for (mutant::IdType id : dropped) {
+      CHIMERA_VERBOSE("[" + std::to_string(id) +
+                      "] Left out of the mutant schemata");
+      this->saveMutant(id, schemata.getMutantCode(id));
+    }
+    if (selectors.empty()) {
+      CHIMERA_VERBOSE_PRE_DECR("[ DONE ] Building the mutant schemata");
+      return;
+    }
 
-#ifdef _CHIMERA_DEBUG_
-      chimera::cd_utils::dump(std::cout, commands); // Debug
-#endif
-      ChimeraLogger::verbose("Running syntax check");
-
-      // TODO A frontend action can be called directly on code in string format
-      // clang::tooling::runToolOnCode uses the -fsyntax-only code that check
-      // only the syntax
-      // BUT show always errors for inclusion not found, because compile
-      // commands aren't passed in input.
-      return chimera::checkSyntaxAction(
-                 command, this->mutationTemplate.getTargetPath()) == 0;
-    } else {
+    std::string schemataDir = this->mutationTemplate.getTargetOutputDirectory() +
+                              "schemata" + chimera::fs::pathSep;
+    chimera::fs::createDirectories(schemataDir);
+    ::std::error_code fileError;
+    llvm::raw_fd_ostream file(
+        schemataDir + this->mutationTemplate.getTargetFilename().data(),
+        fileError, llvm::sys::fs::F_Text);
+    if (fileError) {
       ChimeraLogger::error("An error occurred during the file opening: " +
                            fileError.message());
+    } else {
+      file << code;
+    }
+    // Selector to report row (id) mapping
+    ::std::ofstream mapping(this->mutationTemplate.getTargetOutputDirectory() +
+                            "schemata.csv");
+    for (unsigned i = 0; i < selectors.size(); ++i) {
+      mapping << (i + 1) << "," << selectors[i] << std::endl;
+    }
+    CHIMERA_VERBOSE_PRE_DECR("[ DONE ] Building the mutant schemata: " +
+                             std::to_string(selectors.size()) +
+                             " mutants guarded");
+  }
+
+  /// @brief Retrieve the range of a matched expression, as offsets in the
+  /// main file
+  /// @return false if the node is not an expression written in the main file
+  bool getExpressionSite(const ::clang::ast_type_traits::DynTypedNode &node,
+                         unsigned &start, unsigned &end) {
+    const Expr *expr = node.get<Expr>();
+    if (expr == nullptr) {
+      return false;
+    }
+    SourceRange range = expr->getSourceRange();
+    if (range.isInvalid() || range.getBegin().isMacroID() ||
+        range.getEnd().isMacroID() ||
+        !this->sourceManager->isWrittenInMainFile(range.getBegin())) {
       return false;
     }
+    SourceLocation endLoc = Lexer::getLocForEndOfToken(
+        range.getEnd(), 0, *(this->sourceManager), this->context->getLangOpts());
+    if (endLoc.isInvalid()) {
+      return false;
+    }
+    start = this->sourceManager->getFileOffset(range.getBegin());
+    end = this->sourceManager->getFileOffset(endLoc);
+    return start < end;
+  }
+
+  /// @brief Return the mutated main file held by a rewriter
+  /// @details The buffer is handed to the validation engine, which maps it in
+  ///          memory, and eventually saved once its verdict is known.
+  /// @param rw Rewriter object with the source modification
+  std::string getMutatedCode(Rewriter &rw) {
+    ::std::string code;
+    ::llvm::raw_string_ostream codeStream(code);
+    rw.getEditBuffer(rw.getSourceMgr().getMainFileID()).write(codeStream);
+    return codeStream.str();
   }
 
   /// @brief Delete a mutant that fails the check
@@ -435,16 +987,22 @@ public:
   void createReportEntry(mutant::IdType id, const std::string &functionName,
                          const SourceLocation &l,
                          const std::string &mutatorIdentifier,
-                         mutator::MutatorType type) {
-    ChimeraLogger::verbose("[" + std::to_string(id) +
-                           "] Mutant report: Location: " +
-                           l.printToString(*(this->sourceManager)));
+                         mutator::MutatorType type,
+                         mutant::IdType duplicateOf = 0) {
+    CHIMERA_VERBOSE("[" + std::to_string(id) +
+                    "] Mutant report: Location: " +
+                    l.printToString(*(this->sourceManager)));
     // Create a fullSource -> a SourceLocation with an associatd SourceManager
     FullSourceLoc fullLoc(l, *(this->sourceManager));
     this->mutationTemplate.getReportStream()
         << id << "," << functionName << "," << fullLoc.getSpellingLineNumber()
         << "," << fullLoc.getSpellingColumnNumber() << "," << mutatorIdentifier
-        << "," << type << std::endl;
+        << "," << type;
+    if (duplicateOf != 0) {
+      // Only the duplicates have the 7th column: the canonical mutant id
+      this->mutationTemplate.getReportStream() << "," << duplicateOf;
+    }
+    this->mutationTemplate.getReportStream() << std::endl;
   }
 
   ///////////////////////////////////////////////////////////////////////////////
@@ -456,23 +1014,112 @@ public:
    * to generate the mutants.
    */
   virtual void run(const MatchFinder::MatchResult &Result) {
-    ChimeraLogger::verboseAndIncr("Coarse grain matching from " +
-                                  this->mutator->getIdentifier());
+    // First phase: only record the match, it is processed once the whole AST
+    // has been traversed
+    MatchRecord record(this, Result);
+    this->count(TimeCounter::Candidates);
+    record.nodeIsValid = this->mutator->getMatchedNode(Result, record.node);
+    if (record.nodeIsValid) {
+      record.range = record.node.getSourceRange();
+    }
+    this->mutationTemplate.getMatches().push(::std::move(record));
+  }
+
+  /// @brief Record a fine grain match as a candidate, in the count-only mode
+  void countCandidate(const MatchFinder::MatchResult &Result,
+                      const MatchRecord &record) {
+    this->mutationTemplate.getCandidates().add(
+        this->makeCandidate(Result, record));
+  }
+
+  /// @brief First pass of the sampling for a recorded match: fine grain
+  /// matching only, adding its candidate mutations to the sampler
+  /// @details The match is repeated by processMatch() if any of them is
+  ///          selected, match() depends only on the node (see
+  ///          Mutator::match()) and the mutators keep their state between
+  ///          match() and mutate().
+  void addCandidate(MatchRecord &record, MutantSampler &sampler) {
+    const MatchFinder::MatchResult Result(record.nodes, record.context);
+    this->setSourceManager(Result.SourceManager);
+    this->setASTContext(Result.Context);
+    this->mutator->setContextIndex(&this->mutationTemplate.getContextIndex());
+    {
+      TimeReport::Timer matchTimer(this->mutationTemplate.getTimeReport(),
+                                   this->timeScope, TimePhase::Match);
+      record.isCandidate = this->mutator->match(Result);
+    }
+    if (record.isCandidate) {
+      record.candidate = sampler.add(this->makeCandidate(Result, record),
+                                     this->mutator->isHom());
+    }
+  }
+
+  /// @brief Describe a fine grain match as a candidate
+  Candidate makeCandidate(const MatchFinder::MatchResult &Result,
+                          const MatchRecord &record) {
+    Candidate candidate;
+    candidate.line = 0;
+    candidate.column = 0;
+    if (record.nodeIsValid) {
+      candidate.functionName =
+          Result.Nodes.getNodeAs<FunctionDecl>("functionDecl")
+              ->getNameAsString();
+      FullSourceLoc fullLoc(record.range.getBegin(), *(this->sourceManager));
+      candidate.line = fullLoc.getSpellingLineNumber();
+      candidate.column = fullLoc.getSpellingColumnNumber();
+    }
+    candidate.operatorId = this->operatorId;
+    candidate.mutatorId = this->mutator->getIdentifier();
+    candidate.mutations = this->mutator->getTypes();
+    return candidate;
+  }
+
+  /// @brief Second phase for a recorded match: fine grain matching, then
+  /// mutation and validation
+  void processMatch(MatchRecord &record) {
+    const MutantSampler *sampler = this->mutationTemplate.getSampler();
+    if (sampler != nullptr &&
+        (!record.isCandidate ||
+         !sampler->isAnySelected(record.candidate,
+                                 this->mutator->getTypes()))) {
+      return; // Sampled out, not even matched again
+    }
+    const MatchFinder::MatchResult Result(record.nodes, record.context);
+    CHIMERA_VERBOSE_AND_INCR("Coarse grain matching from " +
+                             this->mutator->getIdentifier());
     // Set the local sourceManager
     this->setSourceManager(Result.SourceManager);
     this->setASTContext(Result.Context);
+    this->mutator->setContextIndex(&this->mutationTemplate.getContextIndex());
     // Apply fine grained matching rules
-    if (this->mutator->match(Result)) {
+    bool matched;
+    {
+      TimeReport::Timer matchTimer(this->mutationTemplate.getTimeReport(),
+                                   this->timeScope, TimePhase::Match);
+      matched = this->mutator->match(Result);
+    }
+    if (matched) {
       // It is very likely that mutants have to be created -> general mutant
-      ChimeraLogger::verboseAndIncr("Fine grain matching [ PASS ]");
+      CHIMERA_VERBOSE_AND_INCR("Fine grain matching [ PASS ]");
+      this->count(TimeCounter::FinePasses);
+      if (sampler == nullptr) {
+        // The index the sampler would have given it
+        record.isCandidate = true;
+        record.candidate = this->mutationTemplate.nextCandidates(
+            this->mutator->getTypes());
+      }
 
       // With the introduction of the HOM mutators, this phase has to be
       // specialized
-      this->applyMutations(Result);
+      if (this->mutationTemplate.isCountOnly()) {
+        this->countCandidate(Result, record);
+      } else {
+        this->applyMutations(Result, record);
+      }
 
       ChimeraLogger::decrActualVLevel();
     } else {
-      ChimeraLogger::verbose("Fine grain matching [ FAIL ]");
+      CHIMERA_VERBOSE("Fine grain matching [ FAIL ]");
     }
     ChimeraLogger::decrActualVLevel();
   }
@@ -481,32 +1128,42 @@ public:
    */
   virtual void onEndOfTranslationUnit() {
     //    ChimeraLogger::verbose(" [ RUN  ] Cleaning up");
+    // The traversal is over: the first callback runs the second phase for all
+    this->mutationTemplate.noteEndOfTraversal();
+    this->mutationTemplate.getMatches().process(
+        this->mutationTemplate.getSampler());
+    if (this->mutationTemplate.isCountOnly()) {
+      // Nothing has been mutated
+      CHIMERA_VERBOSE(" [ DONE ] Cleaning up");
+      return;
+    }
+    // Every mutant has to be on disk before the callbacks are called
+    this->mutationTemplate.getPendingMutants().finish(
+        this->mutationTemplate.getValidationPool());
     // Call callbacks: if the mutator is HOM, and so the localMutantId is != 0.
     // Finally the mutant directory exists only if the mutants have been
     // generated.
     if (this->mutator->isHom() && this->localMutantId != 0 &&
-        this->mutationTemplate.isGenerateMutants()) {
-      // At this point the mutant has been created
-      this->mutator->onCreatedMutant(
-          this->mutationTemplate.getTargetOutputDirectory() +
-          ::std::to_string(this->localMutantId) + ::chimera::fs::pathSep);
+        this->mutationTemplate.isGenerateMutants() &&
+        this->mutationTemplate.getShard().owns(MutantShard::getHomKey(
+            this->mutationTemplate.getTargetFilename().str(),
+            this->operatorId))) {
+      // At this point the mutant has been created, its directory exists only
+      // with the tree storage
+      const ::std::string mutantDir =
+          this->mutationTemplate.getMutantDirectory(this->localMutantId);
+      chimera::fs::createDirectories(mutantDir);
+      TimeReport::Timer reportTimer(this->mutationTemplate.getTimeReport(),
+                                    this->timeScope, TimePhase::Report);
+      this->mutator->onCreatedMutant(mutantDir);
     }
 
-    // Delete temp folder, deleting all files inside
-    ::std::string tempDir = this->mutationTemplate.getTargetOutputDirectory() +
-                            this->tempDirName + chimera::fs::pathSep;
-    // Delete temp file for syntax checking
-    ::llvm::sys::fs::remove(tempDir +
-                            this->mutationTemplate.getTargetFilename());
-
-    // Delete the temp directory
-    ::llvm::sys::fs::remove(tempDir);
-
-       ChimeraLogger::verbose(" [ DONE ] Cleaning up");
+       CHIMERA_VERBOSE(" [ DONE ] Cleaning up");
   }
 
 private:
   MutationTemplate &mutationTemplate; ///< Reference to the mutation template
+  m_operator::IdType operatorId;      ///< Operator of the mutator
   MutatorPtr mutator;                 ///< Mutator related to this Matcher
   SourceManager *sourceManager;       ///< Pointer to the source manager
   const ASTContext *context;
@@ -515,19 +1172,361 @@ private:
   ///        influences the retrieve
   ///        of the rewriter.
   mutant::IdType localMutantId;
-  const ::std::string tempDirName; ///< Temporary directory
+  TimeScope timeScope; ///< Of the measures of the mutator
 };
 
 ///////////////////////////////////////////////////////////////////////////////
-// Class MutationTemplate Implementation
+/// @brief Mark the end of the parsing, right before the AST traversal
+class ParsingDoneCallback : public MatchFinder::ParsingDoneTestCallback {
+public:
+  explicit ParsingDoneCallback(TimeReport::Clock::time_point &end)
+      : end(end) {}
+
+  virtual void run() { this->end = TimeReport::Clock::now(); }
+
+private:
+  TimeReport::Clock::time_point &end;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Callback of a matcher shared by the mutators with the same key
+/// @details The matcher is evaluated once, each result is fanned out to the
+///          callbacks of the operators for which the function is selected.
+class chimera::SharedMatcherCallback : public MatchFinder::MatchCallback {
+public:
+  explicit SharedMatcherCallback(const FunctionSelector *selector)
+      : MatchCallback(), selector(selector) {}
+
+  void add(const m_operator::IdType &operatorId,
+           MutatorMatcherCallback *callback) {
+    this->operatorIds.push_back(operatorId);
+    this->callbacks.push_back(callback);
+  }
+
+  const ::std::vector<m_operator::IdType> &getOperatorIds() const {
+    return this->operatorIds;
+  }
+
+  virtual void run(const MatchFinder::MatchResult &Result) {
+    const FunctionDecl *function =
+        Result.Nodes.getNodeAs<FunctionDecl>("functionDecl");
+    for (unsigned i = 0; i < this->callbacks.size(); ++i) {
+      if (this->selector == nullptr ||
+          this->selector->isSelected(*function, this->operatorIds[i])) {
+        this->callbacks[i]->run(Result);
+      }
+    }
+  }
+
+  /// @brief The finder knows only this callback, forward to all of them
+  virtual void onEndOfTranslationUnit() {
+    for (MutatorMatcherCallback *callback : this->callbacks) {
+      callback->onEndOfTranslationUnit();
+    }
+  }
+
+private:
+  const FunctionSelector *selector; ///< nullptr if all functions are selected
+  ::std::vector<m_operator::IdType> operatorIds; ///< Operator of each callback
+  ::std::vector<MutatorMatcherCallback *> callbacks;
+};
+
+void chimera::MatchWorkList::process(MutantSampler *sampler) {
+  if (this->records.empty()) {
+    return;
+  }
+  if (sampler != nullptr) {
+    CHIMERA_VERBOSE_AND_INCR("[ RUN  ] Sampling the candidate mutations");
+    for (MatchRecord &record : this->records) {
+      record.callback->addCandidate(record, *sampler);
+    }
+    sampler->sample();
+    CHIMERA_VERBOSE_PRE_DECR("[ DONE ] Sampling " +
+                             std::to_string(sampler->size()) +
+                             " candidate mutations");
+  }
+  CHIMERA_VERBOSE_AND_INCR("[ RUN  ] Mutating " +
+                           std::to_string(this->records.size()) +
+                           " matches");
+  for (MatchRecord &record : this->records) {
+    record.callback->processMatch(record);
+  }
+  this->records.clear();
+  CHIMERA_VERBOSE_PRE_DECR("[ DONE ] Mutating matches");
+}
+
+void chimera::PendingMutantQueue::resolve(::std::size_t maxPending) {
+  while (this->mutants.size() > maxPending) {
+    // Pop it first, the resolution could not return (fatal)
+    PendingMutant pending = ::std::move(this->mutants.front());
+    this->mutants.pop_front();
+    pending.mutation.callback->resolveMutant(pending);
+  }
+}
+
+void chimera::PendingMutantQueue::defer(
+    mutant::IdType id, MutationRecord &&mutation, ::llvm::StringRef original,
+    const ::std::string &code,
+    const ::std::vector<::std::string> &additionalCommands) {
+  auto &hom = this->deferred[id];
+  if (!hom) {
+    hom.reset(new DeferredHomMutant(original.str()));
+  }
+  hom->mutant.addMutation(code);
+  hom->mutations.push_back(::std::move(mutation));
+  // All the mutators of the operator share the mutant, and so the check
+  mergeCommands(hom->commands, additionalCommands);
+}
+
+void chimera::PendingMutantQueue::mergeCommands(
+    ::std::vector<::std::string> &commands,
+    const ::std::vector<::std::string> &toAdd) {
+  for (const ::std::string &command : toAdd) {
+    if (::std::find(commands.begin(), commands.end(), command) ==
+        commands.end()) {
+      commands.push_back(command);
+    }
+  }
+}
+
+/// @brief Hash a mutated content with the compile commands of its check
+static void hashMutant(const ::std::string &code,
+                       const ::std::vector<::std::string> &commands,
+                       ::llvm::MD5::MD5Result &result) {
+  ::llvm::MD5 hash;
+  hash.update(code);
+  for (const ::std::string &command : commands) {
+    hash.update(::llvm::StringRef("\0", 1));
+    hash.update(command);
+  }
+  hash.final(result);
+}
+
+::std::future<bool> chimera::PendingMutantQueue::submit(
+    ValidationPool &pool, const ::std::string &code,
+    const ::std::vector<::std::string> &commands, ::std::string &key,
+    bool &journaled) {
+  journaled = false;
+  if (!this->journal.isOpen()) {
+    return pool.submit(code, commands);
+  }
+  ::llvm::MD5::MD5Result result;
+  hashMutant(code, commands, result);
+  ::llvm::SmallString<32> hex;
+  ::llvm::MD5::stringifyResult(result, hex);
+  key = hex.str();
+  bool valid;
+  if (!this->journal.lookupCheck(key, valid)) {
+    return pool.submit(code, commands);
+  }
+  // Checked before the interruption
+  journaled = true;
+  ::std::promise<bool> verdict;
+  verdict.set_value(valid);
+  return verdict.get_future();
+}
+
+bool chimera::PendingMutantQueue::check(
+    ValidationPool &pool, const ::std::string &code,
+    const ::std::vector<::std::string> &commands) {
+  ::std::string key;
+  bool journaled;
+  const bool valid = this->submit(pool, code, commands, key, journaled).get();
+  if (!journaled) {
+    this->journal.recordCheck(key, valid);
+  }
+  return valid;
+}
+
+::std::shared_ptr<CanonicalMutant> chimera::PendingMutantQueue::identify(
+    const ::std::string &code,
+    const ::std::vector<::std::string> &additionalCommands,
+    bool &isDuplicate) {
+  ::llvm::MD5::MD5Result result;
+  hashMutant(code, additionalCommands, result);
+  const ::std::string key(reinterpret_cast<const char *>(result),
+                          sizeof(result));
+
+  ::std::shared_ptr<CanonicalMutant> &canonical = this->canonicals[key];
+  isDuplicate = canonical != nullptr;
+  if (!isDuplicate) {
+    canonical = ::std::make_shared<CanonicalMutant>();
+  }
+  return canonical;
+}
+
+void chimera::PendingMutantQueue::addFirstOrder(mutant::IdType id,
+                                               const PendingMutant &pending,
+                                               ::llvm::StringRef original) {
+  // The combinations are reported from the parents' locations
+  if (!this->combiner || !pending.mutation.nodeIsValid) {
+    return;
+  }
+  if (this->original.empty()) {
+    this->original = original.str();
+  }
+  this->combiner->add(id, !pending.edits.empty()
+                              ? pending.edits
+                              : mutant::computeEdits(this->original,
+                                                     pending.code));
+  this->parents[id] = pending.mutation;
+}
+
+void chimera::PendingMutantQueue::combine(ValidationPool &pool) {
+  if (!this->combiner || this->combiner->size() < 2) {
+    return;
+  }
+  CHIMERA_VERBOSE_AND_INCR(
+      "[ RUN  ] Combining " + std::to_string(this->combiner->size()) +
+      " FOM mutants");
+  const ::std::vector<mutant::Combination> combinations =
+      this->combiner->combine();
+
+  // Verdicts consumed in order, with up to getMaxPending() checks in flight
+  struct Candidate {
+    const mutant::Combination *combination;
+    ::std::vector<const MutationRecord *> parents;
+    ::std::string code;
+    ::std::future<bool> verdict;
+    ::std::string key; ///< In the journal
+    bool journaled;    ///< If the verdict is the journaled one
+  };
+  ::std::deque<Candidate> candidates;
+  unsigned valid = 0;
+  auto resolveFront = [this, &candidates, &valid]() {
+    Candidate &candidate = candidates.front();
+    const bool isValid = candidate.verdict.get();
+    if (!candidate.journaled) {
+      this->journal.recordCheck(candidate.key, isValid);
+    }
+    // Counted for the mutator of the first parent, which reports it
+    candidate.parents.front()->callback->count(isValid ? TimeCounter::Valid
+                                                       : TimeCounter::Invalid);
+    if (isValid) {
+      ++valid;
+      candidate.parents.front()->callback->saveCombination(
+          *candidate.combination, candidate.parents, candidate.code);
+    }
+    candidates.pop_front();
+  };
+  for (const mutant::Combination &combination : combinations) {
+    Candidate candidate;
+    candidate.combination = &combination;
+    ::std::vector<::std::string> commands;
+    for (mutant::IdType id : combination.parents) {
+      const MutationRecord &parent = this->parents.at(id);
+      candidate.parents.push_back(&parent);
+      mergeCommands(
+          commands,
+          parent.callback->getMutator()->getAdditionalCompileCommands());
+    }
+    candidate.code = mutant::applyEdits(this->original, combination.edits);
+    candidate.verdict = this->submit(pool, candidate.code, commands,
+                                     candidate.key, candidate.journaled);
+    candidates.push_back(::std::move(candidate));
+    while (candidates.size() > pool.getMaxPending()) {
+      resolveFront();
+    }
+  }
+  while (!candidates.empty()) {
+    resolveFront();
+  }
+  CHIMERA_VERBOSE_PRE_DECR(
+      "[ DONE ] Combining FOM mutants: " + std::to_string(valid) + " of " +
+      std::to_string(combinations.size()) + " combinations are valid");
+  // Once per translation unit
+  this->combiner.reset();
+  this->parents.clear();
+}
+
+bool chimera::PendingMutantQueue::guard(
+    mutant::IdType id, const MutationRecord &mutation,
+    ::llvm::StringRef original, const ::std::string &code,
+    const ::std::vector<::std::string> &additionalCommands) {
+  if (!this->schemata) {
+    this->schemata.reset(new mutant::MutantSchemata(
+        original.str(), mutation.callback->getTargetFilename()));
+    this->schemataCallback = mutation.callback;
+  }
+  if (!this->schemata->addMutant(id, code, mutation.siteStart,
+                                 mutation.siteEnd)) {
+    return false;
+  }
+  mergeCommands(this->schemataCommands, additionalCommands);
+  return true;
+}
+
+void chimera::PendingMutantQueue::finish(ValidationPool &pool) {
+  this->resolve(0);
+  for (auto &entry : this->homs) {
+    entry.second.first->saveMutant(entry.first, entry.second.second);
+  }
+  this->homs.clear();
+
+  for (auto &entry : this->deferred) {
+    const mutant::IdType id = entry.first;
+    DeferredHomMutant &hom = *entry.second;
+    CHIMERA_VERBOSE_AND_INCR(
+        "[" + std::to_string(id) + "][ RUN  ] Checking deferred mutant: " +
+        std::to_string(hom.mutant.getMutationsNumber()) + " mutations in " +
+        std::to_string(hom.mutant.getGroupsNumber()) + " independent groups");
+
+    // Bisect on failure, each check is a full one
+    unsigned checks = 0;
+    ::std::vector<bool> kept;
+    const ::std::string code = hom.mutant.validate(
+        [this, &pool, &hom, &checks](const ::std::string &candidate) {
+          ++checks;
+          return this->check(pool, candidate, hom.commands);
+        },
+        kept);
+    const unsigned keptNumber = ::std::count(kept.begin(), kept.end(), true);
+    CHIMERA_VERBOSE_PRE_DECR(
+        "[" + std::to_string(id) + "][ DONE ] Checking deferred mutant: " +
+        std::to_string(keptNumber) + " mutations kept after " +
+        std::to_string(checks) + " checks");
+    // Each mutation is counted as if checked on its own
+    for (unsigned i = 0; i < hom.mutations.size(); ++i) {
+      hom.mutations[i].callback->count(kept[i] ? TimeCounter::Valid
+                                               : TimeCounter::Invalid);
+    }
+    if (code == hom.mutant.getOriginal()) {
+      continue; // Every mutation has been dropped
+    }
+
+    for (unsigned i = 0; i < hom.mutations.size(); ++i) {
+      if (kept[i]) {
+        hom.mutations[i].callback->reportMutation(id, hom.mutations[i]);
+      }
+    }
+    MutatorMatcherCallback &callback = *hom.mutations.front().callback;
+    if (callback.isGenerateMutants()) {
+      callback.saveMutant(id, code);
+    }
+  }
+  this->deferred.clear();
+
+  this->combine(pool);
+
+  if (this->schemata) {
+    const ::std::vector<::std::string> &commands = this->schemataCommands;
+    this->schemataCallback->saveSchemata(
+        *this->schemata,
+        [this, &pool, &commands](const ::std::string &candidate) {
+          return this->check(pool, candidate, commands);
+        });
+    this->schemata.reset();
+  }
+}
 
-static SlotManager<m_operator::IdType, mutant::IdType> idManager;
+///////////////////////////////////////////////////////////////////////////////
+// Class MutationTemplate Implementation
 
 // Private methods
 void chimera::MutationTemplate::initMutantIds_() {
   // Reset slot manager
-  idManager = SlotManager<m_operator::IdType, mutant::IdType>();
-  rwManager = SlotManager<mutant::IdType, Rewriter>();
+  this->idManager = IdSlotManager();
+  this->rwManager = RewriterSlotManager();
   // Reset mutant counter
   this->mutantCounter = mutantCounterInitial;
   // Loop on operators to find HOM and reserve their ids.
@@ -538,8 +1537,8 @@ void chimera::MutationTemplate::initMutantIds_() {
       // Set a slot that binds operator and an identifier, that will be used for
       // all its HOM mutators
       reservedId = this->mutantCounter;
-      if (!idManager.setSlot(op.second->getIdentifier(), reservedId) ||
-          !rwManager.reserve(reservedId)) {
+      if (!this->idManager.setSlot(op.second->getIdentifier(), reservedId) ||
+          !this->rwManager.reserve(reservedId)) {
         ChimeraLogger::fatal("Couldn't reserve a mutantId for an operator. "
                              "Maybe a mutantId duplicate or memory issues.");
       }
@@ -548,97 +1547,167 @@ void chimera::MutationTemplate::initMutantIds_() {
   }
 }
 
-/// @brief Add matchers to finder from mutators vector using functionName as
-/// function's name filter.
+/// @brief Wrap the matcher of a mutator in the matcher of the functions with
+/// body it has to descend into
+static DeclarationMatcher
+getFunctionMatcher(MutatorPtr mutator,
+                   const internal::Matcher<FunctionDecl> &functionIsSelected) {
+  /// The Mutation Template passes to the mutator through bind() the
+  /// functionDecl reference.
+  /// This DeclarationMatcher is a wrapper to reduce the mutations only to the
+  /// functions with
+  /// body.
+  std::string functionDefId = "functionDecl"; /// Id for the matchCallback bind.
+  /* Switch on mutator matcher type */
+  switch (mutator->getMatcherType()) {
+  case StatementMatcherType:
+    return functionDecl(isDefinition(), functionIsSelected,
+                        forEachDescendant(mutator->getStatementMatcher()))
+        .bind(functionDefId);
+  case DeclarationMatcherType:
+    return functionDecl(isDefinition(), functionIsSelected,
+                        forEachDescendant(mutator->getDeclarationMatcher()))
+        .bind(functionDefId);
+  default:
+    llvm_unreachable("Matcher Type unsupported");
+  }
+}
+
+/// @brief Add matchers to finder from the mutators of the operators using
+/// selector as function filter.
+/// @details The mutators declaring the same matcher key share a single
+///          matcher, whose results are fanned out to their callbacks.
 /// @param finder The Match finder in which add the Matchers
-/// @param operatorId The operator id of which take the matchers
-/// @param functionName The name of the target function/method
+/// @param operatorIds The operators of which take the matchers
+/// @param selector The selection of the target functions/methods, nullptr to
+///        mutate all of them
 void chimera::MutationTemplate::addMatchers_(
-    MatchFinder &finder, const m_operator::IdType &operatorId,
-    const std::string &functionName) {
-  // Manage FOM and HOM operator, the mutators are managed inside the callback
-  mutant::IdType reservedId = 0;
-  if (this->operators.at(operatorId)->isHom()) {
-    // Retrieve reservedId
-    if (!idManager.getReservedSlot(operatorId, reservedId)) {
-      ChimeraLogger::fatal("An id wasn't reserved for this operator.");
-    }
-  }
-  const auto &mutators = this->operators[operatorId]->getMutators();
-  // Check functionName
-  internal::Matcher<NamedDecl> functionHasName = anything();
-  if (functionName != "") {
-    // Filter on function's name
-    functionHasName = hasName(functionName);
-  }
-  // Loop on mutators
-  for (unsigned j = 0; j < mutators.size(); ++j) {
-    // Create the callback for this mutator
-    // TODO Manage deallocation of callbackObj
-    MutatorMatcherCallback *callbackObj =
-        new MutatorMatcherCallback(*this, mutators[j], reservedId);
-    /// The Mutation Template passes to the mutator through bind() the
-    /// functionDecl reference.
-    /// This DeclarationMatcher is a wrapper to reduce the mutations only to the
-    /// functions with
-    /// body.
-    DeclarationMatcher functionDefMatcher = anything();
-    std::string functionDefId =
-        "functionDecl"; /// Id for the matchCallback bind.
-    /* Switch on mutator matcher type */
-    switch (mutators[j]->getMatcherType()) {
-    case StatementMatcherType:
-      functionDefMatcher =
-          functionDecl(functionHasName, isDefinition(),
-                       forEachDescendant(mutators[j]->getStatementMatcher()))
-              .bind(functionDefId);
-      break;
-    case DeclarationMatcherType:
-      functionDefMatcher =
-          functionDecl(functionHasName, isDefinition(),
-                       forEachDescendant(mutators[j]->getDeclarationMatcher()))
-              .bind(functionDefId);
-      break;
-    default:
-      llvm_unreachable("Matcher Type unsupported");
-      break;
+    MatchFinder &finder, const ::std::vector<m_operator::IdType> &operatorIds,
+    const FunctionSelector *selector) {
+  // Shared matchers by key, with the mutator providing the matcher
+  ::std::map<::std::string, ::std::pair<MutatorPtr, SharedMatcherCallback *>>
+      sharedMatchers;
+  // Visitor backend of the binary operator mutators opting in, owned by the
+  // template up to the end of the analysis
+  this->visitorBackend.reset(new BinaryOperatorMatcher(selector));
+  for (const m_operator::IdType &operatorId : operatorIds) {
+    // Manage FOM and HOM operator, the mutators are managed inside the
+    // callback
+    mutant::IdType reservedId = 0;
+    if (this->operators.at(operatorId)->isHom()) {
+      // Retrieve reservedId
+      if (!this->idManager.getReservedSlot(operatorId, reservedId)) {
+        ChimeraLogger::fatal("An id wasn't reserved for this operator.");
+      }
+    }
+    const auto &mutators = this->operators[operatorId]->getMutators();
+    // Check the selection, before descending in the function's body
+    internal::Matcher<FunctionDecl> functionIsSelected = anything();
+    if (selector != nullptr) {
+      functionIsSelected = isSelectedBy(selector, operatorId);
     }
-    // Add the matcher to the finder
-    finder.addMatcher(functionDefMatcher, callbackObj);
+    // Loop on mutators
+    for (unsigned j = 0; j < mutators.size(); ++j) {
+      // Create the callback for this mutator
+      // TODO Manage deallocation of callbackObj
+      MutatorMatcherCallback *callbackObj =
+          new MutatorMatcherCallback(*this, operatorId, mutators[j],
+                                     reservedId);
+      const ::std::string key = mutators[j]->getMatcherKey();
+      if (key.empty()) {
+        if (mutators[j]->getMatchBackend() == BinaryOperatorVisitorBackend) {
+          this->visitorBackend->addMatcher(
+              finder, mutators[j]->getStatementMatcher(), callbackObj,
+              {operatorId});
+          continue;
+        }
+        // Add the matcher to the finder
+        finder.addMatcher(getFunctionMatcher(mutators[j], functionIsSelected),
+                          callbackObj);
+        continue;
+      }
+      auto shared = sharedMatchers.find(key);
+      if (shared == sharedMatchers.end()) {
+        // Owned by the template, up to the end of the analysis
+        this->sharedCallbacks.emplace_back(new SharedMatcherCallback(selector));
+        shared = sharedMatchers
+                     .insert(::std::make_pair(
+                         key, ::std::make_pair(
+                                  mutators[j],
+                                  this->sharedCallbacks.back().get())))
+                     .first;
+      }
+      assert(shared->second.first->getMatcherType() ==
+                 mutators[j]->getMatcherType() &&
+             shared->second.first->getMatchBackend() ==
+                 mutators[j]->getMatchBackend() &&
+             "Mutators sharing a matcher key must have the same matcher");
+      shared->second.second->add(operatorId, callbackObj);
+    }
+  }
+  // One matcher per key, selecting the functions of any sharing operator
+  for (const auto &shared : sharedMatchers) {
+    SharedMatcherCallback *callback = shared.second.second;
+    CHIMERA_VERBOSE("Matcher " + shared.first + " shared by " +
+                    ::std::to_string(callback->getOperatorIds().size()) +
+                    " mutators");
+    if (shared.second.first->getMatchBackend() ==
+        BinaryOperatorVisitorBackend) {
+      this->visitorBackend->addMatcher(
+          finder, shared.second.first->getStatementMatcher(), callback,
+          callback->getOperatorIds());
+      continue;
+    }
+    internal::Matcher<FunctionDecl> functionIsSelected = anything();
+    if (selector != nullptr) {
+      functionIsSelected =
+          isSelectedByAny(selector, callback->getOperatorIds());
+    }
+    finder.addMatcher(
+        getFunctionMatcher(shared.second.first, functionIsSelected), callback);
   }
 }
 
-/// @brief Add matchers from local operators filtered by identifier
-void chimera::MutationTemplate::addMatchers_(
-    MatchFinder &finder, const std::vector<m_operator::IdType> &operatorIds,
-    const std::string &functionName) {
-  // Check if there is CHIMERA_ALL_OPERATORS
-  auto operatorId = std::find(operatorIds.begin(), operatorIds.end(),
-                              "CHIMERA_ALL_OPERATORS");
-  if (operatorId != operatorIds.end()) {
-    // Found, Apply all operators
-    ChimeraLogger::verbose("Found CHIMERA_ALL_OPERATORS");
-    {
-      // Load matcher from all operators
-      for (auto op = this->operators.begin(); op != this->operators.end();
-           ++op) {
-        this->addMatchers_(finder, op->first, functionName);
-      }
+/// @brief Move the artifacts of the staged mutants into the pack
+void chimera::MutationTemplate::packArtifacts_() {
+  const std::string stagingDir =
+      this->getTargetOutputDirectory() + "staging";
+  if (!llvm::sys::fs::is_directory(stagingDir)) {
+    return;
+  }
+  CHIMERA_VERBOSE_AND_INCR("[ RUN  ] Packing the mutants artifacts");
+  // Collect first, the entries are removed once packed
+  std::error_code error;
+  std::vector<std::string> mutantDirs;
+  for (llvm::sys::fs::directory_iterator it(stagingDir, error), end;
+       !error && it != end; it.increment(error)) {
+    mutantDirs.push_back(it->path());
+  }
+  for (const std::string &mutantDir : mutantDirs) {
+    mutant::IdType id;
+    if (llvm::sys::path::filename(mutantDir).getAsInteger(10, id)) {
+      continue; // Not a mutant
     }
-  } else {
-    // Load matcher from filtered operators
-    for (operatorId = operatorIds.begin(); operatorId != operatorIds.end();
-         ++operatorId) {
-      /// Take the operator's mutators and add their matcher to
-      /// MutationTemplate's MatchFinder.
-      std::cout << "Operator : " << *operatorId << std::endl;
-      // Check if the operator exists
-      auto op = this->operators.find(*operatorId);
-      if (op != this->operators.end()) {
-        this->addMatchers_(finder, op->first, functionName);
+    std::vector<std::string> files;
+    for (llvm::sys::fs::directory_iterator it(mutantDir, error), end;
+         !error && it != end; it.increment(error)) {
+      files.push_back(it->path());
+    }
+    for (const std::string &file : files) {
+      auto buffer = llvm::MemoryBuffer::getFile(file);
+      if (!buffer ||
+          !this->packWriter->add(id, llvm::sys::path::filename(file).str(),
+                                 (*buffer)->getBufferStart(),
+                                 (*buffer)->getBufferSize())) {
+        ChimeraLogger::error("Couldn't pack " + file);
+        continue; // Keep it on disk
       }
+      llvm::sys::fs::remove(file);
     }
+    llvm::sys::fs::remove(mutantDir);
   }
+  llvm::sys::fs::remove(stagingDir);
+  CHIMERA_VERBOSE_PRE_DECR("[ DONE ] Packing the mutants artifacts");
 }
 
 /// @brief Run the internal ClangTool on a MatchFinder
@@ -647,12 +1716,15 @@ void chimera::MutationTemplate::addMatchers_(
 /// @return 0 OK
 ///         1 Not OK - Some error occured
 int chimera::MutationTemplate::run(clang::ast_matchers::MatchFinder &finder) {
+  if (this->countOnly) {
+    return this->count_(finder);
+  }
   int retval = 1; // Default error
   if (isGenerateMutants() || isGenerateMutantsReport()) {
-    ChimeraLogger::verboseAndIncr("[ RUN  ] Internal tool");
+    CHIMERA_VERBOSE_AND_INCR("[ RUN  ] Internal tool");
     
     // Create output folder
-    ChimeraLogger::verbose(
+    CHIMERA_VERBOSE(
         "Creating output folder " +
         clang::tooling::getAbsolutePath(this->getTargetOutputDirectory()));
     if (!chimera::fs::createDirectories(this->getTargetOutputDirectory())) {
@@ -660,19 +1732,129 @@ int chimera::MutationTemplate::run(clang::ast_matchers::MatchFinder &finder) {
       return 1;
     }
     
+    // Build the validation engines, mutants are checked in memory
+    const ValidationMode mode = this->validationMode;
+    const CompileCommand &command = this->compileCommand;
+    const std::string &target = this->targetPath;
+    const std::string validationPath = this->getValidationPath();
+    this->validationPool.reset(new ValidationPool(
+        this->validationJobs, [&mode, &command, &target, &validationPath]() {
+          return createMutantValidator(mode, command, target, validationPath);
+        }));
+    this->pendingMutants.reset(new PendingMutantQueue(
+        this->homOrder, this->homBudget, this->journal));
+    this->matches.reset(new MatchWorkList());
+    this->ordinal = 0;
+    this->candidateIndex = 0;
+    // Resuming, the remaining verdicts are journaled as well
+    if ((this->journaled || this->resume) &&
+        !this->journal.open(this->getTargetOutputDirectory() + "journal.csv",
+                            this->resume)) {
+      ChimeraLogger::fatal("Couldn't open the journal");
+      return 1;
+    }
+    if (this->resume) {
+      ChimeraLogger::info("Resuming " + this->targetPath + ": " +
+                          std::to_string(this->journal.size()) +
+                          " journaled verdicts");
+    }
+    // Without a budget a shard picks its mutations while they are applied
+    if (this->budget.isLimited()) {
+      this->sampler.reset(new MutantSampler(
+          this->budget, this->samplingStrategy, this->samplingSeed,
+          this->samplingRegionLines, this->shard,
+          this->getTargetFilename().str()));
+    }
+    if (this->budget.isLimited()) {
+      this->samplingStream.open(this->getTargetOutputDirectory() +
+                                "sampling_weights.csv");
+      if (!this->samplingStream.is_open()) {
+        ChimeraLogger::fatal("Couldn't open the sampling weights file");
+        return 1;
+      }
+    }
+    if (this->shard.isSharded()) {
+      // The ids from the first FOM mutant on are renumbered by the merge
+      this->shardStream.open(this->getTargetOutputDirectory() + "shard.csv");
+      if (!this->shardStream.is_open()) {
+        ChimeraLogger::fatal("Couldn't open the shard file");
+        return 1;
+      }
+      this->shardStream << "shard," << this->shard.getIndex() << ","
+                        << this->shard.getCount() << "," << this->mutantCounter
+                        << std::endl;
+    }
+
+    // The mutants are saved as edit scripts on the target, stored once
+    if (isGenerateMutants() &&
+        this->mutantStorage == mutant::MutantStorage::Delta) {
+      auto original = ::llvm::MemoryBuffer::getFile(this->targetPath);
+      if (!original) {
+        ChimeraLogger::fatal("Couldn't read the target " + this->targetPath);
+        return 1;
+      }
+      this->deltaWriter.reset(new mutant::MutantDeltaWriter(
+          this->getDeltaPath(), this->getTargetFilename().str(),
+          (*original)->getBuffer().str()));
+      if (!this->deltaWriter->isOpen()) {
+        ChimeraLogger::fatal("Couldn't open the delta file " +
+                             this->getDeltaPath());
+        return 1;
+      }
+    }
+    if (isGenerateMutants() &&
+        this->mutantStorage == mutant::MutantStorage::Pack) {
+      this->packWriter.reset(new pack::PackWriter(
+          this->getPackPath(), this->getTargetFilename().str()));
+      if (!this->packWriter->isOpen()) {
+        ChimeraLogger::fatal("Couldn't open the pack " + this->getPackPath());
+        return 1;
+      }
+    }
+
     // Open report stream
     if (this->openReportStream("report.csv")) {
-      // retval = this->tool.run(newFrontendActionFactory(&finder).get());
       // Run the ClangTool on a Finder FrontendAction
       // FIXME: Instead of using the ClantTool it coulbe be used directly the
       // CompilerInvocation.
       
-      retval = (ClangTool(::chimera::cd_utils::FlexibleCompilationDatabase(
-                              this->compileCommand),
-                          this->targetPath))
-                   .run(newFrontendActionFactory(&finder).get());
+      retval = this->runTool_(finder);
 
       this->closeReportStream();
+      if (this->samplingStream.is_open()) {
+        this->samplingStream.close();
+      }
+      if (this->shardStream.is_open()) {
+        this->shardStream.close();
+      }
+      this->journal.close();
+      if (this->trustViolations > 0) {
+        ChimeraLogger::error(
+            std::to_string(this->trustViolations) +
+            " sampled mutants of trusted mutators failed the check, their "
+            "unchecked mutants could be invalid: " +
+            this->getTargetOutputDirectory() + "report.csv");
+        this->trustViolations = 0;
+        retval = 1;
+      }
+      this->matches.reset();
+      this->contextIndex.clear();
+      this->pendingMutants.reset();
+      this->sampler.reset();
+      this->validationPool.reset();
+      if (this->deltaWriter && !this->deltaWriter->close()) {
+        ChimeraLogger::error("An error occurred writing " +
+                             this->getDeltaPath());
+      }
+      this->deltaWriter.reset();
+      if (this->packWriter) {
+        this->packArtifacts_();
+        if (!this->packWriter->close()) {
+          ChimeraLogger::error("An error occurred writing " +
+                               this->getPackPath());
+        }
+      }
+      this->packWriter.reset();
 
       // After-run tasks:
       // * Call onEndOfTranslationUnit on mutators
@@ -691,10 +1873,75 @@ int chimera::MutationTemplate::run(clang::ast_matchers::MatchFinder &finder) {
       ChimeraLogger::fatal("Couldn't open the report file");
     }
     ChimeraLogger::decrActualVLevel();
-    ChimeraLogger::verbose("[ DONE ] Internal tool");
+    CHIMERA_VERBOSE("[ DONE ] Internal tool");
   } else {
-    ChimeraLogger::verbose("[ SKIP ] Running internal tool is useless, nor "
-                           "mutants or report have to be saved. Skipping");
+    CHIMERA_VERBOSE("[ SKIP ] Running internal tool is useless, nor "
+                    "mutants or report have to be saved. Skipping");
+  }
+  return retval;
+}
+
+/// @brief Run the internal ClangTool on a MatchFinder, only counting the
+/// candidate mutations
+/// @details Neither the mutants nor the report are generated, thus the
+///          validation engines are not even built.
+/// @return 0 OK
+///         1 Not OK - Some error occured
+int chimera::MutationTemplate::count_(
+    clang::ast_matchers::MatchFinder &finder) {
+  CHIMERA_VERBOSE_AND_INCR("[ RUN  ] Counting the candidate mutations");
+  if (!chimera::fs::createDirectories(this->getTargetOutputDirectory())) {
+    ChimeraLogger::fatal("Couldn't create output folder");
+    return 1;
+  }
+  this->matches.reset(new MatchWorkList());
+  this->candidates.reset(new CandidateCounter());
+  int retval = this->runTool_(finder);
+  this->matches.reset();
+  this->contextIndex.clear();
+  if (!this->candidates->write(this->getTargetOutputDirectory(),
+                               this->countFormat)) {
+    ChimeraLogger::error("An error occurred writing the candidate counts in " +
+                         this->getTargetOutputDirectory());
+    retval = 1;
+  }
+  ChimeraLogger::info(this->targetPath + ": " +
+                      std::to_string(this->candidates->total()) +
+                      " candidate mutations");
+  this->candidates.reset();
+  CHIMERA_VERBOSE_PRE_DECR("[ DONE ] Counting the candidate mutations");
+  return retval;
+}
+
+/// @brief Run the internal ClangTool on a MatchFinder
+/// @details With the time report, the parsing and the AST traversal are
+///          timed: the parsing ends where the finder starts matching, the
+///          traversal where the mutation phase starts.
+int chimera::MutationTemplate::runTool_(
+    clang::ast_matchers::MatchFinder &finder) {
+  // The ClangTool keeps a reference to the database, it has to outlive it
+  ::chimera::cd_utils::FlexibleCompilationDatabase database(
+      this->compileCommand);
+  ClangTool tool(database, this->targetPath);
+  if (this->timeReport == nullptr) {
+    return tool.run(newFrontendActionFactory(&finder).get());
+  }
+  TimeReport::Clock::time_point parsingEnd;
+  ParsingDoneCallback parsingDone(parsingEnd);
+  finder.registerTestCallbackAfterParsing(&parsingDone);
+  this->traversalEnd = TimeReport::Clock::time_point();
+  const TimeReport::Clock::time_point start = TimeReport::Clock::now();
+  const int retval = tool.run(newFrontendActionFactory(&finder).get());
+  const TimeReport::Clock::time_point end = TimeReport::Clock::now();
+  finder.registerTestCallbackAfterParsing(nullptr);
+  if (parsingEnd != TimeReport::Clock::time_point()) {
+    this->timeReport->addTime(this->timeScope, TimePhase::Parse, start,
+                              parsingEnd);
+    this->timeReport->addTime(
+        this->timeScope, TimePhase::Matching, parsingEnd,
+        this->traversalEnd != TimeReport::Clock::time_point()
+            ? this->traversalEnd
+            : end);
   }
   return retval;
 }
@@ -704,17 +1951,17 @@ chimera::MutationTemplate::MutationTemplate(
     const clang::tooling::CompileCommand &compileCommand,
     std::string targetPath, std::string outputDirectory)
     : mutantCounter(mutantCounterInitial), compileCommand(compileCommand),
-      // In order to avoid multiple execution and problems with locations (they
-      // became invalid)
-      // the tool it's build with a CompilationDatabase with only one
-      // compileCommand
-      // The ClangTool.run implementation it's like that will be always executed
-      // the single compileCommand
-      // provided, independently of target
-      tool(chimera::cd_utils::FlexibleCompilationDatabase(this->compileCommand),
-           targetPath),
-      generateMutantsReport(false), generateMutants(false), reportStream() {
-  chimera::log::ChimeraLogger::verboseAndIncr(
+      generateMutantsReport(false), generateMutants(false),
+      mutantStorage(mutant::MutantStorage::Tree), reportStream(),
+      validationMode(ValidationMode::InMemory), validationJobs(1),
+      deferredHomValidation(false), schemata(false),
+      deduplicate(true), homOrder(0), homBudget(1000), countOnly(false),
+      countFormat(CountFormat::CSV), trustedMutators(false),
+      validationSample(-1), trustViolations(0), budget(),
+      samplingStrategy(SamplingStrategy::Uniform), samplingSeed(0),
+      samplingRegionLines(50), resume(false), journaled(false), ordinal(0),
+      candidateIndex(0), timeReport(nullptr) {
+  CHIMERA_VERBOSE_AND_INCR(
       "[ RUN  ] Building MutationTemplate");
   this->setOutputDirectory(outputDirectory);
   this->setTargetPath(targetPath);
@@ -723,48 +1970,53 @@ chimera::MutationTemplate::MutationTemplate(
 #ifdef _CHIMERA_DEBUG_
   chimera::cd_utils::dump(std::cout, this->compileCommand);
 #endif
-  chimera::log::ChimeraLogger::verbosePreDecr(
+  CHIMERA_VERBOSE_PRE_DECR(
       "[ DONE ] Building MutationTemplate");
 }
 
+chimera::MutationTemplate::~MutationTemplate() {}
+
 int chimera::MutationTemplate::analyze() {
   this->initMutantIds_();
   // Create a new finder
   MatchFinder finder;
-  ChimeraLogger::verbose(
+  CHIMERA_VERBOSE(
       0, "FunOp Configuration file not set. Loading all operators.");
   // Load matcher from operators
+  std::vector<m_operator::IdType> operatorIds;
   for (auto it = this->operators.begin(); it != this->operators.end(); ++it) {
-    { /// Take the operator's mutators and add their matcher to
-      /// MutationTemplate's MatchFinder.
-      this->addMatchers_(finder, it->first);
-    }
+    operatorIds.push_back(it->first);
   }
-  return this->run(finder);
+  this->addMatchers_(finder, operatorIds);
+  const int retval = this->run(finder);
+  // The callbacks live as long as the finder
+  this->sharedCallbacks.clear();
+  this->visitorBackend.reset();
+  return retval;
 }
 
 int chimera::MutationTemplate::analyze(const conf::FunOpConfMap &map) {
   this->initMutantIds_();
   // Create a new finder
   MatchFinder finder;
-  std::string functionName = ""; // functionName
-  // Check if there is CHIMERA_ALL_FUNCTIONS specifier
-  std::map<std::string, std::vector<std::string>>::const_iterator row =
-      map.find("CHIMERA_ALL_FUNCTIONS");
-  if (row != map.end()) {
-    // Found, Apply to all functions
-    ChimeraLogger::verbose("Found CHIMERA_ALL_FUNCTIONS");
-    { this->addMatchers_(finder, row->second, functionName); }
-  } else {
-    // Not Found CHIMERA_ALL_FUNCTIONS
-    // Iterate on map
-    for (row = map.begin(); row != map.end(); ++row) {
-      functionName = row->first; // Filter by functionName
-      std::cout << "Function : " << functionName << std::endl;
-      this->addMatchers_(finder, row->second, functionName);
-    }
+  std::vector<m_operator::IdType> operatorIds;
+  for (auto op = this->operators.begin(); op != this->operators.end(); ++op) {
+    operatorIds.push_back(op->first);
   }
-  return run(finder);
+  // Each mutator matches all the function definitions once, the selector
+  // tells which ones it has to descend into
+  this->functionSelector.reset(new FunctionSelector(map, operatorIds));
+  const std::vector<m_operator::IdType> selectedIds =
+      this->functionSelector->getOperators();
+  for (const m_operator::IdType &operatorId : selectedIds) {
+    CHIMERA_VERBOSE("Operator : " + operatorId);
+  }
+  this->addMatchers_(finder, selectedIds, this->functionSelector.get());
+  const int retval = this->run(finder);
+  // The callbacks live as long as the finder
+  this->sharedCallbacks.clear();
+  this->visitorBackend.reset();
+  return retval;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,179 @@
+//===- TimeReport.cpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file TimeReport.cpp
+/// \brief This file implements the class TimeReport
+//===----------------------------------------------------------------------===//
+
+#include "Core/TimeReport.h"
+#include "Utils.h"
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+
+#include <algorithm>
+
+using ::chimera::json::quote;
+
+static const char *phaseNames[] = {"preprocess", "parse",  "matching",
+                                   "match",      "mutate", "check",
+                                   "save",       "report", "total"};
+static const char *counterNames[] = {"candidates", "fine_passes", "valid",
+                                     "invalid", "bytes_written"};
+
+/// @brief Nearest rank percentile of sorted latencies, 0 if none
+static double percentile(const ::std::vector<double> &sorted, unsigned pct) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  ::std::size_t rank = (sorted.size() * pct + 99) / 100;
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+bool chimera::TimeScope::operator<(const TimeScope &other) const {
+  if (this->file != other.file) {
+    return this->file < other.file;
+  }
+  if (this->operatorId != other.operatorId) {
+    return this->operatorId < other.operatorId;
+  }
+  return this->mutatorId < other.mutatorId;
+}
+
+void chimera::TimeReport::addTime(const TimeScope &scope, TimePhase phase,
+                                  Clock::time_point start,
+                                  Clock::time_point end) {
+  const double seconds =
+      ::std::chrono::duration<double>(end - start).count();
+  ::std::lock_guard<::std::mutex> lock(this->entriesMutex);
+  this->entries[scope].times[static_cast<int>(phase)] += seconds;
+}
+
+void chimera::TimeReport::addCount(const TimeScope &scope,
+                                   TimeCounter counter,
+                                   ::std::uint64_t value) {
+  ::std::lock_guard<::std::mutex> lock(this->entriesMutex);
+  this->entries[scope].counters[static_cast<int>(counter)] += value;
+}
+
+void chimera::TimeReport::addCheck(const TimeScope &scope, double seconds) {
+  ::std::lock_guard<::std::mutex> lock(this->entriesMutex);
+  Entry &entry = this->entries[scope];
+  entry.times[static_cast<int>(TimePhase::Check)] += seconds;
+  entry.checks.push_back(seconds);
+}
+
+::std::map<chimera::TimeScope, chimera::TimeReport::Entry>
+chimera::TimeReport::rollUp() const {
+  ::std::lock_guard<::std::mutex> lock(this->entriesMutex);
+  ::std::map<TimeScope, Entry> result = this->entries;
+  for (const auto &entry : this->entries) {
+    if (entry.first.mutatorId.empty()) {
+      continue; // Already a total
+    }
+    const TimeScope totals[] = {
+        {entry.first.file, entry.first.operatorId, ""},
+        {entry.first.file, "", ""}};
+    for (const TimeScope &scope : totals) {
+      Entry &total = result[scope];
+      for (int i = 0; i < static_cast<int>(TimePhase::Count_); ++i) {
+        total.times[i] += entry.second.times[i];
+      }
+      for (int i = 0; i < static_cast<int>(TimeCounter::Count_); ++i) {
+        total.counters[i] += entry.second.counters[i];
+      }
+      total.checks.insert(total.checks.end(), entry.second.checks.begin(),
+                          entry.second.checks.end());
+    }
+  }
+  for (auto &entry : result) {
+    ::std::sort(entry.second.checks.begin(), entry.second.checks.end());
+  }
+  return result;
+}
+
+void chimera::TimeReport::writeJSON(::std::ostream &stream) const {
+  const ::std::map<TimeScope, Entry> report = this->rollUp();
+  stream << "{\n  \"entries\": [";
+  const char *separator = "\n";
+  for (const auto &entry : report) {
+    stream << separator << "    {\"file\": " << quote(entry.first.file)
+           << ", \"operator\": " << quote(entry.first.operatorId)
+           << ", \"mutator\": " << quote(entry.first.mutatorId)
+           << ",\n     \"times\": {";
+    for (int i = 0; i < static_cast<int>(TimePhase::Count_); ++i) {
+      stream << (i == 0 ? "" : ", ") << quote(phaseNames[i]) << ": "
+             << entry.second.times[i];
+    }
+    stream << "},\n     \"counters\": {";
+    for (int i = 0; i < static_cast<int>(TimeCounter::Count_); ++i) {
+      stream << (i == 0 ? "" : ", ") << quote(counterNames[i]) << ": "
+             << entry.second.counters[i];
+    }
+    const ::std::vector<double> &checks = entry.second.checks;
+    stream << "},\n     \"checks\": {\"count\": " << checks.size()
+           << ", \"total\": "
+           << entry.second.times[static_cast<int>(TimePhase::Check)]
+           << ", \"p50\": " << percentile(checks, 50)
+           << ", \"p99\": " << percentile(checks, 99) << "}}";
+    separator = ",\n";
+  }
+  stream << (report.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+void chimera::TimeReport::writeTable(::llvm::raw_ostream &stream) const {
+  const ::std::map<TimeScope, Entry> report = this->rollUp();
+  stream << "===-------------------------------------------------------------"
+            "------------===\n"
+         << "  Time report: phases in seconds, check latencies in ms\n"
+         << "===-------------------------------------------------------------"
+            "------------===\n";
+  stream << ::llvm::left_justify("scope", 28);
+  for (const char *name : phaseNames) {
+    stream << ::llvm::right_justify(::std::string(name).substr(0, 8), 9);
+  }
+  for (const char *name : counterNames) {
+    stream << ::llvm::right_justify(::std::string(name).substr(0, 10), 11);
+  }
+  stream << ::llvm::right_justify("p50", 9) << ::llvm::right_justify("p99", 9)
+         << "\n";
+  for (const auto &entry : report) {
+    // Mutators indented under their operator, under their file
+    ::std::string name;
+    if (!entry.first.mutatorId.empty()) {
+      name = "    " + entry.first.mutatorId;
+    } else if (!entry.first.operatorId.empty()) {
+      name = "  " + entry.first.operatorId;
+    } else {
+      name = ::llvm::sys::path::filename(entry.first.file).str();
+    }
+    stream << ::llvm::left_justify(name.substr(0, 27), 28);
+    for (double time : entry.second.times) {
+      stream << ::llvm::format("%9.3f", time);
+    }
+    for (::std::uint64_t counter : entry.second.counters) {
+      stream << ::llvm::format("%11llu",
+                               static_cast<unsigned long long>(counter));
+    }
+    stream << ::llvm::format("%9.2f", percentile(entry.second.checks, 50) * 1e3)
+           << ::llvm::format("%9.2f", percentile(entry.second.checks, 99) * 1e3)
+           << "\n";
+  }
+}
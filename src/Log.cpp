@@ -32,7 +32,12 @@ INITIALIZE_EASYLOGGINGPP
 const char* chimera::log::ChimeraLogger::loggerName = "chimeraLogger";  ///< Member initialization
 el::Configurations chimera::log::ChimeraLogger::configurator =
     el::Configurations();
-log::VerboseLevel chimera::log::ChimeraLogger::actualVLevel = 0;
+thread_local log::VerboseLevel chimera::log::ChimeraLogger::actualVLevel = 0;
+thread_local std::string chimera::log::ChimeraLogger::context;
+std::atomic<bool> chimera::log::ChimeraLogger::verboseEnabled(false);
+std::atomic<log::VerboseLevel> chimera::log::ChimeraLogger::maxVLevel(0);
+// After the easylogging++ storage, so that it's destroyed (drained) first
+log::AsyncLogSink chimera::log::ChimeraLogger::sink;
 
 void chimera::log::ChimeraLogger::init() {
   /// Configure el++ : chimeraLogger
@@ -76,6 +81,9 @@ void chimera::log::ChimeraLogger::initVerbose() {
   configurator.set(el::Level::Verbose, el::ConfigurationType::Format,
                    "[CHIMERA VERBOSE-%vlevel] %msg");
   el::Loggers::reconfigureLogger(loggerName, configurator);
+  verboseEnabled = true;
+  // The pipeline doesn't wait on the standard output
+  sink.start();
 }
 
 void chimera::log::ChimeraLogger::initTrace() {
@@ -104,10 +112,89 @@ void chimera::log::ChimeraLogger::verbose(VerboseLevel vlevel,
   // Check the verbose level
   if (!VLOG_IS_ON(vlevel))
     return;
-  std::string message = "";
+  std::string message = context;
   for (unsigned char i = 0; i < vlevel; i++) {
     message += "=";
   }
   message += "> " + msg;
-  CVLOG(vlevel,loggerName) << message;
+  if (sink.isStarted()) {
+    sink.push(vlevel, std::move(message));
+  } else {
+    CVLOG(vlevel, loggerName) << message;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncLogSink
+chimera::log::AsyncLogSink::AsyncLogSink(std::size_t capacity)
+    : ring(capacity > 0 ? capacity : 1), head(0), count(0), writing(false),
+      stopping(false), started(false) {}
+
+chimera::log::AsyncLogSink::~AsyncLogSink() { this->stop(); }
+
+void chimera::log::AsyncLogSink::start() {
+  std::lock_guard<std::mutex> lock(this->ringMutex);
+  if (this->started) {
+    return;
+  }
+  this->started = true;
+  this->writer = std::thread(&AsyncLogSink::write, this);
+}
+
+void chimera::log::AsyncLogSink::push(VerboseLevel vlevel, std::string &&msg) {
+  {
+    std::unique_lock<std::mutex> lock(this->ringMutex);
+    this->notFull.wait(lock,
+                       [this] { return this->count < this->ring.size(); });
+    Entry &entry = this->ring[(this->head + this->count) % this->ring.size()];
+    entry.vlevel = vlevel;
+    entry.msg = std::move(msg);
+    ++this->count;
+  }
+  this->notEmpty.notify_one();
+}
+
+void chimera::log::AsyncLogSink::flush() {
+  std::unique_lock<std::mutex> lock(this->ringMutex);
+  this->notFull.wait(
+      lock, [this] { return this->count == 0 && !this->writing; });
+}
+
+void chimera::log::AsyncLogSink::write() {
+  for (;;) {
+    Entry entry;
+    {
+      std::unique_lock<std::mutex> lock(this->ringMutex);
+      this->notEmpty.wait(
+          lock, [this] { return this->stopping || this->count > 0; });
+      if (this->count == 0) {
+        // Stopping and nothing left to write
+        return;
+      }
+      entry = std::move(this->ring[this->head]);
+      this->head = (this->head + 1) % this->ring.size();
+      --this->count;
+      this->writing = true;
+    }
+    this->notFull.notify_all();
+    CVLOG(entry.vlevel, ChimeraLogger::loggerName) << entry.msg;
+    {
+      std::lock_guard<std::mutex> lock(this->ringMutex);
+      this->writing = false;
+    }
+    // Also the flushing callers wait on it
+    this->notFull.notify_all();
+  }
+}
+
+void chimera::log::AsyncLogSink::stop() {
+  {
+    std::lock_guard<std::mutex> lock(this->ringMutex);
+    if (!this->started) {
+      return;
+    }
+    this->stopping = true;
+  }
+  this->notEmpty.notify_all();
+  this->writer.join();
 }
@@ -24,6 +24,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Operators/Adder/Mutators.h"
+#include "Core/Matchers.h"
 #include "llvm/Support/ErrorHandling.h"
 
 #include "Log.h"
@@ -46,19 +47,6 @@ using namespace chimera::log;
 #define GET_PARENT_NODE(res_matcher, child, casting_type)                      \
   ((res_matcher.Context->getParents(*child))[0]).get<casting_type>()
 
-#define XHS_INTERNAL_MATCHER(id)                                               \
-  ignoringParenImpCasts(expr().bind(                                           \
-      id)) //< x hand side matcher without parenthesis and implicit casts
-
-// Retrieve hs without implicit cast and parenthesis,
-// also bypassing explicit casting, this is done arriving to the explicit cast
-// and then going on the child (has), where the above rule is applied again
-#define XHS_MATCHER(type, id)                                                  \
-  allOf(hasType(qualType(hasCanonicalType(asString(type)))),                   \
-        anyOf(XHS_INTERNAL_MATCHER(id),                                        \
-              ignoringParenImpCasts(                                           \
-                  castExpr(has(expr(XHS_INTERNAL_MATCHER(id)))))))
-
 
 /// \brief It is used to retrieve the node, it hides the binding string.
 ///        In Mutator.h there is code template snippet that should be fine for
@@ -84,18 +72,17 @@ StatementMatcher chimera::adder::MutatorAdder::getStatementMatcher() {
   return stmt(
     binaryOperator(
       anyOf(hasOperatorName("+"), hasOperatorName("-")),
-      hasRHS(XHS_MATCHER("int", "rhs")),
-      hasLHS(XHS_MATCHER("int", "lhs"))
-    ).bind("adder_op"),
-
-    unless(
-          anyOf(
-            hasAncestor(callExpr()), //uncomment to avoid mutation of input parameters of a function call
-            hasAncestor(arraySubscriptExpr()))
-    )
+      hasRHS(matchers::operand(matchers::isInt(), "rhs")),
+      hasLHS(matchers::operand(matchers::isInt(), "lhs"))
+    ).bind("adder_op")
   );
 }
 
+::chimera::mutator::MatchBackend
+chimera::adder::MutatorAdder::getMatchBackend() const {
+  return ::chimera::mutator::BinaryOperatorVisitorBackend;
+}
+
 /// \brief  This method implements the fine grained matching rules, because it is
 ///         not possible in an easy way to specify that the node matched has
 ///         to be the last "+"" operator of a chain of adds.
@@ -107,6 +94,12 @@ bool chimera::adder::MutatorAdder::match(const NodeType &node) {
     const BinaryOperator *bop = node.Nodes.getNodeAs<BinaryOperator>("adder_op");
     assert(bop && "BinaryOperator is nullptr");
 
+    // Discard the operations inside a function call or an array subscript
+    const ::chimera::StmtContext &context = this->getContext(node, *bop);
+    if (context.call != nullptr || context.subscript != nullptr) {
+      return false;
+    }
+
     // Second operation: extract lhs and rhs
     const Expr *internalLhs = node.Nodes.getNodeAs<Expr>("lhs");
     const Expr *internalRhs = node.Nodes.getNodeAs<Expr>("rhs");
@@ -132,30 +125,23 @@ bool chimera::adder::MutatorAdder::match(const NodeType &node) {
 
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Debug
-    char log_string[500];
-    Rewriter rw(*(node.SourceManager), node.Context->getLangOpts());
-    ChimeraLogger::verbose("********************************************************\nMatched operation:");
+    CHIMERA_VERBOSE("********************************************************\nMatched operation:");
 
-    sprintf(log_string, "Operation: %s ==> [%s]", rw.getRewrittenText(bop->getSourceRange()).c_str(),bop->getOpcodeStr().str().c_str());
-    ChimeraLogger::verbose(log_string);
+    CHIMERA_VERBOSE(std::string("Operation: ") + getSourceText(node, bop->getSourceRange()) + " ==> [" + bop->getOpcodeStr().str() + "]");
 
-    sprintf(log_string, "LHS: %s", rw.getRewrittenText(lhs->getSourceRange()).c_str());
-    ChimeraLogger::verbose(log_string);
+    CHIMERA_VERBOSE(std::string("LHS: ") + getSourceText(node, lhs->getSourceRange()));
 
-    sprintf(log_string, "RHS: %s\n", rw.getRewrittenText(rhs->getSourceRange()).c_str());
-    ChimeraLogger::verbose(log_string);
+    CHIMERA_VERBOSE(std::string("RHS: ") + getSourceText(node, rhs->getSourceRange()) + "\n");
     //////////////////////////////////////////////////////////////////////////////////////////// 
 
-    if(rw.getRewrittenText(lhs->getSourceRange()) == "") return false;
-    if(rw.getRewrittenText(rhs->getSourceRange()) == "") return false;
+    if(!isRewritable(node, lhs->getSourceRange())) return false;
+    if(!isRewritable(node, rhs->getSourceRange())) return false;
 
     return true;
 }
 
 Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType type, Rewriter &rw) {
 
-    char log_info[500];
-
     // Retrieve a pointer to function declaration (or template function declaration) to insert global variables before it
     const FunctionDecl *funDecl = node.Nodes.getNodeAs<FunctionDecl>("functionDecl");
     const FunctionTemplateDecl *templDecl = (FunctionTemplateDecl*)(GET_PARENT_NODE(node, funDecl, FunctionTemplateDecl));
@@ -267,19 +253,15 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
       
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Debug
-    ChimeraLogger::verbose("********************************************************\nDump binary operation:");
+    CHIMERA_VERBOSE("********************************************************\nDump binary operation:");
 
-    sprintf(log_info, "Operation: %s  ==> [%s]",rw.getRewrittenText(bop->getSourceRange()).c_str(),bop->getOpcodeStr().str().c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE(std::string("Operation: ") + rw.getRewrittenText(bop->getSourceRange()) + "  ==> [" + bop->getOpcodeStr().str() + "]");
 
-    sprintf(log_info, "LHS: %s", lhsString.c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE(std::string("LHS: ") + lhsString);
 
-    sprintf(log_info, "RHS: %s", rhsString.c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE(std::string("RHS: ") + rhsString);
 
-    sprintf(log_info, "Mutation in: %s\n", bopReplacement.c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE(std::string("Mutation in: ") + bopReplacement + "\n");
 
     //////////////////////////////////////////////////////////////////////////////////////////// 
 
@@ -288,7 +270,7 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
 
     // Stop if the current node (bop) has no parents
     if( node.Context->getParents(*bop).empty() ) { 
-      ChimeraLogger::verbose("No more parents. Exiting\n");
+      CHIMERA_VERBOSE("No more parents. Exiting\n");
       break; 
     }
 
@@ -297,7 +279,7 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
 
     if(parentType == "BinaryOperator"){
       // If the parent is a BinaryOperator then assign to bop its parent
-      ChimeraLogger::verbose("Parent is a BOP\n");
+      CHIMERA_VERBOSE("Parent is a BOP\n");
       bop = (BinaryOperator*)(GET_PARENT_NODE(node, bop, BinaryOperator));
 
     } else if((parentType == "ParenExpr")){
@@ -307,25 +289,23 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
       while( ( PARENT_NODE_TYPE(node, parens) == "ParenExpr") ){
           parens = (ParenExpr*)(GET_PARENT_NODE(node, parens, ParenExpr));
       }
-      ChimeraLogger::verbose("Parens skipped successfully.\n");
+      CHIMERA_VERBOSE("Parens skipped successfully.\n");
 
       // If the content of parenthesis is not a BinaryOperator then exit else assign
       // parenthesis content to bop
       if( (PARENT_NODE_TYPE(node, parens) != "BinaryOperator") ) {
-        sprintf(log_info, "WARNING: Unexpected parens content of type [%s]. Exiting...\n", PARENT_NODE_TYPE(node, parens).str().c_str());
-        ChimeraLogger::verbose(log_info);
+        CHIMERA_VERBOSE(std::string("WARNING: Unexpected parens content of type [") + PARENT_NODE_TYPE(node, parens).str() + "]. Exiting...\n");
         bop = NULL;
       } else bop = (BinaryOperator*)(GET_PARENT_NODE(node, parens, BinaryOperator));
 
     } else if((parentType == "FunDecl") || (parentType == "VarDecl") || (parentType == "ImplicitCastExpr")){
       // If the parent is a FunDecl or a VarDecl then exit
-      ChimeraLogger::verbose("Function o Variable Declaration reached. Exiting...\n");
+      CHIMERA_VERBOSE("Function o Variable Declaration reached. Exiting...\n");
       bop = NULL;
 
     } else {
       // If the parent is not one of the previous IFs, then exit and print the unexpected type
-      sprintf(log_info, "WARNING: Unexpected parent of type [%s]. Exiting...\n", parentType.c_str());
-      ChimeraLogger::verbose(log_info);
+      CHIMERA_VERBOSE(std::string("WARNING: Unexpected parent of type [") + parentType + "]. Exiting...\n");
       bop = NULL;
     }
 
@@ -342,8 +322,7 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
         
       // If a new BinaryOperator has been assigned to bop (indeed bop is not NULL) 
       // and it's a =, then exit 
-      sprintf(log_info, "BOP opcod is [%s]. Exiting...\n", bop->getOpcodeStr().str().c_str());
-      ChimeraLogger::verbose(log_info);
+      CHIMERA_VERBOSE(std::string("BOP opcod is [") + bop->getOpcodeStr().str() + "]. Exiting...\n");
       bop = NULL;
     }
 
@@ -364,10 +343,10 @@ void chimera::adder::MutatorAdder::onCreatedMutant(const ::std::string &mDir) {
   ::std::error_code error;
   ::llvm::raw_fd_ostream report(mDir + this->reportName + ".csv", error, ::llvm::sys::fs::OpenFlags::F_Append);
 
-  ChimeraLogger::verbose("****************************************************\nStart writing report");
+  CHIMERA_VERBOSE("****************************************************\nStart writing report");
 
   while( !(this->mutationsInfo.empty()) ){
-    ChimeraLogger::verbose("Writing element...");
+    CHIMERA_VERBOSE("Writing element...");
 
     MutatorAdder::MutationInfo mutationInfo = this->mutationsInfo.back();
     report << mutationInfo.nabId << "," << mutationInfo.line << ","
@@ -378,5 +357,5 @@ void chimera::adder::MutatorAdder::onCreatedMutant(const ::std::string &mDir) {
     this->mutationsInfo.pop_back();
   }
   report.close();
-  ChimeraLogger::verbose("****************************************************\nReport written successfully");
+  CHIMERA_VERBOSE("****************************************************\nReport written successfully");
 }
\ No newline at end of file
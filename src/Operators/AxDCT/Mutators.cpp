@@ -46,19 +46,6 @@ using namespace clang::ast_type_traits;
 #define GET_PARENT_NODE(res_matcher, child, casting_type)                      \
   ((res_matcher.Context->getParents(*child))[0]).get<casting_type>()
 
-#define XHS_INTERNAL_MATCHER(id)                                               \
-  ignoringParenImpCasts(expr().bind(                                           \
-      id)) //< x hand side matcher without parenthesis and implicit casts
-
-// Retrieve hs without implicit cast and parenthesis,
-// also bypassing explicit casting, this is done arriving to the explicit cast
-// and then going on the child (has), where the above rule is applied again
-#define XHS_MATCHER(type, id)                                                  \
-  allOf(hasType(qualType(hasCanonicalType(asString(type)))),                   \
-        anyOf(XHS_INTERNAL_MATCHER(id),                                        \
-              ignoringParenImpCasts(                                           \
-                  castExpr(has(expr(XHS_INTERNAL_MATCHER(id)))))))
-
 
 /// \brief It is used to retrieve the node, it hides the binding string.
 ///        In Mutator.h there is code template snippet that should be fine for
@@ -77,15 +64,15 @@ bool chimera::axdct::MutatorAxDCT::getMatchedNode(const NodeType &node, DynTyped
 ///         returning the statement matcher to match the inner for loop
 StatementMatcher chimera::axdct::MutatorAxDCT::getStatementMatcher() {
   return stmt(
-    forStmt(
-      unless(hasAncestor(forStmt()))
-    ).bind("outer_for_stmt")
+    forStmt().bind("outer_for_stmt")
   );
 }
 
-/// \brief  Coarse grain is enough to identify the inner for loop
+/// \brief  Only the outermost for loop is mutated
 bool chimera::axdct::MutatorAxDCT::match(const NodeType &node) {
-    return true;
+    const ForStmt *forStmt = node.Nodes.getNodeAs<ForStmt>("outer_for_stmt");
+    assert(forStmt && "ForStmt is nullptr");
+    return this->getContext(node, *forStmt).forStmt == nullptr;
 }
 
 Rewriter &chimera::axdct::MutatorAxDCT::mutate(const NodeType &node, MutatorType type, Rewriter &rw) {
@@ -138,9 +125,7 @@ Rewriter &chimera::axdct::MutatorAxDCT::mutate(const NodeType &node, MutatorType
       
     //////////////////////////////////////////////////////////////////////////////////////////
     // Debug
-    char debug_info[500];
-
-    ChimeraLogger::verbose("***************************************************\nDump for loop:");
+    CHIMERA_VERBOSE("***************************************************\nDump for loop:");
 
     // sprintf(debug_info,"Statement: %s", rw.getRewrittenText(forStmt->getSourceRange()).c_str());
     // ChimeraLogger::verbose(debug_info);
@@ -187,24 +172,19 @@ Rewriter &chimera::axdct::MutatorAxDCT::mutate(const NodeType &node, MutatorType
   
     //////////////////////////////////////////////////////////////////////////////////////////
     // Debug
-    ChimeraLogger::verbose("***************************************************\nDump inner for loop:");
+    CHIMERA_VERBOSE("***************************************************\nDump inner for loop:");
 
-    sprintf(debug_info,"Statement: %s", rw.getRewrittenText(forStmt->getSourceRange()).c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE(std::string("Statement: ") + rw.getRewrittenText(forStmt->getSourceRange()));
     
-    sprintf(debug_info, "Condition: %s", innerCondString.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE(std::string("Condition: ") + innerCondString);
 
-    sprintf(debug_info, "Condition Variable: %s", innerCondVariableString.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE(std::string("Condition Variable: ") + innerCondVariableString);
 
-    sprintf(debug_info, "Condition Variable: %s", innerCondVariableString.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE(std::string("Condition Variable: ") + innerCondVariableString);
 
-    sprintf(debug_info, "Mutate condition in: %s", condReplacement.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE(std::string("Mutate condition in: ") + condReplacement);
 
-    ChimeraLogger::verbose("****************************************************\n");
+    CHIMERA_VERBOSE("****************************************************\n");
 
     ////////////////////////////////////////////////////////////////////////////////////////// 
 
@@ -222,10 +202,10 @@ void chimera::axdct::MutatorAxDCT::onCreatedMutant(const ::std::string &mDir) {
   ::llvm::raw_fd_ostream report(mDir + "axdct_report.csv", error, ::llvm::sys::fs::OpenFlags::F_Append);
   ::std::vector<MutationInfo> cMutationsInfo = this->mutationsInfo;
 
-  ChimeraLogger::verbose("****************************************************\nStart writing report");
+  CHIMERA_VERBOSE("****************************************************\nStart writing report");
 
   while( !(this->mutationsInfo.empty()) ){
-    ChimeraLogger::verbose("Writing element...");
+    CHIMERA_VERBOSE("Writing element...");
 
     MutatorAxDCT::MutationInfo mutationInfo = this->mutationsInfo.back();
     report << mutationInfo.baseId << "," << mutationInfo.line 
@@ -234,5 +214,5 @@ void chimera::axdct::MutatorAxDCT::onCreatedMutant(const ::std::string &mDir) {
     this->mutationsInfo.pop_back();
   }
   report.close();
-  ChimeraLogger::verbose("****************************************************\nReport written successfully\n");
+  CHIMERA_VERBOSE("****************************************************\nReport written successfully\n");
 }
\ No newline at end of file
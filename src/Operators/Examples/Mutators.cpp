@@ -60,6 +60,18 @@ chimera::examples::MutatorGreaterOpReplacement::getStatementMatcher() {
                     ));
 }
 
+::chimera::mutator::MatchBackend
+chimera::examples::MutatorGreaterOpReplacement::getMatchBackend() const {
+  return ::chimera::mutator::BinaryOperatorVisitorBackend;
+}
+
+/// \brief Replacing a relational operator with another one yields the same
+///        syntactic structure, the mutants don't need to be checked
+::chimera::mutator::ValidationPolicy
+chimera::examples::MutatorGreaterOpReplacement::getValidationPolicy() const {
+  return ::chimera::mutator::NeverValidate;
+}
+
 /// \brief This method implements the fine grained matching rules, indeed it is
 ///        not possible in an easy way to specify that the node matched it has
 ///        not to be part of the condition expression of a for statement
@@ -93,15 +105,17 @@ bool chimera::examples::MutatorGreaterOpReplacement::match(
   return true;
 }
 
-::clang::Rewriter &chimera::examples::MutatorGreaterOpReplacement::mutate(
+bool chimera::examples::MutatorGreaterOpReplacement::produceEdits(
     const ::chimera::mutator::NodeType &node,
-    ::chimera::mutator::MutatorType type, ::clang::Rewriter &rw) {
+    ::chimera::mutator::MutatorType type,
+    ::chimera::mutant::EditScript &edits) {
   // As first operation always retrieve the node
   const BinaryOperator *op = node.Nodes.getNodeAs<BinaryOperator>("greater_op");
   // Assert a precondition
   assert(op != nullptr && "getNodeAs returned a nullptr");
 
-  // The rewriter object passed can be used to "mutate" the source code
+  // The mutation is described as edits on the original source code, the
+  // Mutation Template applies them (no Rewriter is needed)
   // In this case there are two mutation types, so the type parameter will
   // assume values: 0 and 1.
   // Select the correct replacement using the mutation type
@@ -119,11 +133,12 @@ bool chimera::examples::MutatorGreaterOpReplacement::match(
   }
 
   // Get the left and right hand side of the operation
-  std::string lhs = rw.getRewrittenText(op->getLHS()->getSourceRange());
-  std::string rhs = rw.getRewrittenText(op->getRHS()->getSourceRange());
+  std::string lhs = getSourceText(node, op->getLHS()->getSourceRange());
+  std::string rhs = getSourceText(node, op->getRHS()->getSourceRange());
 
   // Replace all the text of the binary operator, substituting the operation
   // (which bind lhs and rhs) with the replacement
-  rw.ReplaceText(op->getSourceRange(), lhs + " " + opReplacement + " " + rhs);
-  return rw;
+  replaceText(node, op->getSourceRange(),
+              lhs + " " + opReplacement + " " + rhs, edits);
+  return true;
 }
@@ -7,6 +7,7 @@
 
 #include "Operators/FLAP/Operator.h"
 #include "Operators/FLAP/Mutators.h"
+#include "Core/Matchers.h"
 
 #include "Log.h"
 #include "llvm/Support/Debug.h"
@@ -24,19 +25,6 @@ using namespace chimera::mutator;
 ///////////////////////////////////////////////////////////////////////////////
 // Flap operation mutator
 
-#define XHS_INTERNAL_MATCHER(id)                                               \
-  ignoringParenImpCasts(expr().bind(                                           \
-      id)) //< x hand side matcher without parenthesis and implicit casts
-
-// Retrieve hs without implicit cast and parenthesis,
-// also bypassing explicit casting, this is done arriving to the explicit cast
-// and then going on the child (has), where the above rule is applied again
-#define XHS_MATCHER(type, id)                                                  \
-  allOf(hasType(qualType(hasCanonicalType(asString(type)))),                   \
-        anyOf(XHS_INTERNAL_MATCHER(id),                                        \
-              ignoringParenImpCasts(                                           \
-                  castExpr(has(expr(XHS_INTERNAL_MATCHER(id)))))))
-
 static ::std::string mapOpCode(::clang::BinaryOperator::Opcode code) {
   ::std::string retString = "";
   switch (code) {
@@ -89,37 +77,19 @@ chimera::flapmutator::FLAPFloatOperationMutator::getStatementMatcher() {
   // Match any float/double binary operation, leave to the match fine grain the
   // specific operation types
   return stmt(
-      // Match the Bop
-      anyOf(binaryOperator(hasLHS(XHS_MATCHER("float", "lhs")),
-                           hasRHS(XHS_MATCHER("float", "rhs")))
-                .bind("floatOp"),
-            binaryOperator(hasLHS(XHS_MATCHER("double", "lhs")),
-                           hasRHS(XHS_MATCHER("double", "rhs")))
-                .bind("doubleOp")),
-      // The form anyOf(,anything()) allows to TRY a match with a matcher
-      // anything() put as last allows to try each matcher without the need to
-      // match any of them
-      // Retrieve a possible assignment which the bop is RHS
-      anyOf(hasAncestor(
-                binaryOperator(hasOperatorName("=")).bind("externalAssignOp")),
-            anything()),
-      //          ignoringParenImpCasts(
-      //              hasParent(
-      //                  castExpr(
-      //                      hasParent(
-      //                          binaryOperator(hasOperatorName("=")).bind(
-      //                              "externalAssignOp")))))),),
-      anyOf(
-          // Retrieve possible controlStmts in the surroundings
-          hasAncestor(forStmt().bind("forStmt")),
-          hasAncestor(whileStmt().bind("whileStmt")),
-          hasAncestor(doStmt().bind("doStmt")),
-          hasAncestor(ifStmt().bind("ifStmt")), anything()),
-      // Unless it is:
-      //  - Inside a function call
-      //  - Inside an arraySubscript
-      unless(
-          anyOf(hasAncestor(callExpr()), hasAncestor(arraySubscriptExpr()))));
+      // Match the Bop, binding floatOp or doubleOp by the operands' types
+      matchers::floatOperation());
+}
+
+::std::string
+chimera::flapmutator::FLAPFloatOperationMutator::getMatcherKey() const {
+  // Shared with the VPA mutators, the mixed precision is rejected in match
+  return matchers::floatOperationKey;
+}
+
+::chimera::mutator::MatchBackend
+chimera::flapmutator::FLAPFloatOperationMutator::getMatchBackend() const {
+  return ::chimera::mutator::BinaryOperatorVisitorBackend;
 }
 
 static const BinaryOperator *getBop(const ::chimera::mutator::NodeType &node) {
@@ -136,6 +106,17 @@ bool chimera::flapmutator::FLAPFloatOperationMutator::match(
   // Remove all unsupported binary operation
   // Retrieve the node
   const BinaryOperator *bop = getBop(node);
+  // The surroundings are looked up in the context index
+  const ::chimera::StmtContext &context = this->getContext(node, *bop);
+  // Skip the operations inside a function call or an array subscript
+  if (context.call != nullptr || context.subscript != nullptr) {
+    return false;
+  }
+  // The shared matcher accepts also the mixed precision operations
+  if (bop->getLHS()->getType().getCanonicalType().getUnqualifiedType() !=
+      bop->getRHS()->getType().getCanonicalType().getUnqualifiedType()) {
+    return false;
+  }
 
   if (bop->getOpcode() == BO_Add || bop->getOpcode() == BO_AddAssign ||
       bop->getOpcode() == BO_Sub || bop->getOpcode() == BO_SubAssign ||
@@ -147,9 +128,13 @@ bool chimera::flapmutator::FLAPFloatOperationMutator::match(
     // smts,
     // that is is in the "control" part
     SourceRange bopRange = bop->getSourceRange();
-    // IF a construct has been matched
+    // IF a construct has been matched, loops take precedence
     // If stmt
-    const IfStmt *ifStmt = node.Nodes.getNodeAs<IfStmt>("ifStmt");
+    const IfStmt *ifStmt =
+        (context.forStmt == nullptr && context.whileStmt == nullptr &&
+         context.doStmt == nullptr)
+            ? context.ifStmt
+            : nullptr;
     if (ifStmt != nullptr) {
       if (bopRange.getBegin() < ifStmt->getCond()->getSourceRange().getEnd()) {
         return false;
@@ -304,8 +289,7 @@ bool chimera::flapmutator::FLAPFloatOperationMutator::getMatchedNode(
     }
 
     // Get return variable name, if exists
-    const BinaryOperator *assignOp =
-        node.Nodes.getNodeAs<BinaryOperator>("externalAssignOp");
+    const BinaryOperator *assignOp = this->getContext(node, *bop).assignment;
     if (assignOp != nullptr) {
       // Some assign operation has been matched, narrow down to the really
       // interesting
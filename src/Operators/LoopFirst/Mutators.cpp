@@ -25,6 +25,7 @@
 
 #include "Log.h"
 #include "Operators/LoopFirst/Mutators.h"
+#include "Core/Matchers.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/ADT/APSInt.h"
@@ -43,19 +44,6 @@ using namespace std;
 ///////////////////////////////////////////////////////////////////////////////
 // Flap operation mutator
 
-#define XHS_INTERNAL_MATCHER(id)                                               \
-  ignoringParenImpCasts(expr().bind(                                           \
-      id)) //< x hand side matcher without parenthesis and implicit casts
-
-// Retrieve hs without implicit cast and parenthesis,
-// also bypassing explicit casting, this is done arriving to the explicit cast
-// and then going on the child (has), where the above rule is applied again
-#define XHS_MATCHER(type, id)                                                  \
-  allOf(hasType(qualType(hasCanonicalType(asString(type)))),                   \
-        anyOf(XHS_INTERNAL_MATCHER(id),                                        \
-              ignoringParenImpCasts(                                           \
-                  castExpr(has(expr(XHS_INTERNAL_MATCHER(id)))))))
-
 
 /// \brief It is used to retrieve the node, it hides the binding string.
 ///        In Mutator.h there is code template snippet that should be fine for
@@ -73,6 +61,14 @@ bool chimera::perforation::MutatorLoopPerforation1::getMatchedNode(
   return true;
 }
 
+/// \brief The rewrite of the loop stride keeps the syntax of the for
+///        statement, only a sample of the mutants is checked
+::chimera::mutator::ValidationPolicy
+chimera::perforation::MutatorLoopPerforation1::getValidationPolicy() const
+{
+  return ::chimera::mutator::SampleValidation;
+}
+
 /// \brief This method returns the statement matcher to match the binary
 /// operation
 ::clang::ast_matchers::StatementMatcher
@@ -83,13 +79,13 @@ chimera::perforation::MutatorLoopPerforation1::getStatementMatcher()
             // Match the condition statement (Es. i<n)
             anyOf(binaryOperator(
                     hasParent(forStmt().bind("for")),
-                    hasLHS(XHS_MATCHER("unsigned int", "lhs"))).bind("binary_cond"),
+                    hasLHS(chimera::matchers::operand(chimera::matchers::isUnsignedInt(), "lhs"))).bind("binary_cond"),
                   anything()),
             // Last consider int decl
             // Match the condition statement (Es. i<n)
             anyOf(binaryOperator(
                     hasParent(forStmt().bind("for")),
-                    hasLHS(XHS_MATCHER("int", "lhs"))).bind("binary_cond"),
+                    hasLHS(chimera::matchers::operand(chimera::matchers::isInt(), "lhs"))).bind("binary_cond"),
                   anything()),
 
             // Match case of unary operand (Es. i++)
@@ -139,60 +135,54 @@ static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
 /// \brief This method implements the fine grained matching rules, indeed it is
 ///        not possible in an easy way to specify that the node matched it has
 ///        not to be part of the condition expression of a for statement
+/// \details A loop is matched once, on its increment. The state used by
+///          mutate() depends only on the node: match() can be called again
+///          on the same node, after the ones of the other nodes.
 bool chimera::perforation::MutatorLoopPerforation1::match(
     const ::chimera::mutator::NodeType &node)
 {
   // First operation: Retrieve the node
-  //const ForStmt *fop = node.Nodes.getNodeAs<ForStmt>("for");
   const UnaryOperator  *uop   = node.Nodes.getNodeAs<UnaryOperator>("unary_op");
   const BinaryOperator *bcond = node.Nodes.getNodeAs<BinaryOperator>("binary_cond");
   const BinaryOperator *bop   = node.Nodes.getNodeAs<BinaryOperator>("binary_op");
   const BinaryOperator *bas   = node.Nodes.getNodeAs<BinaryOperator>("binary_assign");
-  const BinaryOperator *binit = node.Nodes.getNodeAs<BinaryOperator>("binary_init");
   const ForStmt        *fst   = node.Nodes.getNodeAs<ForStmt>("for");
- 
-  // Retrive the operator
-  if (uop != nullptr)
-    if(uop->getLocStart() == fst->getInc()->getLocStart()) 
-      this->inc = uop;
-  
-  if (bcond != nullptr){
-    if(bcond->getLocStart() == fst->getCond()->getLocStart())
-      this->cond = bcond;
-    else if(bcond->isCompoundAssignmentOp())
-           if(bcond->getLocStart() == fst->getInc()->getLocStart()){
-             this->binc = bcond;
-             this->bas  = bcond;
-          }
-    else if(bcond->getLocStart() == fst->getInit()->getLocStart())
-           this->init = bcond;   
-  }
-        
-  if (bas != nullptr && bop != nullptr)
-    if(bas->getLocStart() == fst->getInc()->getLocStart()){
-      this->binc = bop; 
-      this->bas  = bas;
-    }
-  
-  // Retrive the binary initializzation
-  if(binit != nullptr)
-    if(binit->getLocStart() == fst->getInit()->getLocStart())
-      this->init = binit;
 
-  // Fine grain condition
-  // Check if both operator are in same forStmt  
-  if (this->inc != nullptr && this->cond != nullptr && this->init != nullptr){
-    if(fst->getInc()->getLocStart() == this->inc->getLocStart() &&
-       fst->getCond()->getLocStart() == this->cond->getLocStart() &&
-       fst->getInit()->getLocStart() == this->init->getLocStart())
-      return true;
-  }else if(this->binc != nullptr && this->bas != nullptr && this->cond != nullptr && this->init != nullptr){
-    if(fst->getInc()->getLocStart() == this->bas->getLocStart() &&
-       fst->getCond()->getLocStart() == this->cond->getLocStart() &&
-       fst->getInit()->getLocStart() == this->init->getLocStart())
-      return true;
+  // Nothing is kept from the previous matches
+  clean();
+  if (fst == nullptr || fst->getInit() == nullptr ||
+      fst->getCond() == nullptr || fst->getInc() == nullptr)
+    return false;
+
+  // Retrive the increment, the node has to be the one of the loop
+  if (uop != nullptr && uop->getLocStart() == fst->getInc()->getLocStart()) {
+    this->inc = uop;
+  } else if (bcond != nullptr && bcond->isCompoundAssignmentOp() &&
+             bcond->getLocStart() == fst->getInc()->getLocStart()) {
+    this->binc = bcond;
+    this->bas  = bcond;
+  } else if (bas != nullptr && bop != nullptr &&
+             bas->getLocStart() == fst->getInc()->getLocStart()) {
+    this->binc = bop;
+    this->bas  = bas;
+  } else {
+    return false;
   }
+
+  // Retrive the condition and the binary initializzation of the same loop,
+  // the condition on an int or unsigned int as "binary_cond"
+  this->cond = dyn_cast<BinaryOperator>(fst->getCond());
+  this->init = dyn_cast<BinaryOperator>(fst->getInit());
+  if (this->cond != nullptr && this->init != nullptr &&
+      !::clang::ast_matchers::match(
+          binaryOperator(hasLHS(anyOf(
+              chimera::matchers::operand(chimera::matchers::isUnsignedInt(),
+                                         "lhs"),
+              chimera::matchers::operand(chimera::matchers::isInt(), "lhs")))),
+          *(this->cond), *(node.Context)).empty())
+    return true;
   // If operator are from different forStmt return false
+  clean();
   return false;
 }
 
@@ -231,7 +221,7 @@ bool chimera::perforation::MutatorLoopPerforation1::match(
         inc = false;
       break;
       default :
-        ChimeraLogger::verbose("OpCode sconosciuto: " + std::to_string(this->binc->getOpcode())); 
+        CHIMERA_VERBOSE("OpCode sconosciuto: " + std::to_string(this->binc->getOpcode())); 
       break;
     } 
   }else{
@@ -304,7 +294,7 @@ bool chimera::perforation::MutatorLoopPerforation1::match(
 
 void ::chimera::perforation::MutatorLoopPerforation1::clean()
 {
-  this->cond = this->binc = this->bas = nullptr;
+  this->cond = this->binc = this->bas = this->init = nullptr;
   this->inc = nullptr;
 }
 
@@ -23,6 +23,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Operators/TruncateInt/Mutators.h"
+#include "Core/Matchers.h"
 #include "llvm/Support/ErrorHandling.h"
 
 #include "Log.h"
@@ -45,25 +46,6 @@ using namespace chimera::log;
 #define GET_PARENT_NODE(res_matcher, child, casting_type)                      \
   ((res_matcher.Context->getParents(*child))[0]).get<casting_type>()
 
-#define XHS_INTERNAL_MATCHER(id)                                               \
-  ignoringParenImpCasts(expr().bind(                                           \
-      id)) //< x hand side matcher without parenthesis and implicit casts
-
-// Retrieve hs without implicit cast and parenthesis,
-// also bypassing explicit casting, this is done arriving to the explicit cast
-// and then going on the child (has), where the above rule is applied again
-#define XHS_MATCHER(type, id)                                                  \
-  allOf(hasType(qualType(hasCanonicalType(asString(type)))),                   \
-        anyOf(XHS_INTERNAL_MATCHER(id),                                        \
-              ignoringParenImpCasts(                                           \
-                  castExpr(has(expr(XHS_INTERNAL_MATCHER(id)))))))
-
-#define XHS_INT_MATCHER(id)                                                    \
-  allOf(hasType(isInteger()),                                                  \
-        anyOf(XHS_INTERNAL_MATCHER(id),                                        \
-              ignoringParenImpCasts(                                           \
-                  castExpr(has(expr(XHS_INTERNAL_MATCHER(id)))))))
-
 /// \brief It is used to retrieve the node, it hides the binding string.
 ///        In Mutator.h there is code template snippet that should be fine for
 ///        all the majority of the cases.
@@ -85,22 +67,22 @@ bool chimera::truncate::MutatorTruncateInt::getMatchedNode(const NodeType &node,
 ///         operation
 StatementMatcher chimera::truncate::MutatorTruncateInt::getStatementMatcher()
 {
-  // It has to match a binary operation with a specific operator name (+) and 
-  // specific operands (int, int).
-  // In order to retrieve the match, it is necessary to bind a string in this 
-  // case "int_op".
-  return stmt(
-      binaryOperator(
-        anyOf(hasOperatorName("+"), hasOperatorName("-"), hasOperatorName("*"), hasOperatorName("/")),
-        hasRHS(XHS_INT_MATCHER("rhs")),
-        hasLHS(XHS_INT_MATCHER("lhs"))).bind("int_op"),
-    unless(
-      anyOf(
-        hasAncestor(callExpr()), //uncomment to avoid mutation of input parameters of a function call
-        hasAncestor(arraySubscriptExpr())
-      )
-    )
-  );
+  // It has to match a binary operation with integer operands (int, int).
+  // The matcher is shared with the other integer mutators, the operator
+  // name (+, -, *, /) is checked in the fine grained match.
+  // In order to retrieve the match, it is bound to the string "int_op".
+  return stmt(matchers::integerOperation());
+}
+
+::std::string chimera::truncate::MutatorTruncateInt::getMatcherKey() const
+{
+  return matchers::integerOperationKey;
+}
+
+::chimera::mutator::MatchBackend
+chimera::truncate::MutatorTruncateInt::getMatchBackend() const
+{
+  return ::chimera::mutator::BinaryOperatorVisitorBackend;
 }
 
 /// \brief  This method implements the fine grained matching rules, because it is
@@ -114,6 +96,16 @@ bool chimera::truncate::MutatorTruncateInt::match(const NodeType &node)
   // First operation: Retrieve the node
   const BinaryOperator *bop = node.Nodes.getNodeAs<BinaryOperator>("int_op");
   assert(bop && "BinaryOperator is nullptr");
+  if (bop->getOpcode() != BO_Add && bop->getOpcode() != BO_Sub &&
+      bop->getOpcode() != BO_Mul && bop->getOpcode() != BO_Div) {
+    return false;
+  }
+
+  // Discard the operations inside a function call or an array subscript
+  const ::chimera::StmtContext &context = this->getContext(node, *bop);
+  if (context.call != nullptr || context.subscript != nullptr) {
+    return false;
+  }
   
   // Second operation: extract lhs and rhs
   const Expr *internalLhs = node.Nodes.getNodeAs<Expr>("lhs");
@@ -144,19 +136,14 @@ bool chimera::truncate::MutatorTruncateInt::match(const NodeType &node)
   
   ////////////////////////////////////////////////////////////////////////////////////////////
   /// Debug
-  char log_string[500];
-  Rewriter rw(*(node.SourceManager), node.Context->getLangOpts());
-  ChimeraLogger::verbose("********************************************************\nMatched operation:");
-  sprintf(log_string, "Operation: %s ==> [%s]", rw.getRewrittenText(bop->getSourceRange()).c_str(), bop->getOpcodeStr().str().c_str());
-  ChimeraLogger::verbose(log_string);
-  sprintf(log_string, "LHS: %s", rw.getRewrittenText(lhs->getSourceRange()).c_str());
-  ChimeraLogger::verbose(log_string);
-  sprintf(log_string, "RHS: %s\n", rw.getRewrittenText(rhs->getSourceRange()).c_str());
-  ChimeraLogger::verbose(log_string);
+  CHIMERA_VERBOSE("********************************************************\nMatched operation:");
+  CHIMERA_VERBOSE(std::string("Operation: ") + getSourceText(node, bop->getSourceRange()) + " ==> [" + bop->getOpcodeStr().str() + "]");
+  CHIMERA_VERBOSE(std::string("LHS: ") + getSourceText(node, lhs->getSourceRange()));
+  CHIMERA_VERBOSE(std::string("RHS: ") + getSourceText(node, rhs->getSourceRange()) + "\n");
   ////////////////////////////////////////////////////////////////////////////////////////////
   
-  if (rw.getRewrittenText(lhs->getSourceRange()) == "") return false;
-  if (rw.getRewrittenText(rhs->getSourceRange()) == "") return false;
+  if (!isRewritable(node, lhs->getSourceRange())) return false;
+  if (!isRewritable(node, rhs->getSourceRange())) return false;
   
   return true;
 }
@@ -166,8 +153,6 @@ Rewriter &chimera::truncate::MutatorTruncateInt::mutate(const NodeType &node,
                                                         Rewriter &rw)
 {
   
-  char log_info[500];
-  
   // Retrieve a pointer to function declaration (or template function
   // declaration) to insert global variables before it
   const FunctionDecl *funDecl = node.Nodes.getNodeAs<FunctionDecl>("functionDecl");
@@ -231,21 +216,17 @@ Rewriter &chimera::truncate::MutatorTruncateInt::mutate(const NodeType &node,
     
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Debug
-    ChimeraLogger::verbose("********************************************************\nDump binary operation:");
-    sprintf(log_info, "Operation: %s  ==> [%s]", rw.getRewrittenText(bop->getSourceRange()).c_str(), bop->getOpcodeStr().str().c_str());
-    ChimeraLogger::verbose(log_info);
-    sprintf(log_info, "LHS: %s", lhsString.c_str());
-    ChimeraLogger::verbose(log_info);
-    sprintf(log_info, "RHS: %s", rhsString.c_str());
-    ChimeraLogger::verbose(log_info);
-    sprintf(log_info, "Mutation in: %s\n", bopReplacement.c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE("********************************************************\nDump binary operation:");
+    CHIMERA_VERBOSE(std::string("Operation: ") + rw.getRewrittenText(bop->getSourceRange()) + "  ==> [" + bop->getOpcodeStr().str() + "]");
+    CHIMERA_VERBOSE(std::string("LHS: ") + lhsString);
+    CHIMERA_VERBOSE(std::string("RHS: ") + rhsString);
+    CHIMERA_VERBOSE(std::string("Mutation in: ") + bopReplacement + "\n");
     ////////////////////////////////////////////////////////////////////////////////////////////
     
     // Stop if the current node (bop) has no parents
     if (node.Context->getParents(*bop).empty())
     {
-      ChimeraLogger::verbose("No more parents. Exiting\n");
+      CHIMERA_VERBOSE("No more parents. Exiting\n");
       break;
     }
     
@@ -254,7 +235,7 @@ Rewriter &chimera::truncate::MutatorTruncateInt::mutate(const NodeType &node,
     if (parentType == "BinaryOperator")
     {
       // If the parent is a BinaryOperator then assign to bop its parent
-      ChimeraLogger::verbose("Parent is a BOP\n");
+      CHIMERA_VERBOSE("Parent is a BOP\n");
       bop = (BinaryOperator *) (GET_PARENT_NODE(node, bop, BinaryOperator));
     }
     else
@@ -267,16 +248,13 @@ Rewriter &chimera::truncate::MutatorTruncateInt::mutate(const NodeType &node,
         {
           parens = (ParenExpr *) (GET_PARENT_NODE(node, parens, ParenExpr));
         }
-        ChimeraLogger::verbose("Parens skipped successfully.\n");
+        CHIMERA_VERBOSE("Parens skipped successfully.\n");
         
         // If the content of parenthesis is not a BinaryOperator then exit else assign
         // parenthesis content to bop
         if ((PARENT_NODE_TYPE(node, parens) != "BinaryOperator"))
         {
-          sprintf(log_info,
-                  "WARNING: Unexpected parens content of type [%s]. Exiting...\n",
-                  PARENT_NODE_TYPE(node, parens).str().c_str());
-          ChimeraLogger::verbose(log_info);
+          CHIMERA_VERBOSE(std::string("WARNING: Unexpected parens content of type [") + PARENT_NODE_TYPE(node, parens).str() + "]. Exiting...\n");
           bop = NULL;
         }
         else
@@ -286,14 +264,13 @@ Rewriter &chimera::truncate::MutatorTruncateInt::mutate(const NodeType &node,
         if ((parentType == "FunDecl") || (parentType == "VarDecl") || (parentType == "ImplicitCastExpr"))
         {
           // If the parent is a FunDecl or a VarDecl then exit
-          ChimeraLogger::verbose("Function o Variable Declaration reached. Exiting...\n");
+          CHIMERA_VERBOSE("Function o Variable Declaration reached. Exiting...\n");
           bop = NULL;
         }
         else
         {
           // If the parent is not one of the previous IFs, then exit and print the unexpected type
-          sprintf(log_info, "WARNING: Unexpected parent of type [%s]. Exiting...\n", parentType.c_str());
-          ChimeraLogger::verbose(log_info);
+          CHIMERA_VERBOSE(std::string("WARNING: Unexpected parent of type [") + parentType + "]. Exiting...\n");
           bop = NULL;
         }
     
@@ -307,8 +284,7 @@ Rewriter &chimera::truncate::MutatorTruncateInt::mutate(const NodeType &node,
       
       // If a new BinaryOperator has been assigned to bop (indeed bop is not NULL) 
       // and it's a =, then exit 
-      sprintf(log_info, "BOP opcod is [%s]. Exiting...\n", bop->getOpcodeStr().str().c_str());
-      ChimeraLogger::verbose(log_info);
+      CHIMERA_VERBOSE(std::string("BOP opcod is [") + bop->getOpcodeStr().str() + "]. Exiting...\n");
       bop = NULL;
     }
     
@@ -332,12 +308,12 @@ void chimera::truncate::MutatorTruncateInt::onCreatedMutant(
   ::llvm::raw_fd_ostream report(mDir + this->reportName + ".csv", error,
                                 ::llvm::sys::fs::OpenFlags::F_Append);
   
-  ChimeraLogger::verbose(
+  CHIMERA_VERBOSE(
     "****************************************************\nStart writing report");
   
   while (!(this->mutationsInfo.empty()))
   {
-    ChimeraLogger::verbose("Writing element...");
+    CHIMERA_VERBOSE("Writing element...");
     
     MutatorTruncateInt::MutationInfo mutationInfo = this->mutationsInfo.back();
     report  << mutationInfo.nabId << ","
@@ -350,6 +326,6 @@ void chimera::truncate::MutatorTruncateInt::onCreatedMutant(
     this->mutationsInfo.pop_back();
   }
   report.close();
-  ChimeraLogger::verbose(
+  CHIMERA_VERBOSE(
     "****************************************************\nReport written successfully");
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+//===- MutantPack.cpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantPack.cpp
+/// \brief This file implements the pack format of the mutants
+//===----------------------------------------------------------------------===//
+
+#include "Pack/MutantPack.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace chimera::pack;
+
+/// @brief Alignment of the tables
+static const ::std::uint64_t tableAlignment = 8;
+
+///////////////////////////////////////////////////////////////////////////////
+// PackWriter
+chimera::pack::PackWriter::PackWriter(const ::std::string &path,
+                                      const ::std::string &targetFilename)
+    : stream(path, ::std::ios::out | ::std::ios::binary | ::std::ios::trunc) {
+  ::std::memset(&this->header, 0, sizeof(this->header));
+  ::std::memcpy(this->header.magic, packMagic, sizeof(packMagic));
+  this->header.version = packVersion;
+  this->header.byteOrder = packByteOrder;
+  // Reserve the header, it's complete only on close
+  this->write(reinterpret_cast<const char *>(&this->header),
+              sizeof(this->header));
+  this->header.targetNameOffset =
+      this->write(targetFilename.data(), targetFilename.size());
+  this->header.targetNameSize = targetFilename.size();
+}
+
+chimera::pack::PackWriter::~PackWriter() { this->close(); }
+
+::std::uint64_t chimera::pack::PackWriter::write(const char *data,
+                                                 ::std::size_t size) {
+  const ::std::uint64_t offset = this->stream.tellp();
+  this->stream.write(data, size);
+  return offset;
+}
+
+bool chimera::pack::PackWriter::add(mutant::IdType id,
+                                    const ::std::string &name,
+                                    const char *data, ::std::size_t size) {
+  if (!this->stream.is_open() ||
+      !this->names.insert(::std::make_pair(id, name)).second) {
+    return false;
+  }
+  BlobEntry entry;
+  ::std::memset(&entry, 0, sizeof(entry));
+  entry.nameOffset = this->write(name.data(), name.size());
+  entry.nameSize = name.size();
+  entry.dataOffset = this->write(data, size);
+  entry.dataSize = size;
+  this->blobs[id].push_back(entry);
+  return this->stream.good();
+}
+
+bool chimera::pack::PackWriter::close() {
+  if (!this->stream.is_open()) {
+    return false;
+  }
+  // Align the tables, so that they can be read in place
+  const ::std::uint64_t end = this->stream.tellp();
+  const char padding[tableAlignment] = {0};
+  this->write(padding, (tableAlignment - end % tableAlignment) %
+                           tableAlignment);
+
+  // Blobs table, grouped by mutant
+  ::std::vector<MutantEntry> mutants;
+  this->header.blobsOffset = this->stream.tellp();
+  ::std::uint32_t blobIndex = 0;
+  for (const auto &mutantBlobs : this->blobs) {
+    MutantEntry mutant;
+    ::std::memset(&mutant, 0, sizeof(mutant));
+    mutant.id = mutantBlobs.first;
+    mutant.firstBlob = blobIndex;
+    mutant.blobsNumber = mutantBlobs.second.size();
+    mutants.push_back(mutant);
+    blobIndex += mutant.blobsNumber;
+    this->write(reinterpret_cast<const char *>(mutantBlobs.second.data()),
+                mutantBlobs.second.size() * sizeof(BlobEntry));
+  }
+  this->header.blobsNumber = blobIndex;
+
+  // Mutants table, the map keeps them sorted
+  this->header.mutantsOffset = this->stream.tellp();
+  this->header.mutantsNumber = mutants.size();
+  this->write(reinterpret_cast<const char *>(mutants.data()),
+              mutants.size() * sizeof(MutantEntry));
+
+  this->stream.seekp(0);
+  this->write(reinterpret_cast<const char *>(&this->header),
+              sizeof(this->header));
+  const bool good = this->stream.good();
+  this->stream.close();
+  this->blobs.clear();
+  this->names.clear();
+  return good;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PackReader
+chimera::pack::PackReader::PackReader()
+    : base(nullptr), size(0), header(nullptr), mutants(nullptr),
+      blobs(nullptr) {}
+
+chimera::pack::PackReader::~PackReader() { this->close(); }
+
+void chimera::pack::PackReader::close() {
+  if (this->base != nullptr) {
+    ::munmap(const_cast<char *>(this->base), this->size);
+  }
+  this->base = nullptr;
+  this->size = 0;
+  this->header = nullptr;
+  this->mutants = nullptr;
+  this->blobs = nullptr;
+}
+
+bool chimera::pack::PackReader::open(const ::std::string &path) {
+  this->close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0 ||
+      static_cast<::std::size_t>(info.st_size) < sizeof(PackHeader)) {
+    ::close(fd);
+    return false;
+  }
+  void *mapping = ::mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // The mapping keeps the file
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  this->base = static_cast<const char *>(mapping);
+  this->size = info.st_size;
+
+  // Check the header and that the tables lie in the file
+  const PackHeader *h = reinterpret_cast<const PackHeader *>(this->base);
+  auto inFile = [this](::std::uint64_t offset, ::std::uint64_t length) {
+    return offset <= this->size && length <= this->size - offset;
+  };
+  if (::std::memcmp(h->magic, packMagic, sizeof(packMagic)) != 0 ||
+      h->version != packVersion || h->byteOrder != packByteOrder ||
+      h->blobsOffset % tableAlignment != 0 ||
+      h->mutantsOffset % tableAlignment != 0 ||
+      !inFile(h->targetNameOffset, h->targetNameSize) ||
+      !inFile(h->blobsOffset,
+              static_cast<::std::uint64_t>(h->blobsNumber) *
+                  sizeof(BlobEntry)) ||
+      !inFile(h->mutantsOffset,
+              static_cast<::std::uint64_t>(h->mutantsNumber) *
+                  sizeof(MutantEntry))) {
+    this->close();
+    return false;
+  }
+  this->header = h;
+  this->blobs =
+      reinterpret_cast<const BlobEntry *>(this->base + h->blobsOffset);
+  this->mutants =
+      reinterpret_cast<const MutantEntry *>(this->base + h->mutantsOffset);
+  for (::std::uint32_t i = 0; i < h->mutantsNumber; ++i) {
+    const MutantEntry &m = this->mutants[i];
+    if (m.firstBlob > h->blobsNumber ||
+        m.blobsNumber > h->blobsNumber - m.firstBlob ||
+        (i > 0 && this->mutants[i - 1].id >= m.id)) {
+      this->close();
+      return false;
+    }
+  }
+  for (::std::uint32_t i = 0; i < h->blobsNumber; ++i) {
+    const BlobEntry &b = this->blobs[i];
+    if (!inFile(b.nameOffset, b.nameSize) ||
+        !inFile(b.dataOffset, b.dataSize)) {
+      this->close();
+      return false;
+    }
+  }
+  return true;
+}
+
+::std::string chimera::pack::PackReader::getTargetFilename() const {
+  if (this->header == nullptr) {
+    return "";
+  }
+  return ::std::string(this->base + this->header->targetNameOffset,
+                       this->header->targetNameSize);
+}
+
+const MutantEntry *
+chimera::pack::PackReader::find(mutant::IdType id) const {
+  if (this->header == nullptr) {
+    return nullptr;
+  }
+  const MutantEntry *end = this->mutants + this->header->mutantsNumber;
+  const MutantEntry *it = ::std::lower_bound(
+      this->mutants, end, id,
+      [](const MutantEntry &m, mutant::IdType id) { return m.id < id; });
+  return (it != end && it->id == id) ? it : nullptr;
+}
+
+Blob chimera::pack::PackReader::makeBlob(const BlobEntry &entry) const {
+  Blob blob;
+  blob.name = this->base + entry.nameOffset;
+  blob.nameSize = entry.nameSize;
+  blob.data = this->base + entry.dataOffset;
+  blob.size = entry.dataSize;
+  return blob;
+}
+
+::std::vector<Blob>
+chimera::pack::PackReader::getBlobs(mutant::IdType id) const {
+  ::std::vector<Blob> result;
+  const MutantEntry *m = this->find(id);
+  if (m != nullptr) {
+    for (::std::uint32_t i = 0; i < m->blobsNumber; ++i) {
+      result.push_back(this->makeBlob(this->blobs[m->firstBlob + i]));
+    }
+  }
+  return result;
+}
+
+bool chimera::pack::PackReader::getBlob(mutant::IdType id,
+                                        const ::std::string &name,
+                                        Blob &blob) const {
+  const MutantEntry *m = this->find(id);
+  if (m == nullptr) {
+    return false;
+  }
+  for (::std::uint32_t i = 0; i < m->blobsNumber; ++i) {
+    const BlobEntry &entry = this->blobs[m->firstBlob + i];
+    if (entry.nameSize == name.size() &&
+        ::std::memcmp(this->base + entry.nameOffset, name.data(),
+                      name.size()) == 0) {
+      blob = this->makeBlob(entry);
+      return true;
+    }
+  }
+  return false;
+}
@@ -25,6 +25,7 @@
 ///        Google C++ Test Framework
 //===----------------------------------------------------------------------===//
 
+#include "Core/BinaryOperatorMatcher.h"
 #include "Core/Mutator.h"
 #include "Testing/ChimeraTest.h"
 
@@ -65,6 +66,14 @@ int chimera::testing::runAllTest(int argc, const char **argv,
   return RUN_ALL_TESTS();
 }
 
+std::string chimera::testing::createTemporaryDirectory() {
+  ::llvm::SmallString<128> path;
+  std::error_code ec =
+      ::llvm::sys::fs::createUniqueDirectory("chimera-test", path);
+  EXPECT_FALSE(ec) << "Unable to create a temporary directory";
+  return std::string(path.str()) + pathSep;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// MatchCallback
 using TestCallbackResultType = ::std::vector<::std::vector<::std::string>>;
@@ -74,9 +83,37 @@ public:
   MutatorMatchingTestCallback(::llvm::raw_ostream &out, Mutator &m)
       : out(out), mutator(m) {}
   /**
-   * @brief Run implementation.
+   * @brief Run implementation. The matches are processed at the end of the
+   * translation unit, as in the Mutation Template.
    */
   virtual void run(const MatchFinder::MatchResult &Result) {
+    this->matches.push_back(::std::make_pair(Result.Nodes, Result.Context));
+  }
+
+  /**
+   * @brief Fine grain match all the nodes, as the sampler does, then match
+   * them again and mutate them.
+   */
+  virtual void onEndOfTranslationUnit() {
+    // The index is per translation unit, as in the Mutation Template
+    this->mutator.setContextIndex(&this->contextIndex);
+    ::std::vector<bool> firstPass;
+    for (const auto &match : this->matches) {
+      firstPass.push_back(this->mutator.match(
+          MatchFinder::MatchResult(match.first, match.second)));
+    }
+    for (size_t i = 0; i < this->matches.size(); ++i) {
+      this->process(MatchFinder::MatchResult(this->matches[i].first,
+                                             this->matches[i].second),
+                    firstPass[i]);
+    }
+    this->matches.clear();
+  }
+
+  const TestCallbackResultType &getResults() { return this->results; }
+
+private:
+  void process(const MatchFinder::MatchResult &Result, bool firstPass) {
     ::clang::ast_type_traits::DynTypedNode matched_node;
     if (mutator.getMatchedNode(Result, matched_node)) {
       // Create a rewriter
@@ -89,7 +126,10 @@ public:
                 ::to_string(matchedNodeLoc.getSpellingLineNumber()) + ":" +
                 ::to_string(matchedNodeLoc.getSpellingColumnNumber()));
       // Apply fine grain matching rule
-      if (mutator.match(Result)) {
+      const bool matched = mutator.match(Result);
+      EXPECT_EQ(firstPass, matched)
+          << "The fine grain match doesn't depend only on the node";
+      if (matched) {
         LOG_TEST_("\t\tFine grain match : PASS");
 
         // Save result entry
@@ -137,12 +177,12 @@ public:
     }
   }
 
-  const TestCallbackResultType &getResults() { return this->results; }
-
-private:
   ::llvm::raw_ostream &out;
   Mutator &mutator;
   TestCallbackResultType results;
+  ::chimera::ContextIndex contextIndex;
+  /// The coarse grain matches of the translation unit
+  ::std::vector<::std::pair<BoundNodes, ::clang::ASTContext *>> matches;
 };
 
 void chimera::testing::testMutatorMatch(chimera::mutator::Mutator *mutator) {
@@ -190,16 +230,32 @@ void chimera::testing::testMutatorMatch(chimera::mutator::Mutator *mutator) {
         }
 
         // Create a matchFinder, load the mutator on it and run
+        // The backend of the binary operator mutators outlives the run
+        ::chimera::BinaryOperatorMatcher visitorBackend;
         MatchFinder finder;
         // Create a MatchCallback
         MatchFinder::MatchCallback *callback =
             new MutatorMatchingTestCallback(mutationOutputStream, m);
+        // As in the Mutation Template, the function is bound as functionDecl
         switch (m.getMatcherType()) {
         case StatementMatcherType:
-          finder.addMatcher(m.getStatementMatcher(), callback);
+          if (m.getMatchBackend() == BinaryOperatorVisitorBackend) {
+            visitorBackend.addMatcher(finder, m.getStatementMatcher(),
+                                      callback);
+            break;
+          }
+          finder.addMatcher(
+              functionDecl(isDefinition(),
+                           forEachDescendant(m.getStatementMatcher()))
+                  .bind("functionDecl"),
+              callback);
           break;
         case DeclarationMatcherType:
-          finder.addMatcher(m.getDeclarationMatcher(), callback);
+          finder.addMatcher(
+              functionDecl(isDefinition(),
+                           forEachDescendant(m.getDeclarationMatcher()))
+                  .bind("functionDecl"),
+              callback);
           break;
         case TypeMatcherType:
           finder.addMatcher(m.getTypeMatcher(), callback);
@@ -0,0 +1,134 @@
+//===- AnalysisCache.cpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file AnalysisCache.cpp
+/// \brief  This file implements the persistent cache of the analyses
+//===----------------------------------------------------------------------===//
+
+#include "Tooling/AnalysisCache.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+
+#include <fstream>
+
+/// @brief Bump it when the outputs of the tool change for the same inputs
+static const char cacheVersion[] = "chimera-cache-1";
+
+/// @brief Hash a field, its length first to avoid ambiguities
+static void hashField(::llvm::MD5& hash, ::llvm::StringRef field) {
+  hash.update(::std::to_string(field.size()) + ":");
+  hash.update(field);
+}
+
+/// @brief Hex MD5 of a string
+static ::std::string hashString(::llvm::StringRef text) {
+  ::llvm::MD5 hash;
+  hash.update(text);
+  ::llvm::MD5::MD5Result result;
+  hash.final(result);
+  ::llvm::SmallString<32> hex;
+  ::llvm::MD5::stringifyResult(result, hex);
+  return hex.str();
+}
+
+chimera::AnalysisCache::AnalysisCache(const ::std::string& outputPath)
+    : cacheDir(outputPath + ::chimera::fs::pathSep + ".cache" +
+               ::chimera::fs::pathSep) {}
+
+::std::string chimera::AnalysisCache::computeKey(
+    ::llvm::StringRef preprocessedSource,
+    const ::clang::tooling::CompileCommand& command,
+    const ::std::vector<::std::string>& operators,
+    const conf::FunOpConfMap& confMap,
+    const ::std::vector<::std::string>& options) {
+  ::llvm::MD5 hash;
+  hashField(hash, cacheVersion);
+  hashField(hash, preprocessedSource);
+  hashField(hash, command.Directory);
+  hashField(hash, ::std::to_string(command.CommandLine.size()));
+  for (const ::std::string& arg : command.CommandLine) {
+    hashField(hash, arg);
+  }
+  hashField(hash, ::std::to_string(operators.size()));
+  for (const ::std::string& op : operators) {
+    hashField(hash, op);
+  }
+  // The map is sorted, thus the order is deterministic
+  hashField(hash, ::std::to_string(confMap.size()));
+  for (const auto& entry : confMap) {
+    hashField(hash, entry.first);
+    hashField(hash, ::std::to_string(entry.second.size()));
+    for (const ::std::string& op : entry.second) {
+      hashField(hash, op);
+    }
+  }
+  hashField(hash, ::std::to_string(options.size()));
+  for (const ::std::string& option : options) {
+    hashField(hash, option);
+  }
+  ::llvm::MD5::MD5Result result;
+  hash.final(result);
+  ::llvm::SmallString<32> hex;
+  ::llvm::MD5::stringifyResult(result, hex);
+  return hex.str();
+}
+
+::std::string chimera::AnalysisCache::getEntryPath(
+    const ::std::string& sourcePath) const {
+  return this->cacheDir + hashString(sourcePath);
+}
+
+bool chimera::AnalysisCache::lookup(
+    const ::std::string& sourcePath, const ::std::string& key,
+    const ::std::string& targetOutputDir) const {
+  ::std::ifstream entry(this->getEntryPath(sourcePath));
+  ::std::string entryKey, entryOutputDir;
+  if (!::std::getline(entry, entryKey) ||
+      !::std::getline(entry, entryOutputDir)) {
+    return false;
+  }
+  return entryKey == key && entryOutputDir == targetOutputDir &&
+         ::llvm::sys::fs::is_directory(targetOutputDir);
+}
+
+bool chimera::AnalysisCache::store(const ::std::string& sourcePath,
+                                   const ::std::string& key,
+                                   const ::std::string& targetOutputDir) const {
+  if (!::chimera::fs::createDirectories(this->cacheDir)) {
+    return false;
+  }
+  // Written aside and renamed, a torn entry must never be a hit
+  const ::std::string entryPath = this->getEntryPath(sourcePath);
+  const ::std::string tempPath = entryPath + ".tmp";
+  {
+    ::std::ofstream entry(tempPath, ::std::ios::trunc);
+    entry << key << "\n" << targetOutputDir << "\n" << sourcePath << "\n";
+    if (!entry.good()) {
+      return false;
+    }
+  }
+  return !::llvm::sys::fs::rename(tempPath, entryPath);
+}
+
+void chimera::AnalysisCache::invalidate(const ::std::string& sourcePath) const {
+  ::llvm::sys::fs::remove(this->getEntryPath(sourcePath));
+}
@@ -24,17 +24,28 @@
 //===----------------------------------------------------------------------===//
 
 #include "Log.h"
+#include "Core/MutantDelta.h"
+#include "Core/MutantIdList.h"
 #include "Core/MutationTemplate.h"
+#include "Pack/MutantPack.h"
 #include "Testing/ChimeraTest.h"
+#include "Tooling/AnalysisCache.h"
 #include "Tooling/ChimeraTool.h"
 #include "Tooling/CompilationDatabaseUtils.h"
+#include "Tooling/FileScheduler.h"
 #include "Tooling/FrontendActions.h"
+#include "Tooling/MutantValidator.h"
+#include "Tooling/ShardMerger.h"
 
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 
+#include <atomic>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -126,12 +137,248 @@ enum PreprocessLevel {
     ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("test-dir"),
     ::llvm::cl::cat(catChimera), ::llvm::cl::init(""));
 
+::llvm::cl::opt<::chimera::ValidationMode> optValidationMode(
+    "validation", ::llvm::cl::desc("Select the engine used to check the "
+                                   "syntax of the mutants"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::ValidationMode::InMemory, "in-memory",
+                   "Fully parse each mutant, mapped in memory (default)"),
+        clEnumValN(::chimera::ValidationMode::Preamble, "preamble",
+                   "Reuse the precompiled preamble of the target among its "
+                   "mutants"),
+        clEnumValEnd),
+    ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(::chimera::ValidationMode::InMemory));
+::llvm::cl::opt<unsigned> optJobs(
+    "j", ::llvm::cl::desc("Number of threads used to check the mutants, "
+                          "default: 1"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("N"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(1));
+::llvm::cl::opt<bool> optTrustedMutators(
+    "trusted-mutators",
+    ::llvm::cl::desc("Honor the validation policies of the mutators: skip the "
+                     "check of the mutants valid by construction, or check "
+                     "only a random sample of them. A sampled mutant failing "
+                     "the check makes the analysis fail"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<int> optValidationSample(
+    "validation-sample",
+    ::llvm::cl::desc("Percentage of the mutants checked for the sampled "
+                     "trusted mutators, default: their own"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("K"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(-1));
+::llvm::cl::opt<bool> optDeferredHom(
+    "deferred-hom",
+    ::llvm::cl::desc("Check each HOM mutant once, at the end of the "
+                     "translation unit, bisecting its mutations to drop the "
+                     "offending ones. The report lists only the kept "
+                     "mutations, the side reports of the mutators (e.g. "
+                     "loop_report.csv) still list the dropped ones"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<bool> optSchemata(
+    "schemata",
+    ::llvm::cl::desc("Guard the valid FOM mutants of each target in a single "
+                     "mutant schemata, selected at run-time through the "
+                     "CHIMERA_MUTANT_ID environment variable"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<::chimera::mutant::MutantStorage> optMutantStorage(
+    "mutant-storage",
+    ::llvm::cl::desc("Select how the generated mutants are saved"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::mutant::MutantStorage::Tree, "tree",
+                   "A directory with the whole mutated file for each mutant "
+                   "(default)"),
+        clEnumValN(::chimera::mutant::MutantStorage::Delta, "delta",
+                   "A single indexed file of edit scripts per source file, "
+                   "<source_filename>/mutants.delta. Use the materialize "
+                   "subcommand to rebuild the mutants"),
+        clEnumValN(::chimera::mutant::MutantStorage::Pack, "pack",
+                   "A single pack of sources and mutator artifacts per "
+                   "source file, <source_filename>/mutants.pack, readable "
+                   "through the mutantpack library"),
+        clEnumValEnd),
+    ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(::chimera::mutant::MutantStorage::Tree));
+::llvm::cl::opt<bool> optNotDeduplicate(
+    "no-deduplicate",
+    ::llvm::cl::desc("Check and save also the mutants identical to an earlier "
+                     "one. By default they are reported in report.csv with the "
+                     "id of the earlier mutant as 7th column"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<unsigned> optHomOrder(
+    "hom-order",
+    ::llvm::cl::desc("Combine the valid first order mutants of each source "
+                     "file, up to the given order, into higher order mutants. "
+                     "Their report.csv entries have the parent ids as 7th "
+                     "column: parents:<id>;<id>..."),
+    ::llvm::cl::value_desc("K"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(0));
+::llvm::cl::opt<unsigned> optHomBudget(
+    "hom-budget",
+    ::llvm::cl::desc("Maximum number of combined higher order mutants per "
+                     "source file, beyond which they are sampled"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(1000));
+::llvm::cl::opt<unsigned> optMaxMutants(
+    "max-mutants",
+    ::llvm::cl::desc("Maximum number of mutants per source file. With any "
+                     "limit the candidate mutations are sampled before being "
+                     "applied, and the weight of each sampled mutant is "
+                     "written in <source_filename>/sampling_weights.csv"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(0));
+::llvm::cl::opt<unsigned> optMaxPerOperator(
+    "max-per-operator",
+    ::llvm::cl::desc("Maximum number of mutants per operator"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(0));
+::llvm::cl::opt<unsigned> optMaxPerFunction(
+    "max-per-function",
+    ::llvm::cl::desc("Maximum number of mutants per function"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(0));
+::llvm::cl::opt<unsigned> optMaxPerMutatorType(
+    "max-per-mutator-type",
+    ::llvm::cl::desc("Maximum number of mutants per mutation type of a "
+                     "mutator"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(0));
+::llvm::cl::opt<::chimera::SamplingStrategy> optSampling(
+    "sampling",
+    ::llvm::cl::desc("Select how -max-mutants is shared among the candidate "
+                     "mutations"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::SamplingStrategy::Uniform, "uniform",
+                   "Uniformly among all of them (default)"),
+        clEnumValN(::chimera::SamplingStrategy::ByFunction, "function",
+                   "Proportionally among the functions"),
+        clEnumValN(::chimera::SamplingStrategy::ByMutator, "mutator",
+                   "Proportionally among the mutators"),
+        clEnumValN(::chimera::SamplingStrategy::ByRegion, "region",
+                   "Proportionally among the regions of lines, see "
+                   "-sampling-region"),
+        clEnumValEnd),
+    ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(::chimera::SamplingStrategy::Uniform));
+::llvm::cl::opt<unsigned> optSamplingRegion(
+    "sampling-region",
+    ::llvm::cl::desc("Lines of a region for -sampling=region, default: 50"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(50));
+::llvm::cl::opt<unsigned> optSamplingSeed(
+    "sampling-seed",
+    ::llvm::cl::desc("Seed of the sampled candidate mutations, default: 0"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(0));
+::llvm::cl::opt<::std::string> optShard(
+    "shard",
+    ::llvm::cl::desc("Apply only the shard i of N of the candidate mutations, "
+                     "picked by a stable key, so that N processes can split "
+                     "a campaign. Use the merge subcommand to combine their "
+                     "output directories. Identical mutants are detected "
+                     "within a shard only, thus not deduplicated"),
+    ::llvm::cl::value_desc("i/N"), ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(""));
+::llvm::cl::opt<bool> optTimeReport(
+    "time-report",
+    ::llvm::cl::desc("Time the phases of the pipeline and count candidates, "
+                     "fine grain matches, valid and invalid mutants and "
+                     "written bytes, per file, operator and mutator. The "
+                     "report is printed and written in "
+                     "<output_dir>/time_report.json"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::ValueDisallowed);
+::llvm::cl::opt<bool> optJournal(
+    "journal",
+    ::llvm::cl::desc("Journal the verdicts in <output_dir>/<target>/"
+                     "journal.csv, flushing each of them, so that an "
+                     "interrupted analysis can be resumed"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::ValueDisallowed);
+::llvm::cl::opt<bool> optResume(
+    "resume",
+    ::llvm::cl::desc("Resume an interrupted analysis, reusing the verdicts "
+                     "journaled in the output directory of each target "
+                     "(see -journal), with the same options. The resumed "
+                     "analysis is journaled as well"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::ValueDisallowed);
+::llvm::cl::opt<bool> optCountOnly(
+    "count-only",
+    ::llvm::cl::desc("Only count the candidate mutations, per function, per "
+                     "operator and per mutator, without mutating or checking "
+                     "anything. Useful to size an analysis"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<::chimera::CountFormat> optCountFormat(
+    "count-format",
+    ::llvm::cl::desc("Select the format of the candidate counts"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::CountFormat::CSV, "csv",
+                   "<source_filename>/candidates.csv and "
+                   "<source_filename>/counts.csv (default)"),
+        clEnumValN(::chimera::CountFormat::JSON, "json",
+                   "<source_filename>/candidates.json"),
+        clEnumValEnd),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(::chimera::CountFormat::CSV));
+::llvm::cl::opt<bool> optCache(
+    "cache",
+    ::llvm::cl::desc("Skip the source files unchanged since their last "
+                     "analysis, reusing its outputs. The cache is kept in "
+                     "<output_dir>/.cache"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<unsigned> optFileJobs(
+    "file-jobs",
+    ::llvm::cl::desc("Number of source files analyzed concurrently, largest "
+                     "first, default: 1. Each file gets its own instance of "
+                     "the operators. Clang changes the working directory of "
+                     "the whole process to the one of the compile command, "
+                     "so the files are analyzed sequentially unless all "
+                     "their compile commands share the directory"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("N"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(1));
+
 ::llvm::cl::opt<bool>
     optShowOperators("show-op",
                      ::llvm::cl::desc("Show the supported Mutation Operators"),
                      ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
                      ::llvm::cl::init(false));
 
+// Subcommands
+::llvm::cl::SubCommand subMaterialize(
+    "materialize",
+    "Rebuild the mutants saved with -mutant-storage=delta or pack");
+::llvm::cl::opt<::std::string>
+    optMaterializeDelta(::llvm::cl::Positional, ::llvm::cl::Required,
+                        ::llvm::cl::desc("<mutants.delta|mutants.pack>"),
+                        ::llvm::cl::sub(subMaterialize));
+::llvm::cl::opt<::std::string> optMaterializeMutants(
+    "mutants", ::llvm::cl::desc("The mutants to rebuild, as a comma separated "
+                                "list of ids and ranges (e.g. 1-10,15), "
+                                "default: all"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("ids"),
+    ::llvm::cl::sub(subMaterialize), ::llvm::cl::init(""));
+::llvm::cl::opt<::std::string> optMaterializeOutputDir(
+    "o", ::llvm::cl::desc("The output directory, default: the directory of "
+                          "the delta file"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("dir-path"),
+    ::llvm::cl::sub(subMaterialize), ::llvm::cl::init(""));
+
+::llvm::cl::SubCommand
+    subMerge("merge",
+             "Merge the output directories of all the shards of a campaign "
+             "into the outputs of a single run, see -shard");
+::llvm::cl::list<::std::string>
+    optMergeShards(::llvm::cl::Positional, ::llvm::cl::OneOrMore,
+                   ::llvm::cl::desc("<shard-output-dir>..."),
+                   ::llvm::cl::sub(subMerge));
+::llvm::cl::opt<::std::string> optMergeOutputDir(
+    "o", ::llvm::cl::desc("The output directory of the merge"),
+    ::llvm::cl::Required, ::llvm::cl::value_desc("dir-path"),
+    ::llvm::cl::sub(subMerge));
+
 // Utility functions
 bool optIsOccured(const ::std::string &optString, int argc, const char **argv) {
   for (int i = 0; i < argc; ++i) {
@@ -143,6 +390,101 @@ bool optIsOccured(const ::std::string &optString, int argc, const char **argv) {
 }
 /// \}
 
+/// \brief Write a file of a materialized mutant, as
+/// <output_dir>/<id>/<filename>
+static bool writeMutantFile(const ::std::string &outputDir, mutant::IdType id,
+                            const ::std::string &filename,
+                            ::llvm::StringRef content) {
+  ::std::string mutantDir =
+      outputDir + chimera::fs::pathSep + ::std::to_string(id);
+  chimera::fs::createDirectories(mutantDir);
+  ::std::error_code fileError;
+  ::llvm::raw_fd_ostream file(mutantDir + chimera::fs::pathSep + filename,
+                              fileError, ::llvm::sys::fs::F_None);
+  if (fileError) {
+    chimera::log::ChimeraLogger::error(
+        "An error occurred during the file opening: " + fileError.message());
+    return false;
+  }
+  file << content;
+  return true;
+}
+
+/// \brief Rebuild the mutants of a delta file or of a pack, as
+/// <output_dir>/<id>/<source_filename>. The pack artifacts are extracted too.
+static int materializeMutants() {
+  const ::std::string path = optMaterializeDelta;
+  const bool isPack = ::llvm::sys::path::extension(path) == ".pack";
+  ::chimera::mutant::MutantDeltaReader deltaReader;
+  ::chimera::pack::PackReader packReader;
+  if (isPack ? !packReader.open(path) : !deltaReader.open(path)) {
+    chimera::log::ChimeraLogger::error("Cannot read the mutants file " + path);
+    return 1;
+  }
+  ::std::vector<mutant::IdType> ids;
+  if (isPack) {
+    for (::std::size_t i = 0; i < packReader.getMutantsNumber(); ++i) {
+      ids.push_back(packReader.getMutantId(i));
+    }
+  } else {
+    ids = deltaReader.getMutantIds();
+  }
+  if (optMaterializeMutants != "") {
+    // Ranges may span mutants that were not saved (e.g. failed the check)
+    ::chimera::mutant::MutantIdList list;
+    if (!::chimera::mutant::MutantIdList::parse(optMaterializeMutants, list)) {
+      chimera::log::ChimeraLogger::error("Malformed list of mutants: " +
+                                         (::std::string)optMaterializeMutants);
+      return 1;
+    }
+    ids = list.select(ids);
+  }
+
+  ::std::string outputDir =
+      optMaterializeOutputDir != ""
+          ? (::std::string)optMaterializeOutputDir
+          : ::llvm::sys::path::parent_path(
+                clang::tooling::getAbsolutePath(path))
+                .str();
+  int retval = 0;
+  for (mutant::IdType id : ids) {
+    if (isPack) {
+      for (const ::chimera::pack::Blob &blob : packReader.getBlobs(id)) {
+        if (!writeMutantFile(outputDir, id, blob.getName(),
+                             ::llvm::StringRef(blob.data, blob.size))) {
+          retval = 1;
+        }
+      }
+      continue;
+    }
+    if (!deltaReader.hasMutant(id)) {
+      continue;
+    }
+    ::std::string code;
+    if (!deltaReader.materialize(id, code)) {
+      chimera::log::ChimeraLogger::error("Corrupted mutant " +
+                                         ::std::to_string(id));
+      retval = 1;
+      continue;
+    }
+    if (!writeMutantFile(outputDir, id, deltaReader.getFilename(), code)) {
+      retval = 1;
+    }
+  }
+  return retval;
+}
+
+/// \brief Merge the output directories of the shards of a campaign
+static int mergeShards() {
+  ::std::vector<::std::string> shardDirs;
+  for (const ::std::string &shardDir : optMergeShards) {
+    shardDirs.push_back(clang::tooling::getAbsolutePath(shardDir));
+  }
+  ::chimera::ShardMerger merger(
+      shardDirs, clang::tooling::getAbsolutePath(optMergeOutputDir));
+  return merger.run();
+}
+
 bool chimera::ChimeraTool::registerMutationOperator(
     ::chimera::m_operator::MutationOperatorPtr op) {
   std::pair<typename MutationOperatorPtrMap::iterator, bool> retval =
@@ -153,8 +495,20 @@ bool chimera::ChimeraTool::registerMutationOperator(
   return retval.second;
 }
 
+bool chimera::ChimeraTool::registerMutationOperator(
+    MutationOperatorFactory factory) {
+  ::chimera::m_operator::MutationOperatorPtr op = factory();
+  const m_operator::IdType id = op->getIdentifier();
+  if (!this->registerMutationOperator(::std::move(op))) {
+    return false;
+  }
+  this->registeredFactoryMap[id] = factory;
+  return true;
+}
+
 bool chimera::ChimeraTool::unregisterMutationOperator(
     const m_operator::IdType &id) {
+  this->registeredFactoryMap.erase(id);
   return this->registeredOperatorMap.erase(id);
 }
 
@@ -168,6 +522,16 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
   // Init the ChimeraLogger
   ::chimera::log::ChimeraLogger::init();
 
+  // Subcommands, they don't need the sources
+  if (argc > 1 && ::llvm::StringRef(argv[1]) == "materialize") {
+    ::llvm::cl::ParseCommandLineOptions(argc, argv, overview);
+    return materializeMutants();
+  }
+  if (argc > 1 && ::llvm::StringRef(argv[1]) == "merge") {
+    ::llvm::cl::ParseCommandLineOptions(argc, argv, overview);
+    return mergeShards();
+  }
+
   // Arguments Parsing
   // If there aren't, show the help
   if (argc == 1) {
@@ -253,14 +617,28 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
     chimera::log::ChimeraLogger::setVerboseLevel(9);
   }
 
+  if (optTimeReport) {
+    this->timeReport.reset(new ::chimera::TimeReport());
+  }
+
+  // Sharded campaign, the mutants spanning the whole file can't be split
+  ::chimera::MutantShard shard;
+  if (optShard != "" && !::chimera::MutantShard::parse(optShard, shard)) {
+    chimera::log::ChimeraLogger::error(
+        "Malformed shard, expected i/N with 0 <= i < N: " +
+        (::std::string)optShard);
+    return 1;
+  }
+  if (shard.isSharded() && (optSchemata || optHomOrder >= 2)) {
+    chimera::log::ChimeraLogger::error(
+        "-schemata and -hom-order can't be used with -shard");
+    return 1;
+  }
+
   // Output directory
   std::string outputPath =
       clang::tooling::getAbsolutePath((::std::string)optOutputDir);
 
-  // Set resources directory
-  std::string resourcesOutputDir =
-      outputPath + chimera::fs::pathSep + "resources" + chimera::fs::pathSep;
-
   // Options Specific actions
   ::std::unique_ptr<::clang::tooling::CompilationDatabase> userCDatabase;
   if (optCompilationDatabaseDir != "") {
@@ -280,8 +658,8 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
   // Configuration file
   conf::FunOpConfMap confMap;
   if (optFunOpConfFile != "") {
-    chimera::log::ChimeraLogger::verbose("Configuration file : " +
-                                         (::std::string)optFunOpConfFile);
+    CHIMERA_VERBOSE("Configuration file : " +
+                    (::std::string)optFunOpConfFile);
     // ifstream confFile((::std::string) optFunOpConfFile);
     // Read conf file
     if (!conf::readFunctionsOperatorsConfFile(optFunOpConfFile, confMap)) {
@@ -297,19 +675,15 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
         clang::tooling::getAbsolutePath(sourcePath));
   }
 
-  // Loop on SourcePaths
-  ::std::vector<::std::string> sourcePaths = op.getSourcePathList();
-  for (std::string sourcePath : sourceAbsolutePathList) {
+  // Retrieve the compile commands, the databases are not queried concurrently
+  const ::clang::tooling::CompilationDatabase &database =
+      optCompilationDatabaseDir != "" ? *userCDatabase : op.getCompilations();
+  ::std::vector<::std::string> targets;
+  ::std::map<::std::string, ::clang::tooling::CompileCommand> targetCommands;
+  for (const std::string &sourcePath : sourceAbsolutePathList) {
     // Get the compile commands for the sourcePath
-    ::chimera::cd_utils::CompileCommandVector commands;
-    if (optCompilationDatabaseDir != "") {
-      // The previous error check make safe this instruction
-      commands = chimera::cd_utils::getCompileCommandsByFilePath(*userCDatabase,
-                                                                 sourcePath);
-    } else {
-      commands = chimera::cd_utils::getCompileCommandsByFilePath(
-          op.getCompilations(), sourcePath);
-    }
+    ::chimera::cd_utils::CompileCommandVector commands =
+        chimera::cd_utils::getCompileCommandsByFilePath(database, sourcePath);
 #ifdef _CHIEMERA_DEBUG_
     ::chimera::cd_utils::dump(::std::cout, commands);
 #endif
@@ -333,110 +707,324 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
 
     // FIXME Some Bug, could not find stddef.h
     command.CommandLine.push_back("-I/usr/lib/clang/3.9.1/include/");
+    // The tools change the working directory: a relative one would depend on
+    // the tools run before
+    if (!command.Directory.empty()) {
+      command.Directory = clang::tooling::getAbsolutePath(command.Directory);
+    }
 
-    ///////////////////////////////////////////////////////////////////////////////
-    // The command for the sourcePath is ready!
-    // Check source preprocessing
-    if (optPreprocessLevel != PreprocessLevel::None) {
-      PreprocessLevel l = optPreprocessLevel;
-      ::chimera::log::ChimeraLogger::verboseAndIncr(
-          "[ RUN  ] Preprocessing source file");
-      // For sure will be saved a preprocessed file version in resources
-      // directory
-
-      // Variable needed to create a raw_fd_ostream
-      ::std::error_code errorCode;
-      ::std::string filepath =
-          resourcesOutputDir + llvm::sys::path::filename(sourcePath).data();
-
-      // Create output directory
-      if (::chimera::fs::createDirectories(resourcesOutputDir)) {
-        // Open raw_fd_stream for the preprocessed-version fo the file
-        ::llvm::raw_fd_ostream preprocessSourceFileStream(
-            filepath, errorCode, llvm::sys::fs::F_Text);
-        // Check which type of preprocessing
-        if (l == PreprocessLevel::CompletePreprocess) {
-          ::chimera::log::ChimeraLogger::verbose(
-              "Applying complete preprocessing");
-          ::chimera::preprocessIncludeAction(preprocessSourceFileStream,
-                                             command, sourcePath);
-        } else if (l == PreprocessLevel::ExpandMacros) {
-          ::chimera::log::ChimeraLogger::verbose("Applying macro expansion");
-          ::chimera::expandMacrosAction(preprocessSourceFileStream, command,
-                                        sourcePath);
-        } else {
-          assert(l == PreprocessLevel::ReformatOnly);
-          ::chimera::log::ChimeraLogger::verbose("Applying reformatting");
-          ::chimera::reformatAction(preprocessSourceFileStream, command,
-                                    sourcePath);
-        }
-        // Close file stream
-        preprocessSourceFileStream.close();
-        chimera::log::ChimeraLogger::verbosePreDecr(
-            "[ DONE ] Preprocessing source file");
-
-        // A different version for the sourcePath has been created, modify
-        // command and sourcePath
-        ::chimera::cd_utils::changeCompileCommandTarget(command, sourcePath,
-                                                        filepath);
-        // Modify the sourcePath
-        sourcePath = filepath;
-
-        chimera::log::ChimeraLogger::verbose(
-            "[ RUN  ] Performing syntax check on preprocessed file");
-        // Some times the Macro Expander corrupt the file so check the syntax
-        int syntaxCheckResult =
-            ::chimera::checkSyntaxAction(command, sourcePath);
-        if (syntaxCheckResult != 0) {
-          chimera::log::ChimeraLogger::fatal(
-              "[ FAIL ] Performing syntax check on preprocessed file\nThis "
-              "could happen for apparently no reason with the macro-expansion, "
-              "the macro-expander sometimes could not properly manage "
-              "comments, see the the first error message, if this is the case, "
-              "modify the source file in order to use this option.\nSorry for "
-              "the inconvenient.");
-          return 1;
-        } else {
-          chimera::log::ChimeraLogger::verbose(
-              "[ PASS ] Performing syntax check on preprocessed file");
-        }
-        chimera::log::ChimeraLogger::decrActualVLevel();
+    if (targetCommands.insert(::std::make_pair(sourcePath, command)).second) {
+      targets.push_back(sourcePath);
+    }
+  }
+
+  // Concurrent analysis requires an instance of each operator per file
+  unsigned fileJobs = optFileJobs;
+  if (fileJobs > 1 && optShowFunDef) {
+    fileJobs = 1; // Only the first file is shown
+  }
+  if (fileJobs > 1) {
+    // The working directory is set for the whole process by each tool run,
+    // also by the validation workers of the file
+    for (const std::string &sourcePath : targets) {
+      if (targetCommands.at(sourcePath).Directory !=
+          targetCommands.at(targets.front()).Directory) {
+        chimera::log::ChimeraLogger::warning(
+            "The compile commands of " + targets.front() + " and " +
+            sourcePath + " have different working directories, source "
+            "files will be analyzed sequentially");
+        fileJobs = 1;
+        break;
+      }
+    }
+  }
+  if (fileJobs > 1) {
+    for (const auto &op : this->registeredOperatorMap) {
+      if (this->registeredFactoryMap.find(op.getKey()) ==
+          this->registeredFactoryMap.end()) {
+        chimera::log::ChimeraLogger::warning(
+            "The operator " + op.getKey().str() +
+            " has been registered without a factory, source files will be "
+            "analyzed sequentially");
+        fileJobs = 1;
+        break;
+      }
+    }
+  }
+
+  if (fileJobs <= 1) {
+    // Sequential: the registered operators are shared among the files
+    int retval = 0;
+    for (const std::string &sourcePath : targets) {
+      if (this->runOnSourceFile(sourcePath, targetCommands.at(sourcePath),
+                                outputPath, confMap, false) != 0) {
+        // The next files are analyzed anyway, as with concurrent files
+        retval = 1;
+      }
+      if (optShowFunDef) {
+        break;
+      }
+    }
+    this->writeTimeReport(outputPath);
+    return retval;
+  }
+
+  ::std::atomic<int> retval(0);
+  ::chimera::FileScheduler scheduler(fileJobs);
+  scheduler.run(targets, [this, &targetCommands, &outputPath, &confMap,
+                          &retval](const ::std::string &sourcePath) {
+    // Keep apart the logs of each file
+    ::chimera::log::ChimeraLogger::setContext(
+        "[" + ::llvm::sys::path::filename(sourcePath).str() + "] ");
+    if (this->runOnSourceFile(sourcePath, targetCommands.at(sourcePath),
+                              outputPath, confMap, true) != 0) {
+      retval = 1;
+    }
+    ::chimera::log::ChimeraLogger::resetContext();
+  });
+  this->writeTimeReport(outputPath);
+  return retval;
+}
+
+void chimera::ChimeraTool::writeTimeReport(
+    const ::std::string &outputPath) const {
+  if (!this->timeReport) {
+    return;
+  }
+  const ::std::string path =
+      outputPath + chimera::fs::pathSep + "time_report.json";
+  chimera::fs::createDirectories(outputPath);
+  // The table follows the verbose messages still queued
+  chimera::log::ChimeraLogger::flush();
+  ::std::ofstream stream(path);
+  this->timeReport->writeJSON(stream);
+  stream.close();
+  if (!stream.good()) {
+    chimera::log::ChimeraLogger::error("An error occurred writing " + path);
+  }
+  this->timeReport->writeTable(::llvm::outs());
+}
+
+int chimera::ChimeraTool::runOnSourceFile(
+    ::std::string sourcePath, ::clang::tooling::CompileCommand command,
+    const ::std::string &outputPath, const conf::FunOpConfMap &confMap,
+    bool isolated) {
+  // The measures refer to the source file, even once preprocessed
+  const ::chimera::TimeScope timeScope = {sourcePath, "", ""};
+  // Set resources directory
+  std::string resourcesOutputDir =
+      outputPath + chimera::fs::pathSep + "resources" + chimera::fs::pathSep;
+
+  ///////////////////////////////////////////////////////////////////////////////
+  // The command for the sourcePath is ready!
+  // Check source preprocessing
+  if (optPreprocessLevel != PreprocessLevel::None) {
+    ::chimera::TimeReport::Timer preprocessTimer(
+        this->timeReport.get(), timeScope, ::chimera::TimePhase::Preprocess);
+    PreprocessLevel l = optPreprocessLevel;
+    CHIMERA_VERBOSE_AND_INCR(
+        "[ RUN  ] Preprocessing source file");
+    // For sure will be saved a preprocessed file version in resources
+    // directory
+
+    // Variable needed to create a raw_fd_ostream
+    ::std::error_code errorCode;
+    ::std::string filepath =
+        resourcesOutputDir + llvm::sys::path::filename(sourcePath).data();
+
+    // Create output directory
+    if (::chimera::fs::createDirectories(resourcesOutputDir)) {
+      // Open raw_fd_stream for the preprocessed-version fo the file
+      ::llvm::raw_fd_ostream preprocessSourceFileStream(
+          filepath, errorCode, llvm::sys::fs::F_Text);
+      // Check which type of preprocessing
+      if (l == PreprocessLevel::CompletePreprocess) {
+        CHIMERA_VERBOSE(
+            "Applying complete preprocessing");
+        ::chimera::preprocessIncludeAction(preprocessSourceFileStream,
+                                           command, sourcePath);
+      } else if (l == PreprocessLevel::ExpandMacros) {
+        CHIMERA_VERBOSE("Applying macro expansion");
+        ::chimera::expandMacrosAction(preprocessSourceFileStream, command,
+                                      sourcePath);
       } else {
+        assert(l == PreprocessLevel::ReformatOnly);
+        CHIMERA_VERBOSE("Applying reformatting");
+        ::chimera::reformatAction(preprocessSourceFileStream, command,
+                                  sourcePath);
+      }
+      // Close file stream
+      preprocessSourceFileStream.close();
+      CHIMERA_VERBOSE_PRE_DECR(
+          "[ DONE ] Preprocessing source file");
+
+      // A different version for the sourcePath has been created, modify
+      // command and sourcePath
+      ::chimera::cd_utils::changeCompileCommandTarget(command, sourcePath,
+                                                      filepath);
+      // Modify the sourcePath
+      sourcePath = filepath;
+
+      CHIMERA_VERBOSE(
+          "[ RUN  ] Performing syntax check on preprocessed file");
+      // Some times the Macro Expander corrupt the file so check the syntax
+      int syntaxCheckResult =
+          ::chimera::checkSyntaxAction(command, sourcePath);
+      if (syntaxCheckResult != 0) {
         chimera::log::ChimeraLogger::fatal(
-            "Could not create the resources directory.");
-        return 1; // Error
+            "[ FAIL ] Performing syntax check on preprocessed file\nThis "
+            "could happen for apparently no reason with the macro-expansion, "
+            "the macro-expander sometimes could not properly manage "
+            "comments, see the the first error message, if this is the case, "
+            "modify the source file in order to use this option.\nSorry for "
+            "the inconvenient.");
+        return 1;
+      } else {
+        CHIMERA_VERBOSE(
+            "[ PASS ] Performing syntax check on preprocessed file");
       }
+      chimera::log::ChimeraLogger::decrActualVLevel();
+    } else {
+      chimera::log::ChimeraLogger::fatal(
+          "Could not create the resources directory.");
+      return 1; // Error
     }
+  }
 
-    ///////////////////////////////////////////////////////////////////////////////
-    /// The command for this source file is ready, can perform FrontendAction
-    if (optShowFunDef) {
-      std::cout << "Function Definitions found : " << std::endl;
-      return ::chimera::functionDefAction(llvm::outs(), command, sourcePath);
-    }
+  ///////////////////////////////////////////////////////////////////////////////
+  /// The command for this source file is ready, can perform FrontendAction
+  if (optShowFunDef) {
+    std::cout << "Function Definitions found : " << std::endl;
+    return ::chimera::functionDefAction(llvm::outs(), command, sourcePath);
+  }
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef _CHIMERA_DEBUG_
-    chimera::cd_utils::dump(std::cout, command);
+  chimera::cd_utils::dump(std::cout, command);
 #endif
-    chimera::MutationTemplate t(command, sourcePath,
-                                outputPath + chimera::fs::pathSep + "mutants");
+  chimera::MutationTemplate t(command, sourcePath,
+                              outputPath + chimera::fs::pathSep + "mutants");
 
-    // Loop on registered operators
-    const chimera::MutationOperatorPtrMap &map = this->registeredOperatorMap;
-    for (auto it = map.begin(); it != map.end(); ++it) {
+  // Loop on registered operators, when isolated this file gets its own
+  // instances since the mutators are stateful
+  ::std::vector<m_operator::MutationOperatorPtr> fileOperators;
+  const chimera::MutationOperatorPtrMap &map = this->registeredOperatorMap;
+  for (auto it = map.begin(); it != map.end(); ++it) {
+    if (isolated) {
+      fileOperators.push_back(
+          this->registeredFactoryMap.find(it->getKey())->getValue()());
+      t.loadOperator(fileOperators.back().get());
+    } else {
       t.loadOperator(it->second.get());
     }
+  }
+
+  // Set if generate the mutatns or only the report
+  t.setGenerateMutants(optGenerateMutants);
+  t.setMutantStorage(optMutantStorage);
+  t.setGenerateMutantsReport(!optNotGenerateReport);
+  t.setValidationMode(optValidationMode);
+  t.setValidationJobs(optJobs);
+  t.setTrustedMutators(optTrustedMutators);
+  t.setValidationSample(optValidationSample);
+  t.setDeferredHomValidation(optDeferredHom);
+  t.setSchemata(optSchemata);
+  ::chimera::MutantShard shard;
+  if (optShard != "") {
+    ::chimera::MutantShard::parse(optShard, shard); // Checked by run()
+  }
+  t.setShard(shard);
+  t.setJournaled(optJournal);
+  t.setResume(optResume);
+  // Duplicates would be detected within a shard only
+  t.setDeduplicate(!optNotDeduplicate && !shard.isSharded());
+  t.setHomOrder(optHomOrder);
+  t.setHomBudget(optHomBudget);
+  t.setCountOnly(optCountOnly);
+  ::chimera::MutantBudget budget;
+  budget.maxMutants = optMaxMutants;
+  budget.perOperator = optMaxPerOperator;
+  budget.perFunction = optMaxPerFunction;
+  budget.perMutatorType = optMaxPerMutatorType;
+  t.setBudget(budget);
+  t.setSamplingStrategy(optSampling);
+  t.setSamplingRegionLines(optSamplingRegion);
+  t.setSamplingSeed(optSamplingSeed);
+  t.setCountFormat(optCountFormat);
+  t.setTimeReport(this->timeReport.get(), timeScope.file);
 
-    // Set if generate the mutatns or only the report
-    t.setGenerateMutants(optGenerateMutants);
-    t.setGenerateMutantsReport(!optNotGenerateReport);
-    // Analyze template
+  // Skip the analysis if nothing changed since the last one
+  ::chimera::AnalysisCache cache(outputPath);
+  ::std::string cacheKey;
+  if (optCache) {
+    ::std::string preprocessed;
+    ::llvm::raw_string_ostream preprocessedStream(preprocessed);
+    if (::chimera::preprocessIncludeAction(preprocessedStream, command,
+                                           sourcePath) == 0) {
+      ::std::vector<::std::string> operators;
+      for (auto it = map.begin(); it != map.end(); ++it) {
+        operators.push_back(it->getKey().str());
+      }
+      // Only the options that change the outputs
+      ::std::vector<::std::string> options = {
+          ::std::string("generate-mutants=") + (optGenerateMutants ? "1" : "0"),
+          ::std::string("no-generate-report=") +
+              (optNotGenerateReport ? "1" : "0"),
+          "mutant-storage=" +
+              ::std::to_string(static_cast<int>(
+                  (::chimera::mutant::MutantStorage)optMutantStorage)),
+          ::std::string("deferred-hom=") + (optDeferredHom ? "1" : "0"),
+          ::std::string("schemata=") + (optSchemata ? "1" : "0"),
+          ::std::string("no-deduplicate=") + (optNotDeduplicate ? "1" : "0"),
+          "hom-order=" + ::std::to_string(optHomOrder),
+          "hom-budget=" + ::std::to_string(optHomBudget),
+          ::std::string("count-only=") + (optCountOnly ? "1" : "0"),
+          ::std::string("trusted-mutators=") + (optTrustedMutators ? "1" : "0"),
+          "validation-sample=" + ::std::to_string(optValidationSample),
+          "max-mutants=" + ::std::to_string(optMaxMutants),
+          "max-per-operator=" + ::std::to_string(optMaxPerOperator),
+          "max-per-function=" + ::std::to_string(optMaxPerFunction),
+          "max-per-mutator-type=" + ::std::to_string(optMaxPerMutatorType),
+          "sampling=" + ::std::to_string(static_cast<int>(
+                            (::chimera::SamplingStrategy)optSampling)),
+          "sampling-region=" + ::std::to_string(optSamplingRegion),
+          "sampling-seed=" + ::std::to_string(optSamplingSeed),
+          "shard=" + (::std::string)optShard,
+          "count-format=" +
+              ::std::to_string(static_cast<int>(
+                  (::chimera::CountFormat)optCountFormat))};
+      cacheKey = ::chimera::AnalysisCache::computeKey(
+          preprocessedStream.str(), command, operators,
+          optFunOpConfFile != "" ? confMap : conf::FunOpConfMap(), options);
+      if (cache.lookup(sourcePath, cacheKey, t.getTargetOutputDirectory())) {
+        chimera::log::ChimeraLogger::info(
+            "Unchanged since the last analysis, reusing its outputs: " +
+            sourcePath);
+        return 0;
+      }
+      cache.invalidate(sourcePath);
+    } else {
+      chimera::log::ChimeraLogger::warning(
+          "Cannot preprocess the source file, the cache is not used: " +
+          sourcePath);
+    }
+  }
+
+  // Analyze template
+  int retval;
+  {
+    ::chimera::TimeReport::Timer totalTimer(
+        this->timeReport.get(), timeScope, ::chimera::TimePhase::Total);
     if (optFunOpConfFile != "") {
-      t.analyze(confMap);
+      retval = t.analyze(confMap);
     } else {
-      t.analyze();
+      retval = t.analyze();
     }
   }
-  return 0;
+  if (!cacheKey.empty() && retval == 0 &&
+      !cache.store(sourcePath, cacheKey, t.getTargetOutputDirectory())) {
+    chimera::log::ChimeraLogger::warning("Cannot update the cache entry of " +
+                                         sourcePath);
+  }
+  return retval;
 }
@@ -74,8 +74,8 @@ chimera::cd_utils::getCompileCommandsByFilePath(
   // First search for the correct "file"
   Twine targetFilePath = Twine(filename);
   std::string foundFilePath;
-  ChimeraLogger::verboseAndIncr("Retrieving compileCommands for " +
-                                targetFilePath.str());
+  CHIMERA_VERBOSE_AND_INCR("Retrieving compileCommands for " +
+                           targetFilePath.str());
   // Find the foundFilename to access specific compileCommands
   // Get all "file" field of the compilation database
   auto compileFile = database.getAllFiles();
@@ -85,17 +85,17 @@ chimera::cd_utils::getCompileCommandsByFilePath(
     for (auto file = compileFile.begin(); file != compileFile.end(); ++file) {
       // Compare with targetFilename
       Twine filePathToCompare(*file);
-      ChimeraLogger::verbose("Comparing with File: " + *file);
+      CHIMERA_VERBOSE("Comparing with File: " + *file);
       // llvm::sys::fs::equivalent to test the really equivalence
       if (llvm::sys::fs::equivalent(targetFilePath, filePathToCompare)) {
-        ChimeraLogger::verbose("Successful. Match found!");
+        CHIMERA_VERBOSE("Successful. Match found!");
         foundFilePath = *file;
         break;
       }
     }
   } else {
     // This is a FixedCompilationDatabase
-    ChimeraLogger::verbose(
+    CHIMERA_VERBOSE(
         "CompilationDatabase with an empty filelist. Maybe provided by hand");
     foundFilePath = targetFilePath.str();
   }
@@ -107,7 +107,7 @@ chimera::cd_utils::getCompileCommandsByFilePath(
 bool chimera::cd_utils::changeCompileCommandTarget(
     ::clang::tooling::CompileCommand &command, ::llvm::StringRef oldTarget,
     ::std::string newTarget, bool suppressWarnings) {
-  ::chimera::log::ChimeraLogger::verboseAndIncr(
+  CHIMERA_VERBOSE_AND_INCR(
       "[ RUN  ] Adapting compile command");
   bool commandChanged = false;
 
@@ -133,7 +133,7 @@ bool chimera::cd_utils::changeCompileCommandTarget(
   if (suppressWarnings) {
     command.CommandLine.push_back("-w");
   }
-  ::chimera::log::ChimeraLogger::verbosePreDecr(
+  CHIMERA_VERBOSE_PRE_DECR(
       "[ DONE ] Adapting compile command");
   return commandChanged;
 }
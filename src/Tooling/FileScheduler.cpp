@@ -0,0 +1,108 @@
+//===- FileScheduler.cpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file FileScheduler.cpp
+/// \brief  This file implements the work-stealing scheduler of source files
+//===----------------------------------------------------------------------===//
+
+#include "Tooling/FileScheduler.h"
+
+#include "llvm/Support/FileSystem.h"
+
+#include <algorithm>
+#include <thread>
+
+chimera::FileScheduler::FileScheduler(unsigned jobs)
+    : jobs(jobs > 0 ? jobs : 1) {
+  for (unsigned i = 0; i < this->jobs; ++i) {
+    this->queues.push_back(
+        ::std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+  }
+}
+
+void chimera::FileScheduler::run(const ::std::vector<::std::string>& files,
+                                 const Task& task) {
+  // Largest files first
+  ::std::vector<WorkItem> items;
+  for (const ::std::string& file : files) {
+    WorkItem item = {file, 0};
+    ::llvm::sys::fs::file_size(file, item.size);
+    items.push_back(item);
+  }
+  ::std::stable_sort(items.begin(), items.end(),
+                     [](const WorkItem& a, const WorkItem& b) {
+                       return a.size > b.size;
+                     });
+  // Deal them round robin, each queue stays sorted
+  for (unsigned i = 0; i < items.size(); ++i) {
+    this->queues[i % this->jobs]->items.push_back(items[i]);
+  }
+
+  ::std::vector<::std::thread> workers;
+  for (unsigned worker = 0; worker < this->jobs; ++worker) {
+    workers.push_back(::std::thread([this, worker, &task]() {
+      WorkItem item;
+      while (this->next(worker, item)) {
+        task(item.file);
+      }
+    }));
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+bool chimera::FileScheduler::next(unsigned worker, WorkItem& item) {
+  // Own queue
+  {
+    WorkerQueue& own = *this->queues[worker];
+    ::std::lock_guard<::std::mutex> lock(own.mutex);
+    if (!own.items.empty()) {
+      item = own.items.front();
+      own.items.pop_front();
+      return true;
+    }
+  }
+  // Steal the largest file left, no file is ever added so an empty scan means
+  // that everything has been dispatched
+  for (;;) {
+    WorkerQueue* victim = nullptr;
+    ::std::uint64_t victimSize = 0;
+    for (unsigned i = 0; i < this->jobs; ++i) {
+      WorkerQueue& queue = *this->queues[i];
+      ::std::lock_guard<::std::mutex> lock(queue.mutex);
+      if (!queue.items.empty() &&
+          (victim == nullptr || queue.items.front().size > victimSize)) {
+        victim = &queue;
+        victimSize = queue.items.front().size;
+      }
+    }
+    if (victim == nullptr) {
+      return false;
+    }
+    ::std::lock_guard<::std::mutex> lock(victim->mutex);
+    if (!victim->items.empty()) {
+      item = victim->items.front();
+      victim->items.pop_front();
+      return true;
+    }
+    // Someone else was faster, retry
+  }
+}
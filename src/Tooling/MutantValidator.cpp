@@ -0,0 +1,200 @@
+//===- MutantValidator.cpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantValidator.cpp
+/// \brief  This file implements the mutant validation engine
+//===----------------------------------------------------------------------===//
+
+#include "Tooling/MutantValidator.h"
+#include "Tooling/CompilationDatabaseUtils.h"
+#include "Log.h"
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace clang::tooling;
+
+chimera::MutantValidator::MutantValidator(const CompileCommand& command,
+                                          const ::std::string& targetPath,
+                                          const ::std::string& virtualPath)
+    : command(command), targetPath(targetPath), virtualPath(virtualPath) {
+  // Swap the target once, the mutants will be all mapped on the same path
+  ::chimera::cd_utils::changeCompileCommandTarget(
+      this->command, this->targetPath, this->virtualPath, true);
+}
+
+CompileCommand chimera::MutantValidator::getCommand(
+    const ::std::vector<::std::string>& additionalCommands) const {
+  CompileCommand c = this->command;
+  c.CommandLine.insert(c.CommandLine.end(), additionalCommands.begin(),
+                       additionalCommands.end());
+  return c;
+}
+
+bool chimera::MutantValidator::check(
+    ::llvm::StringRef code,
+    const ::std::vector<::std::string>& additionalCommands) {
+  // The ClangTool keeps a reference to the database, it has to outlive it
+  ::chimera::cd_utils::FlexibleCompilationDatabase database(
+      this->getCommand(additionalCommands));
+  ClangTool tool(database, this->virtualPath);
+  // The mutant is served by the in-memory overlay, shadowing the real
+  // filesystem only for the virtual path
+  tool.mapVirtualFile(this->virtualPath, code);
+  return tool.run(newFrontendActionFactory<clang::SyntaxOnlyAction>().get()) ==
+         0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PreambleMutantValidator
+chimera::PreambleMutantValidator::PreambleMutantValidator(
+    const CompileCommand& command, const ::std::string& targetPath,
+    const ::std::string& virtualPath)
+    : MutantValidator(command, targetPath, virtualPath),
+      preambleCommand(command),
+      pchContainerOps(::std::make_shared<::clang::PCHContainerOperations>()),
+      preambleComputed(false) {
+  // The mutants are remapped on the original target, so that the preamble
+  // built from it stays valid. Only the adaptation (-I parent, -w) is needed.
+  ::chimera::cd_utils::changeCompileCommandTarget(
+      this->preambleCommand, this->targetPath, this->targetPath, true);
+}
+
+chimera::PreambleMutantValidator::~PreambleMutantValidator() {}
+
+::clang::ASTUnit* chimera::PreambleMutantValidator::getUnit(
+    const ::std::vector<::std::string>& additionalCommands) {
+  auto unitIt = this->units.find(additionalCommands);
+  if (unitIt != this->units.end()) {
+    return unitIt->second.get();
+  }
+
+  // Build the command line, dropping the output since it is a syntax check
+  ::std::vector<::std::string> commandLine;
+  const ::std::vector<::std::string>& baseCommandLine =
+      this->preambleCommand.CommandLine;
+  for (unsigned i = 0; i < baseCommandLine.size(); ++i) {
+    if (baseCommandLine[i] == "-o") {
+      ++i;  // Skip also the argument
+      continue;
+    }
+    commandLine.push_back(baseCommandLine[i]);
+  }
+  commandLine.insert(commandLine.end(), additionalCommands.begin(),
+                     additionalCommands.end());
+  ::std::vector<const char*> args;
+  for (const ::std::string& arg : commandLine) {
+    args.push_back(arg.c_str());
+  }
+
+  CHIMERA_VERBOSE_AND_INCR(
+      "[ RUN  ] Building the preamble of " + this->targetPath);
+  // Diagnostics are captured by the unit, the checks only look for errors
+  ::llvm::IntrusiveRefCntPtr<::clang::DiagnosticsEngine> diags =
+      ::clang::CompilerInstance::createDiagnostics(
+          new ::clang::DiagnosticOptions());
+  ::std::unique_ptr<::clang::ASTUnit> unit(
+      ::clang::ASTUnit::LoadFromCommandLine(
+          args.data(), args.data() + args.size(), this->pchContainerOps, diags,
+          ::clang::CompilerInvocation::GetResourcesPath(args.front(), nullptr),
+          /*OnlyLocalDecls=*/false, /*CaptureDiagnostics=*/true,
+          /*RemappedFiles=*/::llvm::None,
+          /*RemappedFilesKeepOriginalName=*/true,
+          /*PrecompilePreambleAfterNParses=*/1));
+  ::clang::ASTUnit* unitPtr = unit.get();
+  if (unitPtr == nullptr) {
+    CHIMERA_VERBOSE_PRE_DECR(
+        "[ FAIL ] Building the preamble of " + this->targetPath);
+    return nullptr;
+  }
+
+  // The preamble of the original target is computed once, with the language
+  // options of the first unit
+  if (!this->preambleComputed) {
+    auto buffer = ::llvm::MemoryBuffer::getFile(this->targetPath);
+    if (buffer) {
+      ::llvm::StringRef original = (*buffer)->getBuffer();
+      this->originalPreamble =
+          original.substr(0, ::clang::Lexer::ComputePreamble(
+                                 original, unitPtr->getLangOpts())
+                                 .first)
+              .str();
+    }
+    this->preambleComputed = true;
+  }
+  this->units.insert(::std::make_pair(additionalCommands, ::std::move(unit)));
+  CHIMERA_VERBOSE_PRE_DECR(
+      "[ DONE ] Building the preamble of " + this->targetPath);
+  return unitPtr;
+}
+
+bool chimera::PreambleMutantValidator::sharesPreamble(
+    ::llvm::StringRef code) const {
+  if (!this->preambleComputed) {
+    return false;
+  }
+  // Same bytes in the preamble region, and the preamble must end there
+  if (!code.startswith(this->originalPreamble)) {
+    return false;
+  }
+  const ::clang::ASTUnit& unit = *this->units.begin()->second;
+  return ::clang::Lexer::ComputePreamble(code, unit.getLangOpts()).first ==
+         this->originalPreamble.size();
+}
+
+bool chimera::PreambleMutantValidator::check(
+    ::llvm::StringRef code,
+    const ::std::vector<::std::string>& additionalCommands) {
+  ::clang::ASTUnit* unit = this->getUnit(additionalCommands);
+  if (unit == nullptr || !this->sharesPreamble(code)) {
+    // Rebuilding the preamble for every such mutant would thrash it
+    return MutantValidator::check(code, additionalCommands);
+  }
+  // The unit takes the ownership of the remapped buffer
+  ::clang::ASTUnit::RemappedFile mutant(
+      this->targetPath,
+      ::llvm::MemoryBuffer::getMemBufferCopy(code, this->targetPath).release());
+  if (unit->Reparse(this->pchContainerOps, mutant)) {
+    return false;
+  }
+  return !unit->getDiagnostics().hasErrorOccurred();
+}
+
+::std::unique_ptr<chimera::MutantValidator> chimera::createMutantValidator(
+    ValidationMode mode, const CompileCommand& command,
+    const ::std::string& targetPath, const ::std::string& virtualPath) {
+  switch (mode) {
+    case ValidationMode::Preamble:
+      return ::std::unique_ptr<MutantValidator>(
+          new PreambleMutantValidator(command, targetPath, virtualPath));
+    case ValidationMode::InMemory:
+    default:
+      return ::std::unique_ptr<MutantValidator>(
+          new MutantValidator(command, targetPath, virtualPath));
+  }
+}
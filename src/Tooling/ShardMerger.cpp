@@ -0,0 +1,346 @@
+//===- ShardMerger.cpp ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ShardMerger.cpp
+/// \brief  This file implements the merge of the outputs of a sharded
+///         mutation campaign
+//===----------------------------------------------------------------------===//
+
+#include "Tooling/ShardMerger.h"
+#include "Core/MutantDelta.h"
+#include "Log.h"
+#include "Pack/MutantPack.h"
+#include "Utils.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <utility>
+
+using namespace chimera::log;
+
+/// @brief Read the non empty lines of a file
+static bool readLines(const ::std::string& path,
+                      ::std::vector<::std::string>& lines) {
+  ::std::ifstream stream(path);
+  if (!stream.is_open()) {
+    return false;
+  }
+  ::std::string line;
+  while (::std::getline(stream, line)) {
+    if (!line.empty()) {
+      lines.push_back(line);
+    }
+  }
+  return true;
+}
+
+/// @brief Replace the id, the first column, of a row
+static ::std::string renumber(const ::std::string& row,
+                              chimera::mutant::IdType id) {
+  return ::std::to_string(id) + row.substr(row.find(','));
+}
+
+/// @brief Copy a file, or a directory recursively
+static bool copyTree(const ::std::string& from, const ::std::string& to) {
+  if (::llvm::sys::fs::is_directory(from)) {
+    ::chimera::fs::createDirectories(to);
+    ::std::error_code error;
+    bool copied = true;
+    for (::llvm::sys::fs::directory_iterator it(from, error), end;
+         !error && it != end; it.increment(error)) {
+      copied &= copyTree(it->path(),
+                         to + ::chimera::fs::pathSep +
+                             ::llvm::sys::path::filename(it->path()).str());
+    }
+    return copied && !error;
+  }
+  auto buffer = ::llvm::MemoryBuffer::getFile(from);
+  if (!buffer) {
+    return false;
+  }
+  ::std::error_code error;
+  ::llvm::raw_fd_ostream file(to, error, ::llvm::sys::fs::F_None);
+  if (error) {
+    return false;
+  }
+  file << (*buffer)->getBuffer();
+  return true;
+}
+
+chimera::ShardMerger::ShardMerger(const ::std::vector<::std::string>& shardDirs,
+                                  const ::std::string& outputDir)
+    : shardDirs(shardDirs), outputDir(outputDir) {}
+
+int chimera::ShardMerger::run() {
+  // The source files are the directories with a shard.csv, the others
+  // (e.g. the preprocessed resources) are the same in every shard
+  ::std::set<::std::string> targets, others;
+  for (const ::std::string& shardDir : this->shardDirs) {
+    ::std::error_code error;
+    for (::llvm::sys::fs::directory_iterator it(shardDir, error), end;
+         !error && it != end; it.increment(error)) {
+      const ::std::string name = ::llvm::sys::path::filename(it->path()).str();
+      if (!::llvm::sys::fs::is_directory(it->path()) || name == ".cache") {
+        continue;
+      }
+      if (::llvm::sys::fs::exists(it->path() + ::chimera::fs::pathSep +
+                                  "shard.csv")) {
+        targets.insert(name);
+      } else {
+        others.insert(name);
+      }
+    }
+  }
+  if (targets.empty()) {
+    ChimeraLogger::error("No sharded outputs to merge");
+    return 1;
+  }
+  int retval = 0;
+  for (const ::std::string& other : others) {
+    for (const ::std::string& shardDir : this->shardDirs) {
+      const ::std::string path = shardDir + ::chimera::fs::pathSep + other;
+      if (::llvm::sys::fs::is_directory(path)) {
+        copyTree(path, this->outputDir + ::chimera::fs::pathSep + other);
+        break;
+      }
+    }
+  }
+  for (const ::std::string& target : targets) {
+    CHIMERA_VERBOSE_AND_INCR("[ RUN  ] Merging " + target);
+    if (!this->mergeTarget(target)) {
+      ChimeraLogger::error("Couldn't merge the shards of " + target);
+      retval = 1;
+    }
+    CHIMERA_VERBOSE_PRE_DECR("[ DONE ] Merging " + target);
+  }
+  return retval;
+}
+
+bool chimera::ShardMerger::loadShard(const ::std::string& targetDir,
+                                     ::std::size_t shard, unsigned& index,
+                                     unsigned& count,
+                                     mutant::IdType& firstId,
+                                     bool& hasWeights,
+                                     ::std::vector<Entry>& entries) const {
+  ::std::vector<::std::string> rows, reportRows, weightRows;
+  if (!readLines(targetDir + "shard.csv", rows) || rows.empty() ||
+      !readLines(targetDir + "report.csv", reportRows)) {
+    return false;
+  }
+  hasWeights = readLines(targetDir + "sampling_weights.csv", weightRows);
+
+  ::llvm::SmallVector<::llvm::StringRef, 6> fields;
+  ::llvm::StringRef(rows.front()).split(fields, ',');
+  if (fields.size() != 4 || fields[0] != "shard" ||
+      fields[1].getAsInteger(10, index) || fields[2].getAsInteger(10, count) ||
+      fields[3].getAsInteger(10, firstId)) {
+    return false;
+  }
+  ::std::size_t report = 0, weight = 0;
+  for (::std::size_t i = 1; i < rows.size(); ++i) {
+    fields.clear();
+    ::llvm::StringRef(rows[i]).split(fields, ',');
+    Entry entry;
+    unsigned reported;
+    if (fields.size() != 6 || fields[0] != "mutant" ||
+        fields[1].getAsInteger(10, entry.id) ||
+        fields[2].getAsInteger(10, entry.phase) ||
+        fields[3].getAsInteger(10, entry.group) ||
+        fields[4].getAsInteger(10, entry.ordinal) ||
+        fields[5].getAsInteger(10, reported)) {
+      return false;
+    }
+    entry.reported = reported != 0;
+    entry.shard = shard;
+    // Rows written in the same order of the entries
+    if (entry.reported) {
+      if (report == reportRows.size()) {
+        return false;
+      }
+      entry.reportRow = reportRows[report++];
+    }
+    if (hasWeights) {
+      if (weight == weightRows.size()) {
+        return false;
+      }
+      entry.weightRow = weightRows[weight++];
+    }
+    entries.push_back(::std::move(entry));
+  }
+  return report == reportRows.size();
+}
+
+bool chimera::ShardMerger::mergeTarget(const ::std::string& target) {
+  const ::std::string targetOutputDir = this->outputDir +
+                                        ::chimera::fs::pathSep + target +
+                                        ::chimera::fs::pathSep;
+  ::std::vector<Entry> entries;
+  ::std::vector<::std::string> shardTargetDirs;
+  ::std::set<unsigned> indexes;
+  unsigned count = 0;
+  mutant::IdType firstId = 0;
+  bool hasWeights = false;
+  for (::std::size_t i = 0; i < this->shardDirs.size(); ++i) {
+    const ::std::string targetDir = this->shardDirs[i] +
+                                    ::chimera::fs::pathSep + target +
+                                    ::chimera::fs::pathSep;
+    shardTargetDirs.push_back(targetDir);
+    unsigned shardIndex, shardCount;
+    mutant::IdType shardFirstId;
+    bool shardHasWeights;
+    if (!this->loadShard(targetDir, i, shardIndex, shardCount, shardFirstId,
+                         shardHasWeights, entries)) {
+      ChimeraLogger::error("Missing or corrupted shard output " + targetDir);
+      return false;
+    }
+    if ((i > 0 && (shardCount != count || shardFirstId != firstId ||
+                   shardHasWeights != hasWeights)) ||
+        !indexes.insert(shardIndex).second) {
+      ChimeraLogger::error("Inconsistent shard " + targetDir);
+      return false;
+    }
+    count = shardCount;
+    firstId = shardFirstId;
+    hasWeights = shardHasWeights;
+  }
+  if (indexes.size() != count) {
+    ChimeraLogger::error("Missing shards of " + target + ": " +
+                         ::std::to_string(indexes.size()) + " of " +
+                         ::std::to_string(count));
+    return false;
+  }
+
+  // Order of a single run, the FOM ids follow it
+  ::std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry& a, const Entry& b) {
+                       return ::std::make_tuple(a.phase, a.group, a.ordinal) <
+                              ::std::make_tuple(b.phase, b.group, b.ordinal);
+                     });
+  ::std::vector<::std::map<mutant::IdType, mutant::IdType>> ids(
+      this->shardDirs.size());
+  mutant::IdType nextId = firstId;
+  for (const Entry& entry : entries) {
+    if (entry.id >= firstId && ids[entry.shard].count(entry.id) == 0) {
+      ids[entry.shard][entry.id] = nextId++;
+    }
+  }
+  // 0 for a FOM mutant missing in shard.csv
+  auto getId = [&ids, firstId](::std::size_t shard, mutant::IdType id) {
+    if (id < firstId) {
+      return id;
+    }
+    auto it = ids[shard].find(id);
+    return it != ids[shard].end() ? it->second : 0;
+  };
+
+  ::chimera::fs::createDirectories(targetOutputDir);
+  ::std::ofstream report(targetOutputDir + "report.csv");
+  ::std::ofstream weights;
+  if (hasWeights) {
+    weights.open(targetOutputDir + "sampling_weights.csv");
+  }
+  for (const Entry& entry : entries) {
+    const mutant::IdType id = getId(entry.shard, entry.id);
+    if (entry.reported) {
+      report << renumber(entry.reportRow, id) << "\n";
+    }
+    if (hasWeights) {
+      weights << renumber(entry.weightRow, id) << "\n";
+    }
+  }
+
+  // The mutants, in the storage of the shards
+  bool merged = true;
+  ::std::unique_ptr<mutant::MutantDeltaWriter> deltaWriter;
+  ::std::unique_ptr<pack::PackWriter> packWriter;
+  for (::std::size_t i = 0; i < shardTargetDirs.size(); ++i) {
+    const ::std::string& targetDir = shardTargetDirs[i];
+    if (::llvm::sys::fs::exists(targetDir + "mutants.delta")) {
+      mutant::MutantDeltaReader reader;
+      if (!reader.open(targetDir + "mutants.delta")) {
+        merged = false;
+        continue;
+      }
+      if (!deltaWriter) {
+        deltaWriter.reset(new mutant::MutantDeltaWriter(
+            targetOutputDir + "mutants.delta", reader.getFilename(),
+            reader.getOriginal()));
+      }
+      for (mutant::IdType id : reader.getMutantIds()) {
+        mutant::EditScript edits;
+        merged &= getId(i, id) != 0 && reader.getEdits(id, edits) &&
+                  deltaWriter->add(getId(i, id), edits);
+      }
+    } else if (::llvm::sys::fs::exists(targetDir + "mutants.pack")) {
+      pack::PackReader reader;
+      if (!reader.open(targetDir + "mutants.pack")) {
+        merged = false;
+        continue;
+      }
+      if (!packWriter) {
+        packWriter.reset(new pack::PackWriter(targetOutputDir + "mutants.pack",
+                                              reader.getTargetFilename()));
+      }
+      for (::std::size_t m = 0; m < reader.getMutantsNumber(); ++m) {
+        const mutant::IdType id = reader.getMutantId(m);
+        if (getId(i, id) == 0) {
+          merged = false;
+          continue;
+        }
+        for (const pack::Blob& blob : reader.getBlobs(id)) {
+          merged &= packWriter->add(getId(i, id), blob.getName(), blob.data,
+                                    blob.size);
+        }
+      }
+    } else {
+      ::std::error_code error;
+      for (::llvm::sys::fs::directory_iterator it(targetDir, error), end;
+           !error && it != end; it.increment(error)) {
+        mutant::IdType id;
+        if (!::llvm::sys::fs::is_directory(it->path()) ||
+            ::llvm::sys::path::filename(it->path()).getAsInteger(10, id)) {
+          continue;  // Not a mutant
+        }
+        merged &= getId(i, id) != 0 &&
+                  copyTree(it->path(),
+                           targetOutputDir + ::std::to_string(getId(i, id)));
+      }
+    }
+  }
+  if (deltaWriter) {
+    merged &= deltaWriter->close();
+  }
+  if (packWriter) {
+    merged &= packWriter->close();
+  }
+  report.close();
+  return merged && report.good();
+}
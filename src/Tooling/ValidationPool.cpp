@@ -0,0 +1,101 @@
+//===- ValidationPool.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ValidationPool.cpp
+/// \brief  This file implements the pool of mutant validation workers
+//===----------------------------------------------------------------------===//
+
+#include "Tooling/ValidationPool.h"
+
+#include <chrono>
+
+chimera::ValidationPool::ValidationPool(unsigned jobs,
+                                        const ValidatorFactory& factory)
+    : jobs(jobs > 0 ? jobs : 1), stopping(false) {
+  // The engines are built here, on the caller thread
+  for (unsigned i = 0; i < this->jobs; ++i) {
+    this->validators.push_back(factory());
+  }
+  if (this->jobs > 1) {
+    for (auto& validator : this->validators) {
+      this->workers.push_back(::std::thread(&ValidationPool::work, this,
+                                            ::std::ref(*validator)));
+    }
+  }
+}
+
+chimera::ValidationPool::~ValidationPool() {
+  {
+    ::std::lock_guard<::std::mutex> lock(this->tasksMutex);
+    this->stopping = true;
+  }
+  this->tasksCondition.notify_all();
+  for (auto& worker : this->workers) {
+    worker.join();
+  }
+}
+
+::std::future<bool> chimera::ValidationPool::submit(
+    const ::std::string& code,
+    const ::std::vector<::std::string>& additionalCommands,
+    const CheckObserver& observer) {
+  Task task([code, additionalCommands, observer](MutantValidator& validator) {
+    if (!observer) {
+      return validator.check(code, additionalCommands);
+    }
+    const auto start = ::std::chrono::steady_clock::now();
+    const bool valid = validator.check(code, additionalCommands);
+    observer(::std::chrono::duration<double>(
+                 ::std::chrono::steady_clock::now() - start)
+                 .count());
+    return valid;
+  });
+  ::std::future<bool> verdict = task.get_future();
+
+  if (this->workers.empty()) {
+    // Sequential: check it straight away
+    task(*this->validators.front());
+  } else {
+    {
+      ::std::lock_guard<::std::mutex> lock(this->tasksMutex);
+      this->tasks.push_back(::std::move(task));
+    }
+    this->tasksCondition.notify_one();
+  }
+  return verdict;
+}
+
+void chimera::ValidationPool::work(MutantValidator& validator) {
+  for (;;) {
+    Task task;
+    {
+      ::std::unique_lock<::std::mutex> lock(this->tasksMutex);
+      this->tasksCondition.wait(
+          lock, [this] { return this->stopping || !this->tasks.empty(); });
+      if (this->tasks.empty()) {
+        // Stopping and nothing left to do
+        return;
+      }
+      task = ::std::move(this->tasks.front());
+      this->tasks.pop_front();
+    }
+    task(validator);
+  }
+}
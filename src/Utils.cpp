@@ -28,6 +28,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 
@@ -91,3 +92,42 @@ bool chimera::fs::createDirectories(const llvm::Twine& path,
   sys::fs::create_directories(path, ignoreExisting);
   return sys::fs::is_directory(path);
 }
+
+std::string chimera::json::quote(const std::string& value) {
+  std::string quoted = "\"";
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      quoted += "\\\"";
+      break;
+    case '\\':
+      quoted += "\\\\";
+      break;
+    case '\b':
+      quoted += "\\b";
+      break;
+    case '\f':
+      quoted += "\\f";
+      break;
+    case '\n':
+      quoted += "\\n";
+      break;
+    case '\r':
+      quoted += "\\r";
+      break;
+    case '\t':
+      quoted += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[7];
+        snprintf(escaped, sizeof(escaped), "\\u%04x",
+                 static_cast<unsigned>(static_cast<unsigned char>(c)));
+        quoted += escaped;
+      } else {
+        quoted += c;
+      }
+    }
+  }
+  return quoted + '"';
+}
@@ -27,21 +27,25 @@
 #include "Tooling/ChimeraTool.h"
 
 // For testing purpose
+#include "Testing/CoreTesting.h"
 #include "Testing/MutatorsTesting.h"
+#include "Testing/PackTesting.h"
+#include "Testing/TemplateTesting.h"
+#include "Testing/ToolingTesting.h"
 
 int main(int argc, const char **argv) {
   // Create a Chimera Tool
   ::chimera::ChimeraTool chimeraTool;
   
-  chimeraTool.registerMutationOperator(::chimera::flapmutator::getFLAPOperator());
-  chimeraTool.registerMutationOperator(::chimera::vpamutator::getVPAOperator());
-  chimeraTool.registerMutationOperator(::chimera::vpa_nmutator::getVPANOperator());
-  chimeraTool.registerMutationOperator(::chimera::perforation::getPerforationFirstOperator());
-  chimeraTool.registerMutationOperator(::chimera::perforation::getPerforationSecondOperator());
-  chimeraTool.registerMutationOperator(::chimera::adder::getAdderOperator());
-  chimeraTool.registerMutationOperator(::chimera::axdct::getAxDCTOperator());
-  chimeraTool.registerMutationOperator(::chimera::truncate::getTruncateIntOperator());
-  chimeraTool.registerMutationOperator(::chimera::evoapprox8u::getEvoApprox8uOperator());
+  chimeraTool.registerMutationOperator(&::chimera::flapmutator::getFLAPOperator);
+  chimeraTool.registerMutationOperator(&::chimera::vpamutator::getVPAOperator);
+  chimeraTool.registerMutationOperator(&::chimera::vpa_nmutator::getVPANOperator);
+  chimeraTool.registerMutationOperator(&::chimera::perforation::getPerforationFirstOperator);
+  chimeraTool.registerMutationOperator(&::chimera::perforation::getPerforationSecondOperator);
+  chimeraTool.registerMutationOperator(&::chimera::adder::getAdderOperator);
+  chimeraTool.registerMutationOperator(&::chimera::axdct::getAxDCTOperator);
+  chimeraTool.registerMutationOperator(&::chimera::truncate::getTruncateIntOperator);
+  chimeraTool.registerMutationOperator(&::chimera::evoapprox8u::getEvoApprox8uOperator);
 
 
   return chimeraTool.run(argc, argv);
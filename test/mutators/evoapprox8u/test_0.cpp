@@ -0,0 +1,16 @@
+namespace evoapproxlib {
+inline int evoapprox_t(int x, int) { return x; }
+}
+
+int g(int x) { return x; }
+
+int f(int a, int b) {
+  int r = a + b;
+  r = a * b;
+  r = g(a * b);
+  r = r - b;
+  if (a < b) {
+    r = r * b;
+  }
+  return r;
+}
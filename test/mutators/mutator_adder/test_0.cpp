@@ -0,0 +1,11 @@
+int g(int x) { return x; }
+
+int f(int a, int b, unsigned u) {
+  int r = g(a + b);
+  int v[2] = {0, 0};
+  r = v[a - b];
+  unsigned s = u + u;
+  r = a * b;
+  float x = 1.0f + 2.0f;
+  return r;
+}
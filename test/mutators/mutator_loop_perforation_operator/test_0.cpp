@@ -0,0 +1,16 @@
+void test_function(int n) {
+  int i, j;
+  int a = 0;
+  for (i = 0; i < n; i++) {
+    a += i;
+  }
+  for (j = n; j > 0; j = j - 1) {
+    a -= j;
+  }
+  for (i = 0; i < n; i += 2) {
+    a += i;
+  }
+  for (int k = 0; k < n; k++) {
+    a += k;
+  }
+}
@@ -0,0 +1,16 @@
+namespace truncate {
+inline int ax_integer(int, int x) { return x; }
+}
+
+int g(int x) { return x; }
+
+int f(int a, int b) {
+  int r = a + b;
+  r = a * b;
+  r = g(a - b);
+  if (a < b) {
+    r = r / b;
+  }
+  float x = 1.0f + 2.0f;
+  return r;
+}
@@ -0,0 +1,20 @@
+namespace vpa_n {
+enum VPAPrecision { FLOAT, DOUBLE, LONG_DOUBLE };
+inline double VPA(double x, VPAPrecision) { return x; }
+}
+
+float g(float x) { return x; }
+
+float f(float a, float b, double c) {
+  float r = 0;
+  r = a + b;
+  double d = c * c;
+  r += a;
+  r += c;
+  r = g(a - b);
+  if (a / b > r) {
+    r = r - b;
+  }
+  int i = 1 + 2;
+  return r + b;
+}